@@ -0,0 +1,164 @@
+/*
+    Host-side benchmark of CBORWriter_t against JSON written with `snprintf`.
+
+    A typical telemetry record, with a device identifier, a timestamp, a few
+    sensor readings and a position, is encoded as JSON, as CBOR with the same
+    string keys and as CBOR with small integer keys, which is how CBOR is
+    commonly used on constrained links. We report the size of the payload and
+    the time to encode it, and check that CBORReader_t decodes the record.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/cbor_benchmark
+*/
+#include <stdio.h>
+#include <chrono>
+
+#include "cbor.h"
+
+struct Record_t {
+    const char* device;
+    uint32_t    timestamp;
+    float       temperature;
+    float       humidity;
+    float       battery;
+    int16_t     rssi;
+    double      latitude;
+    double      longitude;
+};
+
+static const Record_t RECORD = {"A76XX-0001", 1700000000, 21.5f, 48.25f, 3.87f, -71, 45.464211, 9.191383};
+
+static const int ITERATIONS = 1000000;
+
+// the total length of the encoded records, so that the loop is not optimised away
+static volatile size_t total_length;
+
+static size_t encodeJSON(const Record_t& r, uint8_t* buffer, size_t size) {
+    return snprintf(reinterpret_cast<char*>(buffer), size,
+                    "{\"device\":\"%s\",\"ts\":%u,\"temp\":%.2f,\"hum\":%.2f,"
+                    "\"batt\":%.2f,\"rssi\":%d,\"pos\":[%.6f,%.6f]}",
+                    r.device, r.timestamp, r.temperature, r.humidity,
+                    r.battery, r.rssi, r.latitude, r.longitude);
+}
+
+static size_t encodeCBOR(const Record_t& r, uint8_t* buffer, size_t size) {
+    CBORWriter_t writer(buffer, size);
+    writer.beginMap(7);
+    writer.writeString("device");
+    writer.writeString(r.device);
+    writer.writeString("ts");
+    writer.writeUInt(r.timestamp);
+    writer.writeString("temp");
+    writer.writeFloat(r.temperature);
+    writer.writeString("hum");
+    writer.writeFloat(r.humidity);
+    writer.writeString("batt");
+    writer.writeFloat(r.battery);
+    writer.writeString("rssi");
+    writer.writeInt(r.rssi);
+    writer.writeString("pos");
+    writer.beginArray(2);
+    writer.writeDouble(r.latitude);
+    writer.writeDouble(r.longitude);
+    return writer.length();
+}
+
+static size_t encodeCBORIntKeys(const Record_t& r, uint8_t* buffer, size_t size) {
+    CBORWriter_t writer(buffer, size);
+    writer.beginMap(7);
+    writer.writeUInt(0);
+    writer.writeString(r.device);
+    writer.writeUInt(1);
+    writer.writeUInt(r.timestamp);
+    writer.writeUInt(2);
+    writer.writeFloat(r.temperature);
+    writer.writeUInt(3);
+    writer.writeFloat(r.humidity);
+    writer.writeUInt(4);
+    writer.writeFloat(r.battery);
+    writer.writeUInt(5);
+    writer.writeInt(r.rssi);
+    writer.writeUInt(6);
+    writer.beginArray(2);
+    writer.writeDouble(r.latitude);
+    writer.writeDouble(r.longitude);
+    return writer.length();
+}
+
+// decode a record encoded by encodeCBOR
+static bool decodeCBOR(const uint8_t* data, size_t length, Record_t& r) {
+    CBORReader_t reader(data, length);
+    size_t count;
+    if (reader.readMap(count) == false) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const char* key;
+        size_t key_length;
+        if (reader.readString(key, key_length) == false) {
+            return false;
+        }
+        uint64_t uvalue;
+        int64_t ivalue;
+        size_t n;
+        bool ok = true;
+        if (key_length == 2 && memcmp(key, "ts", 2) == 0) {
+            ok = reader.readUInt(uvalue);
+            r.timestamp = uvalue;
+        } else if (key_length == 4 && memcmp(key, "temp", 4) == 0) {
+            ok = reader.readFloat(r.temperature);
+        } else if (key_length == 4 && memcmp(key, "rssi", 4) == 0) {
+            ok = reader.readInt(ivalue);
+            r.rssi = ivalue;
+        } else if (key_length == 3 && memcmp(key, "pos", 3) == 0) {
+            ok = reader.readArray(n) && n == 2 &&
+                 reader.readDouble(r.latitude) && reader.readDouble(r.longitude);
+        } else {
+            ok = reader.skip();
+        }
+        if (ok == false) {
+            return false;
+        }
+    }
+    return reader.atEnd() && reader.error() == false;
+}
+
+typedef size_t (*Encoder_t)(const Record_t&, uint8_t*, size_t);
+
+static void run(const char* name, Encoder_t encode) {
+    uint8_t buffer[256];
+    size_t length = encode(RECORD, buffer, sizeof(buffer));
+
+    Record_t record = RECORD;
+    size_t total = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        record.timestamp = RECORD.timestamp + (i & 1);
+        total += encode(record, buffer, sizeof(buffer));
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    total_length = total;
+
+    printf("%-16s | %6zu | %8.1f\n", name, length, elapsed * 1e9 / ITERATIONS);
+}
+
+int main() {
+    uint8_t buffer[256];
+    size_t length = encodeCBOR(RECORD, buffer, sizeof(buffer));
+    Record_t decoded = {};
+    if (decodeCBOR(buffer, length, decoded) == false ||
+        decoded.timestamp != RECORD.timestamp || decoded.temperature != RECORD.temperature ||
+        decoded.rssi != RECORD.rssi || decoded.latitude != RECORD.latitude) {
+        printf("decoding failed\n");
+        return 1;
+    }
+
+    printf("%-16s | %6s | %8s\n", "encoding", "bytes", "ns/rec");
+    run("json", encodeJSON);
+    run("cbor", encodeCBOR);
+    run("cbor int keys", encodeCBORIntKeys);
+    return 0;
+}
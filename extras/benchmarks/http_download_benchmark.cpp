@@ -0,0 +1,122 @@
+/*
+    End-to-end benchmark of HTTP downloads with A76XXHTTPClient against the
+    simulator.
+
+    For a few UART speeds and body sizes, the client sends a GET request and
+    reads the body. We report the time to complete the request, which includes
+    a simulated network latency of 100 ms, the time to read the body from the
+    module and the throughput of the latter as a fraction of the UART speed,
+    first into a String with a single HTTPREAD, then streamed to a Print in 
+    chunks of HTTP_READ_CHUNK_SIZE bytes, which also works for bodies larger
+    than the RAM, e.g. the last size.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/http_download_benchmark
+*/
+#include <string>
+
+#include "A76XX.h"
+#include "simulator.h"
+
+// checks the body as it is streamed, without storing it
+class CheckSink : public Print {
+  public:
+    size_t count    = 0;
+    bool   valid    = true;
+
+    size_t write(uint8_t c) {
+        valid = valid && c == 'x';
+        count++;
+        return 1;
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            valid = valid && buffer[i] == 'x';
+        }
+        count += size;
+        return size;
+    }
+};
+
+static uint32_t progress_calls = 0;
+
+static void onProgress(uint32_t received, uint32_t total, void* context) {
+    progress_calls++;
+}
+
+static bool run(uint32_t baud_rate, size_t body_size) {
+    SimulatorConfig_t config;
+    config.baud_rate          = baud_rate;
+    config.network_latency_us = 100000;
+
+    A76XXSimulator sim(config);
+    sim.addHTTPResource("/data", std::string(body_size, 'x'));
+    A76XX modem(sim);
+    A76XXHTTPClient http(modem, "example.com", 80);
+
+    if (modem.init() == false || http.begin() == false) {
+        printf("setup failed\n");
+        return false;
+    }
+
+    uint32_t t0 = micros();
+    if (http.get("data") == false || http.getResponseStatusCode() != 200) {
+        printf("get failed with error %d\n", http.getLastError());
+        return false;
+    }
+    uint32_t t1 = micros();
+
+    // the largest body is only streamed
+    double read_s = 0;
+    if (body_size <= 32768) {
+        String body;
+        if (http.getResponseBody(body) == false || body.length() != body_size) {
+            printf("reading the body failed with error %d\n", http.getLastError());
+            return false;
+        }
+        read_s = (micros() - t1) * 1e-6;
+    }
+
+    CheckSink sink;
+    progress_calls = 0;
+    uint32_t t2 = micros();
+    if (http.getResponseBody(sink, HTTP_READ_CHUNK_SIZE, onProgress) == false ||
+        sink.count != body_size || sink.valid == false) {
+        printf("streaming the body failed with error %d\n", http.getLastError());
+        return false;
+    }
+    double stream_s = (micros() - t2) * 1e-6;
+
+    if (read_s > 0) {
+        printf("%7u | %7zu | %9.1f | %9.1f | %8.1f | %11.1f | %8.1f | %6u\n",
+               baud_rate, body_size, (t1 - t0) * 1e-3, read_s * 1e3,
+               100 * body_size / read_s * 10 / baud_rate, stream_s * 1e3,
+               100 * body_size / stream_s * 10 / baud_rate, progress_calls);
+    } else {
+        printf("%7u | %7zu | %9.1f | %9s | %8s | %11.1f | %8.1f | %6u\n",
+               baud_rate, body_size, (t1 - t0) * 1e-3, "-", "-", stream_s * 1e3,
+               100 * body_size / stream_s * 10 / baud_rate, progress_calls);
+    }
+
+    http.end();
+    return true;
+}
+
+int main() {
+    printf("%7s | %7s | %9s | %9s | %8s | %11s | %8s | %6s\n", "baud", "body",
+           "get [ms]", "read [ms]", "wire [%]", "stream [ms]", "wire [%]", "chunks");
+
+    const uint32_t baud_rates[] = {115200, 921600};
+    const size_t   body_sizes[] = {1024, 8192, 32768, 262144};
+    for (uint32_t baud_rate : baud_rates) {
+        for (size_t body_size : body_sizes) {
+            if (run(baud_rate, body_size) == false) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+    Host-side benchmark of the LZ77 compressor used by A76XXMQTTClient::setCompression
+    and A76XXHTTPClient::setCompression.
+
+    Representative telemetry payloads are compressed with LZCompressor_t and
+    decompressed with lzDecompress and with LZDecoder_t, fed in chunks of 64
+    bytes as data received from the module. We report the compressed size, the
+    compression ratio and the throughput in MB/s of uncompressed data, and
+    check that the data is restored.
+
+    The payloads are a single JSON record, batches of JSON records and CSV rows
+    as aggregated by A76XXMQTTAggregator, and a batch of NMEA sentences.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/lz77_benchmark
+*/
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "lz77.h"
+
+static const double TARGET_SECONDS = 0.2;
+
+static std::string jsonRecord(int i) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+             "{\"device\":\"A76XX-0001\",\"ts\":%d,\"temp\":%.2f,\"hum\":%.2f,"
+             "\"batt\":%.2f,\"rssi\":%d,\"pos\":[%.6f,%.6f]}",
+             1700000000 + 10 * i, 21.5 + 0.07 * (i % 13), 48.25 - 0.11 * (i % 7),
+             3.87 - 0.001 * i, -71 - i % 5, 45.464211 + 1e-5 * i, 9.191383 - 2e-5 * i);
+    return buffer;
+}
+
+static std::string jsonBatch(int n) {
+    std::string batch;
+    for (int i = 0; i < n; i++) {
+        batch += jsonRecord(i) + "\n";
+    }
+    return batch;
+}
+
+static std::string csvBatch(int n) {
+    std::string batch = "ts,temp,hum,batt,rssi\n";
+    for (int i = 0; i < n; i++) {
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer), "%d,%.2f,%.2f,%.3f,%d\n",
+                 1700000000 + 10 * i, 21.5 + 0.07 * (i % 13), 48.25 - 0.11 * (i % 7),
+                 3.87 - 0.001 * i, -71 - i % 5);
+        batch += buffer;
+    }
+    return batch;
+}
+
+static std::string nmeaBatch(int n) {
+    std::string batch;
+    for (int i = 0; i < n; i++) {
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer),
+                 "$GNGGA,%06d.00,4527.85266,N,00911.48298,E,1,12,0.58,%.1f,M,47.9,M,,*%02X\r\n",
+                 120000 + i, 120.4 + 0.1 * (i % 9), (i * 37) & 0xFF);
+        batch += buffer;
+        snprintf(buffer, sizeof(buffer),
+                 "$GNRMC,%06d.00,A,4527.85266,N,00911.48298,E,0.012,,171026,,,A,V*%02X\r\n",
+                 120000 + i, (i * 53) & 0xFF);
+        batch += buffer;
+    }
+    return batch;
+}
+
+// run `f` repeatedly for about TARGET_SECONDS and return the seconds per call
+template <typename F>
+static double timeIt(F f) {
+    int iterations = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    while (elapsed < TARGET_SECONDS) {
+        for (int i = 0; i < 100; i++) {
+            f();
+        }
+        iterations += 100;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+    return elapsed / iterations;
+}
+
+static LZCompressor_t compressor;
+static LZDecoder_t    decoder;
+
+static bool run(const char* name, const std::string& input) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+    std::vector<uint8_t> compressed(input.size());
+    std::vector<uint8_t> restored(input.size());
+
+    size_t length = compressor.compress(data, input.size(), compressed.data(), compressed.size());
+    if (length == 0) {
+        printf("%-14s | %6zu | not compressible\n", name, input.size());
+        return true;
+    }
+
+    size_t restored_length = 0;
+    if (lzDecompress(compressed.data(), length, restored.data(), restored.size(), restored_length) == false ||
+        restored_length != input.size() || memcmp(restored.data(), data, input.size()) != 0) {
+        printf("%s: lzDecompress failed\n", name);
+        return false;
+    }
+
+    // the streaming decoder, in chunks of 64 bytes
+    size_t streamed = 0;
+    bool stream_ok = true;
+    auto stream = [&]() {
+        streamed = 0;
+        decoder.reset();
+        for (size_t offset = 0; offset < length; offset += 64) {
+            size_t n = length - offset < 64 ? length - offset : 64;
+            stream_ok &= decoder.feed(compressed.data() + offset, n, [&](const uint8_t* out, size_t count) {
+                stream_ok &= memcmp(out, data + streamed, count) == 0;
+                streamed += count;
+            });
+        }
+    };
+    stream();
+    if (stream_ok == false || decoder.done() == false || streamed != input.size()) {
+        printf("%s: LZDecoder_t failed\n", name);
+        return false;
+    }
+
+    double t_compress = timeIt([&]() {
+        compressor.compress(data, input.size(), compressed.data(), compressed.size());
+    });
+    double t_decompress = timeIt([&]() {
+        lzDecompress(compressed.data(), length, restored.data(), restored.size(), restored_length);
+    });
+    double t_stream = timeIt(stream);
+
+    double mb = input.size() / 1e6;
+    printf("%-14s | %6zu | %6zu | %5.2f | %8.1f | %8.1f | %8.1f\n", name, input.size(), length,
+           static_cast<double>(input.size()) / length,
+           mb / t_compress, mb / t_decompress, mb / t_stream);
+    return true;
+}
+
+int main() {
+    printf("%-14s | %6s | %6s | %5s | %8s | %8s | %8s\n", "payload", "bytes", "lz", "ratio",
+           "comp MB/s", "dec MB/s", "str MB/s");
+
+    bool ok = run("json record", jsonRecord(0)) &&
+              run("json x8", jsonBatch(8)) &&
+              run("json x32", jsonBatch(32)) &&
+              run("csv x64", csvBatch(64)) &&
+              run("nmea x16", nmeaBatch(16));
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/*
+    Host-side benchmark of the URC/response matching done in ModemSerial::waitResponse.
+
+    Compares the throughput, in bytes per second, of the previous approach, where
+    every received character is pushed to a 64 characters circular buffer that is
+    then scanned with `endsWith` for each event handler and response string, with
+    the PatternMatcher automaton, for 1, 8 and 32 registered event handlers.
+
+    The input is a stream of NMEA sentences, as produced at 10 Hz by the GNSS module,
+    interleaved with MQTT URCs and command responses.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/matcher_benchmark
+*/
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "pattern_matcher.h"
+
+// Same semantics as the CircularBuffer<char, 64> used previously by waitResponse
+template <size_t N>
+struct CharRing {
+    char   data[N];
+    size_t head  = 0;
+    size_t count = 0;
+
+    void push(char c) {
+        data[(head + count) % N] = c;
+        if (count < N) { count++; } else { head = (head + 1) % N; }
+    }
+    char operator[](size_t i) const { return data[(head + i) % N]; }
+    size_t size() const { return count; }
+};
+
+// The function previously used by waitResponse, verbatim
+template<size_t N>
+bool endsWith(CharRing<N>& buf, const char* str) {
+    if (strlen(str) > buf.size()) { return false; }
+    const char* m = str + strlen(str) - 1; // pointer to last character in str
+    size_t i = 1;
+    while (i <= buf.size() && i <= strlen(str) ) {
+        if (buf[buf.size() - i] != *m) {
+            return false;
+        }
+        m--;
+        i++;
+    }
+    return true;
+}
+
+static std::vector<std::string> makeHandlers(size_t n) {
+    // the handlers registered by the GNSS and MQTT clients come first
+    const char* known[] = {"+CMQTTRXSTART: ", "$GP", "$GA", "$GB", "$GN", "$GL", "$BD",
+                           "+CMQTTCONNLOST: "};
+    std::vector<std::string> out;
+    for (size_t i = 0; i < n; i++) {
+        if (i < sizeof(known) / sizeof(known[0])) {
+            out.push_back(known[i]);
+        } else {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "+CURC%02u: ", static_cast<unsigned>(i));
+            out.push_back(buf);
+        }
+    }
+    return out;
+}
+
+static std::string makeInput(size_t min_length) {
+    const char* chunk =
+        "$GNRMC,122537.00,A,5057.44011,N,00123.39813,W,0.021,,160523,,,A,V*0A\r\n"
+        "$GNGGA,122537.00,5057.44011,N,00123.39813,W,1,12,0.58,41.3,M,47.4,M,,*6C\r\n"
+        "$GPGSV,3,1,11,05,26,259,22,07,30,062,30,08,24,115,29,09,08,045,20*75\r\n"
+        "$GLGSV,2,1,07,65,17,327,,71,37,045,27,72,70,096,31,73,21,292,*6A\r\n"
+        "$GAGSV,2,1,07,02,27,284,,05,23,216,24,15,58,297,,24,30,075,29*74\r\n"
+        "\r\n+CMQTTRXSTART: 0,12,5\r\n+CMQTTRXTOPIC: 0,12\r\nsensors/temp\r\n"
+        "+CMQTTRXPAYLOAD: 0,5\r\n21.45\r\n+CMQTTRXEND: 0\r\n"
+        "\r\n+CGNSSINFO: 3,12,,04,00,50.9573352,N,1.3899688,W,160523,122537.00,41.3,0.0,,1.1,0.6,0.9\r\n"
+        "\r\nOK\r\n";
+    std::string out;
+    while (out.size() < min_length) {
+        out += chunk;
+    }
+    return out;
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+int main() {
+    const std::string input = makeInput(4 * 1024 * 1024);
+    const char* responses[] = {"+CGNSSINFO:", "ERROR\r\n", "OK\r\n"};
+    const size_t num_responses = sizeof(responses) / sizeof(responses[0]);
+    const size_t handler_counts[] = {1, 8, 32};
+
+    printf("input size: %zu bytes\n", input.size());
+    printf("%8s | %16s | %16s | %8s | %s\n",
+           "handlers", "endsWith [MB/s]", "automaton [MB/s]", "speedup", "matches");
+
+    for (size_t n : handler_counts) {
+        std::vector<std::string> handlers = makeHandlers(n);
+
+        // previous approach
+        size_t matches_before = 0;
+        Clock::time_point t0 = Clock::now();
+        {
+            CharRing<64> data;
+            for (char c : input) {
+                data.push(c);
+                for (const std::string& h : handlers) {
+                    if (endsWith(data, h.c_str())) { matches_before++; }
+                }
+                for (size_t i = 0; i < num_responses; i++) {
+                    if (endsWith(data, responses[i])) { matches_before++; }
+                }
+            }
+        }
+        double t_before = seconds(t0);
+
+        // automaton, compiled as in ModemSerial::waitResponse
+        size_t matches_after = 0;
+        t0 = Clock::now();
+        {
+            PatternMatcher<512, 32 + 3> matcher;
+            for (const std::string& h : handlers) {
+                matcher.addPattern(h.c_str());
+            }
+            for (size_t i = 0; i < num_responses; i++) {
+                matcher.addPattern(responses[i]);
+            }
+            matcher.compile();
+
+            for (char c : input) {
+                if (matcher.step(c)) {
+                    matches_after += __builtin_popcountll(matcher.matches());
+                }
+            }
+        }
+        double t_after = seconds(t0);
+
+        double mb = input.size() / 1.0e6;
+        printf("%8zu | %16.2f | %16.2f | %7.1fx | %zu/%zu%s\n",
+               n, mb / t_before, mb / t_after, t_before / t_after,
+               matches_before, matches_after,
+               matches_before == matches_after ? "" : " MISMATCH");
+    }
+
+    return 0;
+}
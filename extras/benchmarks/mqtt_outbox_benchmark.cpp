@@ -0,0 +1,98 @@
+/*
+    End-to-end benchmark of A76XXMQTTOutbox against the simulator.
+
+    The connection to the broker is dropped, messages with QoS 1 are appended to
+    the outbox while disconnected, then the client reconnects and we report the
+    rate at which the backlog is drained, i.e. sent and acknowledged, for a few
+    UART speeds and payload sizes. The simulated broker acknowledges each message
+    after a network latency of 20 ms, so the rate depends on the number of
+    messages in flight, up to MQTT_PUBLISH_WINDOW.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/mqtt_outbox_benchmark
+*/
+#include <string>
+
+#include "A76XX.h"
+#include "simulator.h"
+
+static const uint32_t MESSAGES           = 50;
+static const uint32_t NETWORK_LATENCY_US = 20000;
+static const uint32_t DRAIN_TIMEOUT      = 30000;
+
+static const char*    TOPIC              = "sensors/room1/temperature";
+
+static bool run(uint32_t baud_rate, size_t payload_size) {
+    SimulatorConfig_t config;
+    config.baud_rate          = baud_rate;
+    config.network_latency_us = NETWORK_LATENCY_US;
+
+    A76XXSimulator sim(config);
+    A76XX modem(sim);
+    A76XXMQTTClient mqtt(modem, "benchmark");
+    OutboxRAMStorage_t<32768> storage;
+    A76XXMQTTOutbox outbox(mqtt, storage);
+
+    if (modem.init() == false || mqtt.begin() == false || outbox.begin() == false ||
+        mqtt.connect("broker.example.com", 1883, true) == false) {
+        printf("setup failed\n");
+        return false;
+    }
+
+    // store messages during the outage
+    sim.dropMQTTConnection(0);
+    std::string payload(payload_size, 'x');
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        if (outbox.publish(TOPIC, reinterpret_cast<const uint8_t*>(payload.data()),
+                           payload.size(), 1) == false) {
+            printf("outbox publish failed with error %d\n", outbox.getLastError());
+            return false;
+        }
+        outbox.loop();
+    }
+    uint32_t bytes_used = outbox.bytesUsed();
+
+    if (mqtt.connect("broker.example.com", 1883, true) == false) {
+        printf("reconnection failed\n");
+        return false;
+    }
+    outbox.resume();
+
+    sim.resetCounters();
+    uint32_t t0 = micros();
+    uint32_t start = millis();
+    while (outbox.pending() > 0 && millis() - start < DRAIN_TIMEOUT) {
+        outbox.loop();
+    }
+    double elapsed = (micros() - t0) * 1e-6;
+
+    if (outbox.pending() > 0 || sim.mqtt_messages_published < MESSAGES) {
+        printf("%u messages pending, %u published\n", outbox.pending(), sim.mqtt_messages_published);
+        return false;
+    }
+
+    printf("%7u | %7zu | %10u | %8.1f | %9.2f | %9u\n",
+           baud_rate, payload_size, bytes_used,
+           MESSAGES / elapsed,
+           MESSAGES * payload_size / elapsed / 1024,
+           sim.mqtt_messages_published - MESSAGES);
+    return true;
+}
+
+int main() {
+    printf("%7s | %7s | %10s | %8s | %9s | %9s\n", "baud", "payload",
+           "stored [B]", "msg/s", "KiB/s", "resent");
+
+    const uint32_t baud_rates[]    = {115200, 921600};
+    const size_t   payload_sizes[] = {16, 200};
+    for (uint32_t baud_rate : baud_rates) {
+        for (size_t payload_size : payload_sizes) {
+            if (run(baud_rate, payload_size) == false) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+/*
+    End-to-end benchmark of A76XXMQTTClient::publish against the simulator.
+
+    For a few UART speeds and payload sizes, the client publishes a sequence of
+    messages with QoS 1 and we report the rate of messages and payload bytes,
+    the bytes exchanged on the UART per message and the fraction of the time
+    the UART towards the module is busy. The simulated broker acknowledges each
+    message after a network latency of 20 ms, which is a lower bound of the
+    time per message, since publish waits for +CMQTTPUB.
+
+    Each case is run with the sequential path, MQTTCommands::setTopic, setPayload
+    and publish, which waits for the response to each command, and with the
+    pipelined path of A76XXMQTTClient::publish, MQTTCommands::publishMessage.
+    We also check whether the topic is kept after CMQTTPUB, i.e. whether it could
+    be skipped when publishing again to the same topic, and that the client can
+    connect with a will message. Finally, messages are
+    published with A76XXMQTTClient::publishNonBlocking, with up to 8 messages in
+    flight, so that the rate is not bounded by the network latency.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/mqtt_publish_benchmark
+*/
+#include <string>
+
+#include "A76XX.h"
+#include "simulator.h"
+
+static const int      MESSAGES           = 25;
+static const uint32_t NETWORK_LATENCY_US = 20000;
+
+static const char*    TOPIC              = "sensors/room1/temperature";
+
+// publish as A76XXMQTTClient::publish did before MQTTCommands::publishMessage
+static int8_t publishSequential(MQTTCommands& cmds, const std::string& payload) {
+    int8_t retcode = cmds.setTopic(0, TOPIC);
+    if (retcode == A76XX_OPERATION_SUCCEEDED) {
+        retcode = cmds.setPayload(0, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+    }
+    if (retcode == A76XX_OPERATION_SUCCEEDED) {
+        retcode = cmds.publish(0, 1, 60);
+    }
+    return retcode;
+}
+
+enum Path_t {
+    SEQUENTIAL,
+    PIPELINED,
+    WINDOW
+};
+
+static const char* PATH_NAMES[] = {"sequential", "pipelined", "window 8"};
+
+static void onPublished(uint16_t handle, int8_t result, void* context) {
+    if (result == A76XX_OPERATION_SUCCEEDED) {
+        (*static_cast<int*>(context))++;
+    }
+}
+
+static bool run(uint32_t baud_rate, size_t payload_size, Path_t path) {
+    SimulatorConfig_t config;
+    config.baud_rate          = baud_rate;
+    config.network_latency_us = NETWORK_LATENCY_US;
+
+    A76XXSimulator sim(config);
+    A76XX modem(sim);
+    A76XXMQTTClient mqtt(modem, "benchmark");
+    MQTTCommands cmds(modem.serial);
+
+    if (modem.init() == false || mqtt.begin() == false ||
+        mqtt.connect("broker.example.com", 1883, true) == false) {
+        printf("setup failed\n");
+        return false;
+    }
+
+    int acknowledged = 0;
+    mqtt.onPublished(onPublished, &acknowledged);
+
+    std::string payload(payload_size, 'x');
+    sim.resetCounters();
+    uint32_t t0 = micros();
+    for (int i = 0; i < MESSAGES; i++) {
+        int8_t retcode = A76XX_OPERATION_SUCCEEDED;
+        if (path == SEQUENTIAL) {
+            retcode = publishSequential(cmds, payload);
+        } else if (path == PIPELINED) {
+            if (mqtt.publish(TOPIC, reinterpret_cast<const uint8_t*>(payload.data()),
+                             payload.size(), 1, 60) == false) {
+                retcode = mqtt.getLastError();
+            }
+        } else {
+            // when the window is full, process acknowledgements and retry
+            while (mqtt.publishNonBlocking(TOPIC, reinterpret_cast<const uint8_t*>(payload.data()),
+                                           payload.size(), 1, 60) == 0) {
+                retcode = mqtt.getLastError();
+                if (retcode != A76XX_MQTT_WINDOW_FULL) {
+                    break;
+                }
+                retcode = A76XX_OPERATION_SUCCEEDED;
+                mqtt.loop();
+            }
+        }
+        if (retcode != A76XX_OPERATION_SUCCEEDED) {
+            printf("publish failed with error %d\n", retcode);
+            return false;
+        }
+    }
+    if (path == WINDOW && (mqtt.waitPublished(5000) == false || acknowledged != MESSAGES)) {
+        printf("%d messages acknowledged\n", acknowledged);
+        return false;
+    }
+    double elapsed = (micros() - t0) * 1e-6;
+
+    if (sim.mqtt_messages_published != MESSAGES) {
+        printf("the simulator received %u messages\n", sim.mqtt_messages_published);
+        return false;
+    }
+
+    double uart_busy = baud_rate > 0 ? sim.bytes_received * 10.0 / baud_rate / elapsed : 0;
+    printf("%10s | %7u | %7zu | %8.1f | %9.2f | %9.1f | %9.1f | %8.1f\n",
+           PATH_NAMES[path], baud_rate, payload_size,
+           MESSAGES / elapsed,
+           MESSAGES * payload_size / elapsed / 1024,
+           static_cast<double>(sim.bytes_received) / MESSAGES,
+           static_cast<double>(sim.bytes_sent) / MESSAGES,
+           100 * uart_busy);
+    return true;
+}
+
+// publish a message, then publish again without setting the topic
+static bool topicKept() {
+    A76XXSimulator sim;
+    A76XX modem(sim);
+    A76XXMQTTClient mqtt(modem, "benchmark");
+    MQTTCommands cmds(modem.serial);
+
+    if (modem.init() == false || mqtt.begin() == false ||
+        mqtt.connect("broker.example.com", 1883, true) == false ||
+        mqtt.publish(TOPIC, "first", 1, 60) == false) {
+        return false;
+    }
+    const uint8_t payload[] = "second";
+    return cmds.setPayload(0, payload, sizeof(payload) - 1) == A76XX_OPERATION_SUCCEEDED &&
+           cmds.publish(0, 1, 60) == A76XX_OPERATION_SUCCEEDED;
+}
+
+// connect with a will, set with CMQTTWILLTOPIC and CMQTTWILLMSG
+static bool willConnect() {
+    A76XXSimulator sim;
+    A76XX modem(sim);
+    A76XXMQTTClient mqtt(modem, "benchmark");
+
+    uint32_t start = millis();
+    bool connected = modem.init() && mqtt.begin() &&
+                     mqtt.connect("broker.example.com", 1883, true, 60, NULL, NULL,
+                                  "devices/benchmark/status", "offline", 1);
+    printf("connect with a will: %s in %u ms\n", connected ? "yes" : "no",
+           static_cast<uint32_t>(millis() - start));
+    return connected;
+}
+
+int main() {
+    printf("topic kept after CMQTTPUB: %s\n", topicKept() ? "yes" : "no");
+    if (willConnect() == false) {
+        return 1;
+    }
+    printf("\n");
+
+    printf("%10s | %7s | %7s | %8s | %9s | %9s | %9s | %8s\n", "path", "baud", "payload",
+           "msg/s", "KiB/s", "tx B/msg", "rx B/msg", "busy [%]");
+
+    const uint32_t baud_rates[]    = {115200, 921600};
+    const size_t   payload_sizes[] = {16, 256, 2048};
+    for (uint32_t baud_rate : baud_rates) {
+        for (size_t payload_size : payload_sizes) {
+            for (Path_t path : {SEQUENTIAL, PIPELINED, WINDOW}) {
+                if (run(baud_rate, payload_size, path) == false) {
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
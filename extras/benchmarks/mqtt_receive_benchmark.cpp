@@ -0,0 +1,89 @@
+/*
+    End-to-end benchmark of the reception of MQTT messages by A76XXMQTTClient
+    against the simulator.
+
+    The simulated broker delivers a burst of messages back to back, i.e. as
+    fast as the UART allows. The application polls the modem and takes the
+    messages out of the queue of the client, either continuously or every
+    50 ms, as if it were busy with other work in between. The UART receive
+    FIFO of the host holds 256 bytes, as the default of the ESP32 core. We
+    report the rate of messages received, the messages lost and the bytes
+    lost to FIFO overruns.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/mqtt_receive_benchmark
+*/
+#include <string>
+
+#include "A76XX.h"
+#include "simulator.h"
+
+static const uint32_t MESSAGES       = 100;
+static const uint32_t RX_BUFFER_SIZE = 256;
+
+static bool run(uint32_t baud_rate, size_t payload_size, uint32_t busy_ms) {
+    SimulatorConfig_t config;
+    config.baud_rate      = baud_rate;
+    config.rx_buffer_size = RX_BUFFER_SIZE;
+
+    A76XXSimulator sim(config);
+    A76XX modem(sim);
+    A76XXMQTTClient mqtt(modem, "benchmark");
+
+    if (modem.init() == false || mqtt.begin() == false ||
+        mqtt.connect("broker.example.com", 1883, true) == false ||
+        mqtt.subscribe("sensors/#", 1) == false) {
+        printf("setup failed\n");
+        return false;
+    }
+
+    std::string payload(payload_size, 'x');
+    sim.resetCounters();
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        sim.injectMQTTMessage(0, "sensors/room1/temperature", payload);
+    }
+
+    // stop when no data is left, or after one more second
+    uint32_t received = 0;
+    uint32_t t0 = micros(), tlast = t0;
+    while (received < MESSAGES && micros() - tlast < 1000000) {
+        modem.poll();
+        MQTTMessageView_t msg;
+        while (mqtt.peekMessage(msg)) {
+            mqtt.consumeMessage();
+            received++;
+            tlast = micros();
+        }
+        if (busy_ms > 0) {
+            delay(busy_ms);
+        }
+    }
+    double elapsed = (tlast - t0) * 1e-6;
+
+    printf("%7u | %7zu | %8u | %8u | %8.1f | %8u | %8u\n",
+           baud_rate, payload_size, busy_ms, received,
+           elapsed > 0 ? received / elapsed : 0.0,
+           MESSAGES - received, sim.bytes_dropped);
+    return true;
+}
+
+int main() {
+    printf("%7s | %7s | %8s | %8s | %8s | %8s | %8s\n", "baud", "payload",
+           "busy ms", "received", "msg/s", "lost", "overrun");
+
+    const uint32_t baud_rates[]    = {115200, 921600};
+    const size_t   payload_sizes[] = {16, 60};
+    const uint32_t busy_ms[]       = {0, 50};
+    for (uint32_t baud_rate : baud_rates) {
+        for (size_t payload_size : payload_sizes) {
+            for (uint32_t busy : busy_ms) {
+                if (run(baud_rate, payload_size, busy) == false) {
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
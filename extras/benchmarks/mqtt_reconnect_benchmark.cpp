@@ -0,0 +1,91 @@
+/*
+    End-to-end benchmark of the automatic reconnection of A76XXMQTTClient against
+    the simulator.
+
+    The client subscribes to a few filters, then the connection to the broker is
+    dropped and connecting fails for the duration of an outage, as when the
+    network is down. We report the time from "+CMQTTCONNLOST" to the restored
+    subscriptions, the number of attempts, and check that the subscriptions are
+    restored by publishing a message that the simulated broker sends back. With
+    no outage, the first attempt is immediate, so the time is that of the round
+    trips of CMQTTCONNECT and CMQTTSUB. With an outage, it is rounded up to the
+    next attempt, after an exponential backoff from 250 ms with jitter. The last
+    case connects with a will message, which is set again before each attempt.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/mqtt_reconnect_benchmark
+*/
+#include "A76XX.h"
+#include "simulator.h"
+
+static const uint32_t NETWORK_LATENCY_US = 20000;
+static const uint32_t MIN_BACKOFF        = 250;
+static const uint32_t MAX_BACKOFF        = 4000;
+static const uint32_t RECOVERY_TIMEOUT   = 30000;
+
+static const char* const FILTERS[] = {"devices/42/cmd/#", "devices/all/+", "config"};
+
+static void onCommand(const MQTTMessageView_t& msg, void* context) {
+    (*static_cast<uint32_t*>(context))++;
+}
+
+static bool run(uint32_t outage_ms, bool will) {
+    SimulatorConfig_t config;
+    config.network_latency_us = NETWORK_LATENCY_US;
+    config.mqtt_loopback      = true;
+
+    A76XXSimulator sim(config);
+    A76XX modem(sim);
+    A76XXMQTTClient mqtt(modem, "benchmark");
+
+    uint32_t received = 0;
+    if (modem.init() == false || mqtt.begin() == false ||
+        mqtt.connect("broker.example.com", 1883, true, 60, NULL, NULL,
+                     will ? "devices/42/status" : NULL, will ? "offline" : NULL, 1) == false ||
+        mqtt.subscribeMany(FILTERS, 3, 1, onCommand, &received) == false) {
+        printf("setup failed\n");
+        return false;
+    }
+    mqtt.setAutoReconnect(true, NULL, MIN_BACKOFF, MAX_BACKOFF);
+
+    sim.dropMQTTConnection(0, outage_ms);
+    uint32_t start = millis();
+    do {
+        mqtt.loop();
+    } while (mqtt.connections() == 1 && millis() - start < RECOVERY_TIMEOUT);
+
+    MQTTReconnectStats_t stats = mqtt.getReconnectStats();
+    if (stats.reconnections != 1) {
+        printf("not reconnected after %u ms\n", RECOVERY_TIMEOUT);
+        return false;
+    }
+
+    // the message comes back only if the subscriptions have been restored
+    if (mqtt.publish("devices/42/cmd/reboot", "now", 1, 10) == false) {
+        printf("publish failed with error %d\n", mqtt.getLastError());
+        return false;
+    }
+    start = millis();
+    while (received == 0 && millis() - start < 1000) {
+        mqtt.loop();
+    }
+
+    printf("%10u | %4s | %13u | %8u | %13s\n", outage_ms, will ? "yes" : "no",
+           stats.last_recovery, stats.attempts, received > 0 ? "yes" : "no");
+    return received > 0;
+}
+
+int main() {
+    printf("%10s | %4s | %13s | %8s | %13s\n", "outage [ms]", "will",
+           "recovery [ms]", "attempts", "resubscribed");
+
+    const uint32_t outages[] = {0, 1000, 5000};
+    for (uint32_t outage_ms : outages) {
+        if (run(outage_ms, false) == false) {
+            return 1;
+        }
+    }
+    return run(1000, true) ? 0 : 1;
+}
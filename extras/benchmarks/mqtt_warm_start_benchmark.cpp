@@ -0,0 +1,70 @@
+/*
+    End-to-end benchmark of A76XXMQTTClient::resume against the simulator.
+
+    We report the time from the construction of the client to the acknowledgement
+    of the first message with QoS 1, after modem initialisation, for:
+        - a cold start, with ::begin and ::connect, as after a power cycle;
+        - a warm start, with ::resume, after the objects of a first run are
+          destroyed while the simulated module stays connected, as when the
+          micro-controller wakes up from deep sleep;
+        - a warm start with ::resume after the broker has dropped the connection,
+          where the service is found running and only the client is set up again.
+    The simulated broker answers after a network latency of 100 ms.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/mqtt_warm_start_benchmark
+*/
+#include "A76XX.h"
+#include "simulator.h"
+
+static const uint32_t NETWORK_LATENCY_US = 100000;
+
+static const char*    BROKER             = "broker.example.com";
+static const char*    TOPIC              = "sensors/room1/temperature";
+
+// time to the first message in ms, or a negative value on failure
+static double firstPublish(A76XXSimulator& sim, const char* label, bool warm, bool& resumed) {
+    A76XX modem(sim);
+    if (modem.init() == false) {
+        printf("modem init failed\n");
+        return -1;
+    }
+
+    uint32_t commands = sim.commands_received;
+    uint32_t t0 = micros();
+    A76XXMQTTClient mqtt(modem, "benchmark");
+    bool ok = warm ? mqtt.resume(BROKER, 1883, false)
+                   : mqtt.begin() && mqtt.connect(BROKER, 1883, false);
+    if (ok == false || mqtt.publish(TOPIC, "21.5", 1, 10) == false) {
+        printf("first publish failed with error %d\n", mqtt.getLastError());
+        return -1;
+    }
+    double elapsed = (micros() - t0) * 1e-3;
+
+    resumed = mqtt.resumed();
+    printf("%-22s | %9.1f | %8u | %7s\n",
+           label, elapsed, sim.commands_received - commands, resumed ? "yes" : "no");
+    return elapsed;
+}
+
+int main() {
+    SimulatorConfig_t config;
+    config.network_latency_us = NETWORK_LATENCY_US;
+
+    printf("%-22s | %9s | %8s | %7s\n", "start", "time [ms]", "commands", "resumed");
+
+    A76XXSimulator sim(config);
+    bool resumed;
+    if (firstPublish(sim, "cold", false, resumed) < 0 ||
+        firstPublish(sim, "warm, connected", true, resumed) < 0 || resumed == false) {
+        return 1;
+    }
+
+    sim.dropMQTTConnection(0);
+    if (firstPublish(sim, "warm, disconnected", true, resumed) < 0 || resumed) {
+        return 1;
+    }
+    return 0;
+}
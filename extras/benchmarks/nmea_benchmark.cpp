@@ -0,0 +1,89 @@
+/*
+    End-to-end benchmark of the reception of NMEA sentences by A76XXGNSSClient
+    against the simulator.
+
+    The simulator sends a GGA and a RMC sentence at 10 Hz. The application
+    receives them for a few seconds in three scenarios:
+
+    - continuous: the modem is polled and the queue is emptied continuously;
+    - busy: the application does other work for 250 ms between polls, and data
+      is lost when the 256 bytes UART receive FIFO of the host overflows;
+    - slow reader: the modem is polled continuously, but the queue is emptied
+      only at the end, so that old sentences are overwritten.
+
+    We report the sentences sent, those received intact and corrupted, the bytes
+    lost to FIFO overruns and the fraction of sentences not received intact.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/nmea_benchmark
+*/
+#include "A76XX.h"
+#include "simulator.h"
+
+static const uint32_t NMEA_RATE_HZ   = 10;
+static const uint32_t DURATION_MS    = 3000;
+static const uint32_t RX_BUFFER_SIZE = 256;
+
+struct Counter_t {
+    uint32_t received = 0;
+    uint32_t corrupt  = 0;
+
+    void add(const NMEAMessage_t& msg) {
+        // e.g. "$GNGGA,000012.00,...*5C", truncated sentences have no checksum
+        if (strchr(msg.payload, ',') == NULL || strchr(msg.payload, '*') == NULL) {
+            corrupt++;
+        } else {
+            received++;
+        }
+    }
+};
+
+static bool run(const char* scenario, uint32_t busy_ms, bool read_at_end) {
+    SimulatorConfig_t config;
+    config.rx_buffer_size = RX_BUFFER_SIZE;
+
+    A76XXSimulator sim(config);
+    sim.setNMEARate(NMEA_RATE_HZ);
+    A76XX modem(sim);
+    A76XXGNSSClient gnss(modem);
+
+    if (modem.init() == false || gnss.enableGNSS(GPSStart_t::HOT) == false ||
+        gnss.enableNMEAStream(NMEA_RATE_HZ) == false) {
+        printf("setup failed\n");
+        return false;
+    }
+
+    sim.resetCounters();
+    Counter_t counter;
+    uint32_t t0 = millis();
+    while (millis() - t0 < DURATION_MS) {
+        modem.poll();
+        while (read_at_end == false && gnss.nmeaAvailable() > 0) {
+            counter.add(gnss.getNMEAMessage());
+        }
+        if (busy_ms > 0) {
+            delay(busy_ms);
+        }
+    }
+    modem.listen(200);
+    while (gnss.nmeaAvailable() > 0) {
+        counter.add(gnss.getNMEAMessage());
+    }
+
+    uint32_t sent = sim.nmea_sentences_sent;
+    printf("%-12s | %6u | %8u | %7u | %8u | %7.1f\n", scenario, sent,
+           counter.received, counter.corrupt, sim.bytes_dropped,
+           sent > 0 ? 100.0 * (sent - counter.received) / sent : 0.0);
+    return true;
+}
+
+int main() {
+    printf("%-12s | %6s | %8s | %7s | %8s | %7s\n", "scenario", "sent",
+           "received", "corrupt", "overrun", "drop %");
+
+    return run("continuous", 0, false) &&
+           run("busy", 250, false) &&
+           run("slow reader", 0, true) ? 0 : 1;
+}
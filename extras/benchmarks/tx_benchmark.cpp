@@ -0,0 +1,190 @@
+/*
+    Host-side benchmark of the commands sent by A76XXMQTTClient::publish.
+
+    A mock Stream, that answers like the module does, counts the calls to `write`
+    and `flush` made by the library and the bytes sent. For each command of the
+    publish path (CMQTTTOPIC, CMQTTPAYLOAD and CMQTTPUB) we compare the previous
+    approach, where each argument was printed separately and followed by a flush,
+    with ModemSerial::sendCMD and ModemSerial::sendCMDNoFlush, reporting calls
+    per command, the host time per command and the time the caller would be
+    blocked waiting for the UART to drain at 115200 baud. Then the full publish
+    call is run against the mock.
+
+    Build and run from the root of the repository with
+
+        cmake -S . -B build && cmake --build build
+        ./build/tx_benchmark
+*/
+#include <chrono>
+#include <string>
+
+#include "A76XX.h"
+
+// time to send one byte at 115200 baud, with 8N1 framing
+static const double BYTE_TIME_US = 10 * 1.0e6 / 115200;
+
+class MockModem : public Stream {
+  private:
+    std::string _rx;
+    size_t      _rx_pos;
+    std::string _line;
+    size_t      _raw_expected;
+
+    // bytes written since the last flush
+    size_t      _pending;
+
+    void reply(const char* str) {
+        _rx += str;
+    }
+
+    // answer a complete command line
+    void process(const std::string& line) {
+        size_t pos = line.rfind(',');
+        if (line.compare(0, 14, "AT+CMQTTTOPIC=") == 0 ||
+            line.compare(0, 16, "AT+CMQTTPAYLOAD=") == 0) {
+            _raw_expected = atoi(line.c_str() + pos + 1);
+            reply(">");
+        } else if (line.compare(0, 12, "AT+CMQTTPUB=") == 0) {
+            reply("OK\r\n\r\n+CMQTTPUB: 0,0\r\n");
+        } else {
+            reply("OK\r\n");
+        }
+    }
+
+  public:
+    size_t writes;
+    size_t flushes;
+    size_t bytes;
+    double blocked_us;
+
+    MockModem() : _rx_pos(0), _raw_expected(0) { resetCounters(); }
+
+    void resetCounters() {
+        writes = flushes = bytes = _pending = 0;
+        blocked_us = 0;
+    }
+
+    int available() { return _rx.size() - _rx_pos; }
+
+    int read() {
+        if (_rx_pos == _rx.size()) { return -1; }
+        int c = static_cast<uint8_t>(_rx[_rx_pos++]);
+        if (_rx_pos == _rx.size()) { _rx.clear(); _rx_pos = 0; }
+        return c;
+    }
+
+    int peek() { return _rx_pos < _rx.size() ? static_cast<uint8_t>(_rx[_rx_pos]) : -1; }
+
+    using Print::write;
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+        writes++; bytes += size; _pending += size;
+        for (size_t i = 0; i < size; i++) {
+            char c = static_cast<char>(buffer[i]);
+            if (_raw_expected > 0) {
+                // raw data following a '>' prompt
+                if (--_raw_expected == 0) { reply("OK\r\n"); }
+                continue;
+            }
+            _line += c;
+            if (_line.size() >= 2 && _line.compare(_line.size() - 2, 2, "\r\n") == 0) {
+                process(_line.substr(0, _line.size() - 2));
+                _line.clear();
+            }
+        }
+        return size;
+    }
+
+    // flush blocks until all bytes written since the previous flush are sent
+    void flush() {
+        flushes++;
+        blocked_us += _pending * BYTE_TIME_US;
+        _pending = 0;
+    }
+};
+
+// the previous ModemSerial::sendCMD, verbatim apart from the stream argument
+template <typename ARG>
+void legacyPrintCMD(Stream& stream, ARG arg) {
+    stream.print(arg);
+    stream.flush();
+}
+
+template <typename HEAD, typename... TAIL>
+void legacyPrintCMD(Stream& stream, HEAD head, TAIL... tail) {
+    stream.print(head);
+    stream.flush();
+    legacyPrintCMD(stream, tail...);
+}
+
+template <typename... ARGS>
+void legacySendCMD(Stream& stream, ARGS... args) {
+    legacyPrintCMD(stream, args..., "\r\n");
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static const int ITERATIONS = 100000;
+
+static void report(const char* command, const char* method, MockModem& mock, Clock::time_point t0) {
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / ITERATIONS;
+    printf("%-14s | %-15s | %6.1f | %7.1f | %5.1f | %11.0f | %10.1f\n", command, method,
+           double(mock.writes) / ITERATIONS, double(mock.flushes) / ITERATIONS,
+           double(mock.bytes) / ITERATIONS, ns, mock.blocked_us / ITERATIONS);
+    mock.resetCounters();
+}
+
+// run the same command through the three approaches
+#define BENCHMARK_COMMAND(name, ...) {                              \
+        MockModem mock; ModemSerial serial(mock);                   \
+        Clock::time_point t0 = Clock::now();                        \
+        for (int i = 0; i < ITERATIONS; i++) {                      \
+            legacySendCMD(mock, __VA_ARGS__);                       \
+        }                                                           \
+        report(name, "print + flush", mock, t0);                    \
+        t0 = Clock::now();                                          \
+        for (int i = 0; i < ITERATIONS; i++) {                      \
+            serial.sendCMD(__VA_ARGS__);                            \
+        }                                                           \
+        report(name, "sendCMD", mock, t0);                          \
+        t0 = Clock::now();                                          \
+        for (int i = 0; i < ITERATIONS; i++) {                      \
+            serial.sendCMDNoFlush(__VA_ARGS__);                     \
+        }                                                           \
+        report(name, "sendCMDNoFlush", mock, t0);                   \
+    }
+
+int main() {
+    const char*    topic       = "sensors/room1/temperature";
+    const char*    payload     = "{\"t\":21.45,\"h\":48.2}";
+    uint8_t        client      = 0;
+    uint8_t        qos         = 1;
+    uint8_t        pub_timeout = 60;
+    uint8_t        retained    = 0;
+    uint8_t        dup         = 0;
+
+    printf("%-14s | %-15s | %6s | %7s | %5s | %11s | %10s\n", "command", "method",
+           "writes", "flushes", "bytes", "host [ns]", "block [us]");
+
+    BENCHMARK_COMMAND("CMQTTTOPIC", "AT+CMQTTTOPIC=", client, ",", strlen(topic));
+    BENCHMARK_COMMAND("CMQTTPAYLOAD", "AT+CMQTTPAYLOAD=0,", strlen(payload));
+    BENCHMARK_COMMAND("CMQTTPUB", "AT+CMQTTPUB=", client, ",", qos, ",", pub_timeout, ",",
+                      retained, ",", dup);
+
+    // full publish, including data and responses
+    MockModem mock;
+    A76XX modem(mock);
+    A76XXMQTTClient mqtt(modem, "benchmark");
+    Clock::time_point t0 = Clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        if (mqtt.publish(topic, payload, qos, pub_timeout) == false) {
+            printf("publish failed with error %d\n", mqtt.getLastError());
+            return 1;
+        }
+    }
+    report("publish", "A76XXMQTTClient", mock, t0);
+
+    return 0;
+}
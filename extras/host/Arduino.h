@@ -0,0 +1,256 @@
+#ifndef A76XX_HOST_ARDUINO_H_
+#define A76XX_HOST_ARDUINO_H_
+
+/*
+    Minimal subset of the Arduino core used by the library, so that it can be
+    compiled and run on a Linux host, e.g. for benchmarks. Only what the library
+    actually uses is provided, with the same semantics as the Arduino core.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <sys/types.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#define DEC 10
+
+// binary constants from the Arduino core, as used in src/commands/gnss.h
+#define B00000001 1
+#define B00000010 2
+#define B00000100 4
+#define B00001000 8
+#define B00010000 16
+#define B00100000 32
+#define B01000000 64
+#define B10000000 128
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    static const steady_clock::time_point t0 = steady_clock::now();
+    return static_cast<unsigned long>(duration_cast<microseconds>(steady_clock::now() - t0).count());
+}
+
+inline unsigned long millis() {
+    return micros() / 1000;
+}
+
+inline void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+class String {
+  private:
+    std::string _str;
+
+  public:
+    String() {}
+    String(const char* str) : _str(str != NULL ? str : "") {}
+
+    unsigned char reserve(unsigned int size) { _str.reserve(size); return 1; }
+    unsigned char concat(const char* str, unsigned int length) { _str.append(str, length); return 1; }
+    String& operator += (char c) { _str += c; return *this; }
+    String& operator += (const char* str) { _str += str; return *this; }
+    String& operator += (const String& str) { _str += str._str; return *this; }
+    bool operator == (const char* str) const { return _str == str; }
+    char operator [] (unsigned int index) const { return _str[index]; }
+
+    const char* c_str() const { return _str.c_str(); }
+    unsigned int length() const { return _str.size(); }
+};
+
+class Print {
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) {
+            n += write(*buffer++);
+        }
+        return n;
+    }
+
+    size_t write(const char* str) {
+        return str != NULL ? write(reinterpret_cast<const uint8_t*>(str), strlen(str)) : 0;
+    }
+
+    size_t write(const char* buffer, size_t size) {
+        return write(reinterpret_cast<const uint8_t*>(buffer), size);
+    }
+
+    virtual void flush() {}
+
+    size_t print(const char* str)      { return write(str); }
+    size_t print(const String& str)    { return write(str.c_str()); }
+    size_t print(char c)               { return write(static_cast<uint8_t>(c)); }
+    size_t print(unsigned char n)      { return print(static_cast<unsigned long>(n)); }
+    size_t print(int n)                { return print(static_cast<long>(n)); }
+    size_t print(unsigned int n)       { return print(static_cast<unsigned long>(n)); }
+    size_t print(long n)               { char buf[24]; snprintf(buf, sizeof(buf), "%ld", n); return write(buf); }
+    size_t print(unsigned long n)      { char buf[24]; snprintf(buf, sizeof(buf), "%lu", n); return write(buf); }
+    size_t print(double n, int digits = 2) {
+        char buf[48]; snprintf(buf, sizeof(buf), "%.*f", digits, n); return write(buf);
+    }
+
+    size_t println() { return write("\r\n"); }
+
+    template <typename T>
+    size_t println(T value) {
+        size_t n = print(value);
+        return n + println();
+    }
+};
+
+class Stream : public Print {
+  protected:
+    unsigned long _timeout;
+
+    int timedRead() {
+        unsigned long tstart = millis();
+        do {
+            int c = read();
+            if (c >= 0) { return c; }
+        } while (millis() - tstart < _timeout);
+        return -1;
+    }
+
+    int timedPeek() {
+        unsigned long tstart = millis();
+        do {
+            int c = peek();
+            if (c >= 0) { return c; }
+        } while (millis() - tstart < _timeout);
+        return -1;
+    }
+
+    // skip characters until the start of a number, return the first one or -1
+    int peekNextDigit(bool allow_dot) {
+        while (true) {
+            int c = timedPeek();
+            if (c < 0 || c == '-' || (c >= '0' && c <= '9') || (allow_dot && c == '.')) {
+                return c;
+            }
+            read();
+        }
+    }
+
+  public:
+    Stream() : _timeout(1000) {}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    unsigned long getTimeout() { return _timeout; }
+
+    bool find(const char* target) {
+        return findUntil(target, NULL);
+    }
+
+    bool find(char target) {
+        char str[2] = {target, '\0'};
+        return find(str);
+    }
+
+    bool findUntil(const char* target, const char* terminator) {
+        size_t target_len = strlen(target);
+        size_t term_len   = terminator != NULL ? strlen(terminator) : 0;
+        size_t target_idx = 0, term_idx = 0;
+        if (target_len == 0) {
+            return true;
+        }
+        int c;
+        while ((c = timedRead()) >= 0) {
+            if (c == target[target_idx]) {
+                if (++target_idx == target_len) { return true; }
+            } else {
+                target_idx = c == target[0] ? 1 : 0;
+            }
+            if (term_len > 0) {
+                if (c == terminator[term_idx]) {
+                    if (++term_idx == term_len) { return false; }
+                } else {
+                    term_idx = c == terminator[0] ? 1 : 0;
+                }
+            }
+        }
+        return false;
+    }
+
+    long parseInt() {
+        int c = peekNextDigit(false);
+        if (c < 0) {
+            return 0;
+        }
+        bool negative = false;
+        long value = 0;
+        do {
+            if (c == '-') {
+                negative = true;
+            } else {
+                value = value * 10 + c - '0';
+            }
+            read();
+            c = timedPeek();
+        } while (c >= '0' && c <= '9');
+        return negative ? -value : value;
+    }
+
+    float parseFloat() {
+        int c = peekNextDigit(true);
+        if (c < 0) {
+            return 0;
+        }
+        bool negative = false, fraction = false;
+        double value = 0, scale = 1;
+        do {
+            if (c == '-') {
+                negative = true;
+            } else if (c == '.') {
+                fraction = true;
+            } else {
+                value = value * 10 + c - '0';
+                if (fraction) { scale *= 0.1; }
+            }
+            read();
+            c = timedPeek();
+        } while ((c >= '0' && c <= '9') || (c == '.' && !fraction));
+        return static_cast<float>((negative ? -value : value) * scale);
+    }
+
+    size_t readBytes(char* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length) {
+            int c = timedRead();
+            if (c < 0) { break; }
+            buffer[count++] = static_cast<char>(c);
+        }
+        return count;
+    }
+
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        return readBytes(reinterpret_cast<char*>(buffer), length);
+    }
+
+    size_t readBytesUntil(char terminator, char* buffer, size_t length) {
+        size_t count = 0;
+        while (count < length) {
+            int c = timedRead();
+            if (c < 0 || c == terminator) { break; }
+            buffer[count++] = static_cast<char>(c);
+        }
+        return count;
+    }
+};
+
+#endif A76XX_HOST_ARDUINO_H_
@@ -0,0 +1,67 @@
+#ifndef A76XX_HOST_CIRCULARBUFFER_H_
+#define A76XX_HOST_CIRCULARBUFFER_H_
+
+/*
+    Subset of the CircularBuffer library (https://github.com/rlogiacco/CircularBuffer)
+    used by A76XX, with the same semantics, for host builds.
+*/
+
+#include <stddef.h>
+
+template <typename T, size_t S>
+class CircularBuffer {
+  private:
+    T      _buffer[S];
+    size_t _head;
+    size_t _count;
+
+  public:
+    CircularBuffer() : _head(0), _count(0) {}
+
+    // add at the end, overwriting the first element if full; return false if so
+    bool push(T value) {
+        _buffer[(_head + _count) % S] = value;
+        if (_count == S) {
+            _head = (_head + 1) % S;
+            return false;
+        }
+        _count++;
+        return true;
+    }
+
+    // add at the start, overwriting the last element if full; return false if so
+    bool unshift(T value) {
+        _head = (_head + S - 1) % S;
+        _buffer[_head] = value;
+        if (_count == S) {
+            return false;
+        }
+        _count++;
+        return true;
+    }
+
+    T shift() {
+        T value = _buffer[_head];
+        _head = (_head + 1) % S;
+        _count--;
+        return value;
+    }
+
+    T pop() {
+        _count--;
+        return _buffer[(_head + _count) % S];
+    }
+
+    T first() const { return _buffer[_head]; }
+    T last() const { return _buffer[(_head + _count - 1) % S]; }
+    T operator [] (size_t index) const { return _buffer[(_head + index) % S]; }
+
+    size_t size() const { return _count; }
+    size_t available() const { return S - _count; }
+    size_t capacity() const { return S; }
+    bool isEmpty() const { return _count == 0; }
+    bool isFull() const { return _count == S; }
+    void clear() { _head = 0; _count = 0; }
+};
+
+#endif A76XX_HOST_CIRCULARBUFFER_H_
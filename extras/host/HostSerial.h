@@ -0,0 +1,133 @@
+#ifndef A76XX_HOST_HOSTSERIAL_H_
+#define A76XX_HOST_HOSTSERIAL_H_
+
+/*
+    A Stream on a serial port of the host, e.g. "/dev/ttyUSB0" for a module on
+    a USB adapter, or the pseudo terminal of a SimulatorPty, so that the library
+    can be run natively on Linux against a module or the simulator.
+*/
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+
+class HostSerial : public Stream {
+  private:
+    int                                              _fd;
+    uint8_t                                 _buffer[256];
+    size_t                                         _head;
+    size_t                                         _tail;
+
+    static speed_t toSpeed(uint32_t baud_rate) {
+        switch (baud_rate) {
+            case 9600    : return B9600;
+            case 19200   : return B19200;
+            case 38400   : return B38400;
+            case 57600   : return B57600;
+            case 230400  : return B230400;
+            case 460800  : return B460800;
+            case 921600  : return B921600;
+            default      : return B115200;
+        }
+    }
+
+    // read what is available without blocking, if the buffer is empty
+    void fill() {
+        if (_head == _tail && _fd >= 0) {
+            ssize_t n = ::read(_fd, _buffer, sizeof(_buffer));
+            _head = 0;
+            _tail = n > 0 ? n : 0;
+        }
+    }
+
+  public:
+    HostSerial()
+        : _fd(-1)
+        , _head(0)
+        , _tail(0) {}
+
+    ~HostSerial() {
+        end();
+    }
+
+    /*
+        @brief Open the serial port in raw mode.
+
+        @param [IN] path The device, e.g. "/dev/ttyUSB0".
+        @param [IN] baud_rate The baud rate, ignored by pseudo terminals.
+        @return False if the device could not be opened.
+    */
+    bool begin(const char* path, uint32_t baud_rate = 115200) {
+        end();
+        _fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (_fd < 0) {
+            return false;
+        }
+        struct termios tio;
+        if (tcgetattr(_fd, &tio) == 0) {
+            cfmakeraw(&tio);
+            cfsetispeed(&tio, toSpeed(baud_rate));
+            cfsetospeed(&tio, toSpeed(baud_rate));
+            tcsetattr(_fd, TCSANOW, &tio);
+        }
+        return true;
+    }
+
+    void end() {
+        if (_fd >= 0) {
+            close(_fd);
+            _fd = -1;
+        }
+        _head = _tail = 0;
+    }
+
+    int available() {
+        fill();
+        int pending = 0;
+        if (_fd >= 0) {
+            ioctl(_fd, FIONREAD, &pending);
+        }
+        return static_cast<int>(_tail - _head) + pending;
+    }
+
+    int read() {
+        fill();
+        return _head < _tail ? _buffer[_head++] : -1;
+    }
+
+    int peek() {
+        fill();
+        return _head < _tail ? _buffer[_head] : -1;
+    }
+
+    using Print::write;
+
+    size_t write(uint8_t c) {
+        return write(&c, 1);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) {
+        size_t written = 0;
+        while (_fd >= 0 && written < size) {
+            ssize_t n = ::write(_fd, buffer + written, size - written);
+            if (n > 0) {
+                written += n;
+            } else {
+                // the device is busy, wait for it
+                delay(1);
+            }
+        }
+        return written;
+    }
+
+    void flush() {
+        if (_fd >= 0) {
+            tcdrain(_fd);
+        }
+    }
+};
+
+#endif A76XX_HOST_HOSTSERIAL_H_
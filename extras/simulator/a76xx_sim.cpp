@@ -0,0 +1,79 @@
+/*
+    Run the simulator on a pseudo terminal, e.g. to test a program built with
+    HostSerial, or to type AT commands with a terminal program.
+
+        ./build/a76xx_sim [--baud N] [--latency US] [--network-latency US]
+                          [--nmea-rate HZ] [--mqtt-rate HZ] [--http-size BYTES]
+
+    --mqtt-rate injects MQTT messages on client 0, on topic "sim/counter", with
+    a counter as payload. --http-size serves a body of the given size on path
+    "/data". The path of the pseudo terminal is printed on start. Stop with Ctrl-C.
+*/
+#include <getopt.h>
+#include <signal.h>
+
+#include "simulator_pty.h"
+
+static volatile bool running = true;
+
+static void stop(int) {
+    running = false;
+}
+
+int main(int argc, char** argv) {
+    SimulatorConfig_t config;
+    uint32_t nmea_rate = 0, mqtt_rate = 0, http_size = 1024;
+
+    static const struct option options[] = {
+        {"baud",            required_argument, NULL, 'b'},
+        {"latency",         required_argument, NULL, 'l'},
+        {"network-latency", required_argument, NULL, 'n'},
+        {"nmea-rate",       required_argument, NULL, 'g'},
+        {"mqtt-rate",       required_argument, NULL, 'm'},
+        {"http-size",       required_argument, NULL, 's'},
+        {NULL, 0, NULL, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", options, NULL)) != -1) {
+        switch (opt) {
+            case 'b' : { config.baud_rate          = strtoul(optarg, NULL, 10); break; }
+            case 'l' : { config.command_latency_us = strtoul(optarg, NULL, 10); break; }
+            case 'n' : { config.network_latency_us = strtoul(optarg, NULL, 10); break; }
+            case 'g' : { nmea_rate                 = strtoul(optarg, NULL, 10); break; }
+            case 'm' : { mqtt_rate                 = strtoul(optarg, NULL, 10); break; }
+            case 's' : { http_size                 = strtoul(optarg, NULL, 10); break; }
+            default  : {
+                fprintf(stderr, "usage: %s [--baud N] [--latency US] [--network-latency US] "
+                                "[--nmea-rate HZ] [--mqtt-rate HZ] [--http-size BYTES]\n", argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    A76XXSimulator sim(config);
+    sim.setNMEARate(nmea_rate);
+    sim.addHTTPResource("/data", std::string(http_size, 'x'));
+
+    SimulatorPty pty(sim);
+    if (pty.begin() == false) {
+        perror("cannot open pseudo terminal");
+        return 1;
+    }
+    printf("%s\n", pty.path());
+    fflush(stdout);
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    uint32_t counter = 0;
+    while (running) {
+        if (mqtt_rate > 0) {
+            std::lock_guard<std::mutex> lock(pty.mutex());
+            sim.injectMQTTMessage(0, "sim/counter", std::to_string(counter++));
+        }
+        delay(mqtt_rate > 0 ? 1000 / mqtt_rate : 100);
+    }
+
+    pty.end();
+    return 0;
+}
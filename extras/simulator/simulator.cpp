@@ -0,0 +1,844 @@
+#include "simulator.h"
+
+// split the arguments of a command at commas outside quotes, removing the quotes
+static std::vector<std::string> splitArgs(const std::string& str) {
+    std::vector<std::string> args;
+    std::string arg;
+    bool quoted = false;
+    for (char c : str) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == ',' && !quoted) {
+            args.push_back(arg);
+            arg.clear();
+        } else {
+            arg += c;
+        }
+    }
+    args.push_back(arg);
+    return args;
+}
+
+// split a command line, without the leading "AT", at semicolons outside quotes
+static std::vector<std::string> splitCommands(const std::string& str) {
+    std::vector<std::string> cmds;
+    std::string cmd;
+    bool quoted = false;
+    for (char c : str) {
+        if (c == '"') {
+            quoted = !quoted;
+        }
+        if (c == ';' && !quoted) {
+            cmds.push_back(cmd);
+            cmd.clear();
+        } else {
+            cmd += c;
+        }
+    }
+    cmds.push_back(cmd);
+    return cmds;
+}
+
+static int toInt(const std::vector<std::string>& args, size_t index, int fallback = -1) {
+    return index < args.size() && !args[index].empty() ? atoi(args[index].c_str()) : fallback;
+}
+
+// MQTT topic filter matching, with the wildcards '+' and '#'
+static bool topicMatches(const std::string& filter, const std::string& topic) {
+    size_t f = 0, t = 0;
+    while (f < filter.size()) {
+        if (filter[f] == '#') {
+            return true;
+        }
+        if (filter[f] == '+') {
+            while (t < topic.size() && topic[t] != '/') {
+                t++;
+            }
+            f++;
+            continue;
+        }
+        if (t == topic.size() || filter[f] != topic[t]) {
+            return false;
+        }
+        f++;
+        t++;
+    }
+    return t == topic.size();
+}
+
+// the path of a URL, e.g. "/data.json" for "http://example.com:80/data.json"
+static std::string urlPath(const std::string& url) {
+    size_t start = url.find("://");
+    start = start == std::string::npos ? 0 : start + 3;
+    size_t slash = url.find('/', start);
+    if (slash == std::string::npos) {
+        return "/";
+    }
+    // the library prepends a '/' to the path given by the user
+    while (slash + 1 < url.size() && url[slash + 1] == '/') {
+        slash++;
+    }
+    return url.substr(slash);
+}
+
+static std::string formatNMEA(const char* body) {
+    uint8_t checksum = 0;
+    for (const char* c = body; *c != '\0'; c++) {
+        checksum ^= static_cast<uint8_t>(*c);
+    }
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+    return std::string("$") + body + tail;
+}
+
+A76XXSimulator::A76XXSimulator()
+    : A76XXSimulator(SimulatorConfig_t()) {}
+
+A76XXSimulator::A76XXSimulator(const SimulatorConfig_t& cfg)
+    : config(cfg)
+    , _sequence(0)
+    , _out_free_ns(0)
+    , _rx_pos(0)
+    , _in_free_ns(0)
+    , _raw_target(RAW_NONE)
+    , _raw_expected(0)
+    , _raw_client(0)
+    , _after_cr(false)
+    , _mqtt_started(false)
+    , _mqtt_acquired{false, false}
+    , _mqtt_connected{false, false}
+    , _mqtt_outage_end{0, 0}
+    , _http_started(false)
+    , _http_response(NULL)
+    , _pdp_active(false)
+    , _gnss_power(false)
+    , _nmea_output(false)
+    , _nmea_rate(0)
+    , _nmea_next_ns(0)
+    , _nmea_count(0) {
+    _not_found.status_code = 404;
+    _not_found.header      = "HTTP/1.1 404 Not Found";
+    resetCounters();
+}
+
+void A76XXSimulator::resetCounters() {
+    commands_received       = 0;
+    bytes_received          = 0;
+    bytes_sent              = 0;
+    bytes_dropped           = 0;
+    mqtt_messages_published = 0;
+    mqtt_messages_injected  = 0;
+    nmea_sentences_sent     = 0;
+    http_requests           = 0;
+}
+
+uint64_t A76XXSimulator::now() const {
+    return static_cast<uint64_t>(micros()) * 1000;
+}
+
+uint64_t A76XXSimulator::byteTime() const {
+    // 10 bits per byte, i.e. 8N1 framing
+    return config.baud_rate == 0 ? 0 : 10000000000ULL / config.baud_rate;
+}
+
+int A76XXSimulator::available() {
+    update();
+    return _rx.size() - _rx_pos;
+}
+
+int A76XXSimulator::read() {
+    update();
+    if (_rx_pos == _rx.size()) {
+        return -1;
+    }
+    int c = static_cast<uint8_t>(_rx[_rx_pos++]);
+    if (_rx_pos == _rx.size()) {
+        _rx.clear();
+        _rx_pos = 0;
+    }
+    return c;
+}
+
+int A76XXSimulator::peek() {
+    update();
+    return _rx_pos < _rx.size() ? static_cast<uint8_t>(_rx[_rx_pos]) : -1;
+}
+
+size_t A76XXSimulator::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t A76XXSimulator::write(const uint8_t* buffer, size_t size) {
+    update();
+    uint64_t t = now();
+    for (size_t i = 0; i < size; i++) {
+        // each byte reaches the module one byte time after the previous one
+        _in_free_ns = (_in_free_ns > t ? _in_free_ns : t) + byteTime();
+        processByte(static_cast<char>(buffer[i]), _in_free_ns);
+    }
+    bytes_received += size;
+    return size;
+}
+
+void A76XXSimulator::flush() {
+    // wait for the data to leave the UART, as HardwareSerial::flush does
+    uint64_t t = now();
+    if (_in_free_ns > t) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(_in_free_ns - t));
+    }
+    update();
+}
+
+void A76XXSimulator::update() {
+    uint64_t t = now();
+
+    // responses, URCs and NMEA sentences that are due, in order of time
+    uint64_t period = _nmea_rate > 0 ? 1000000000ULL / _nmea_rate : 0;
+    bool nmea = _gnss_power && _nmea_output && period > 0;
+    while (true) {
+        bool has_output = !_scheduled.empty() && _scheduled.top().time_ns <= t;
+        bool has_nmea   = nmea && _nmea_next_ns <= t;
+        if (has_nmea && (!has_output || _nmea_next_ns < _scheduled.top().time_ns)) {
+            sendNMEA(_nmea_next_ns);
+            _nmea_next_ns += period;
+        } else if (has_output) {
+            send(_scheduled.top().data, _scheduled.top().time_ns);
+            _scheduled.pop();
+        } else {
+            break;
+        }
+    }
+
+    receive(t);
+}
+
+bool A76XXSimulator::idle() {
+    update();
+    return _scheduled.empty() && _out.empty() && _rx_pos == _rx.size();
+}
+
+void A76XXSimulator::schedule(const std::string& data, uint64_t time_ns) {
+    _scheduled.push({time_ns, _sequence++, data});
+}
+
+void A76XXSimulator::send(const std::string& data, uint64_t time_ns) {
+    uint64_t start = time_ns > _out_free_ns ? time_ns : _out_free_ns;
+    _out.push_back({start, data, 0});
+    _out_free_ns = start + data.size() * byteTime();
+}
+
+void A76XXSimulator::receive(uint64_t time_ns) {
+    uint64_t byte_time = byteTime();
+    while (!_out.empty()) {
+        Segment_t& segment = _out.front();
+        if (time_ns < segment.start_ns) {
+            break;
+        }
+
+        // byte i leaves the module at start + (i + 1) * byte_time
+        size_t sent = segment.data.size();
+        if (byte_time > 0) {
+            uint64_t n = (time_ns - segment.start_ns) / byte_time;
+            sent = n < sent ? n : sent;
+        }
+
+        // the bytes that do not fit in the FIFO are lost
+        size_t n = sent - segment.pos;
+        size_t space = n;
+        if (config.rx_buffer_size > 0) {
+            size_t used = _rx.size() - _rx_pos;
+            space = used < config.rx_buffer_size ? config.rx_buffer_size - used : 0;
+        }
+        size_t taken = n < space ? n : space;
+        _rx.append(segment.data, segment.pos, taken);
+        bytes_sent    += taken;
+        bytes_dropped += n - taken;
+        segment.pos = sent;
+
+        if (segment.pos < segment.data.size()) {
+            break;
+        }
+        _out.pop_front();
+    }
+
+    // discard data already read
+    if (_rx_pos > 4096 && _rx_pos > _rx.size() / 2) {
+        _rx.erase(0, _rx_pos);
+        _rx_pos = 0;
+    }
+}
+
+void A76XXSimulator::inject(const std::string& data, uint32_t delay_us) {
+    schedule(data, now() + static_cast<uint64_t>(delay_us) * 1000);
+}
+
+void A76XXSimulator::injectMQTTMessage(uint8_t client_index,
+                                       const std::string& topic,
+                                       const std::string& payload,
+                                       uint32_t delay_us) {
+    deliverMQTT(client_index, topic, payload, now() + static_cast<uint64_t>(delay_us) * 1000);
+}
+
+void A76XXSimulator::dropMQTTConnection(uint8_t client_index, uint32_t outage_ms) {
+    if (client_index < 2 && _mqtt_connected[client_index]) {
+        _mqtt_connected[client_index]  = false;
+        _mqtt_outage_end[client_index] = now() + static_cast<uint64_t>(outage_ms) * 1000000;
+        _mqtt_subscribed[client_index].clear();
+        char line[32];
+        snprintf(line, sizeof(line), "\r\n+CMQTTCONNLOST: %u,3\r\n", client_index);
+        inject(line);
+    }
+}
+
+void A76XXSimulator::deliverMQTT(uint8_t client_index,
+                                 const std::string& topic,
+                                 const std::string& payload,
+                                 uint64_t time_ns) {
+    char line[64];
+    std::string data;
+
+    snprintf(line, sizeof(line), "\r\n+CMQTTRXSTART: %u,%zu,%zu\r\n", client_index, topic.size(), payload.size());
+    data += line;
+    snprintf(line, sizeof(line), "+CMQTTRXTOPIC: %u,%zu\r\n", client_index, topic.size());
+    data += line;
+    data += topic;
+    data += "\r\n";
+
+    size_t chunk = config.mqtt_rx_chunk_size > 0 ? config.mqtt_rx_chunk_size : payload.size();
+    size_t pos = 0;
+    do {
+        size_t n = payload.size() - pos < chunk ? payload.size() - pos : chunk;
+        snprintf(line, sizeof(line), "+CMQTTRXPAYLOAD: %u,%zu\r\n", client_index, n);
+        data += line;
+        data.append(payload, pos, n);
+        data += "\r\n";
+        pos += n;
+    } while (pos < payload.size());
+
+    snprintf(line, sizeof(line), "+CMQTTRXEND: %u\r\n", client_index);
+    data += line;
+
+    schedule(data, time_ns);
+    mqtt_messages_injected++;
+}
+
+void A76XXSimulator::setNMEARate(uint32_t rate_Hz) {
+    _nmea_rate = rate_Hz;
+    if (rate_Hz > 0) {
+        _nmea_next_ns = now() + 1000000000ULL / rate_Hz;
+    }
+}
+
+void A76XXSimulator::sendNMEA(uint64_t time_ns) {
+    // the UTC time field is the sequence number of the sentence
+    char body[96];
+    snprintf(body, sizeof(body), "GNGGA,%06u.00,5130.12345,N,00010.12345,W,1,10,0.9,50.0,M,47.0,M,,",
+             static_cast<unsigned int>(_nmea_count++ % 1000000));
+    std::string data = formatNMEA(body);
+    snprintf(body, sizeof(body), "GNRMC,%06u.00,A,5130.12345,N,00010.12345,W,0.0,0.0,010124,,,A",
+             static_cast<unsigned int>(_nmea_count++ % 1000000));
+    data += formatNMEA(body);
+    send(data, time_ns);
+    nmea_sentences_sent += 2;
+}
+
+void A76XXSimulator::addHTTPResource(const std::string& path,
+                                     const std::string& body,
+                                     uint16_t status_code,
+                                     const std::string& header) {
+    SimulatorResource_t& resource = _resources[path];
+    resource.status_code = status_code;
+    resource.header      = header;
+    resource.body        = body;
+}
+
+void A76XXSimulator::processByte(char c, uint64_t time_ns) {
+    // a line feed after the carriage return that terminates a command line is
+    // not part of the raw data that might follow
+    bool after_cr = _after_cr;
+    _after_cr = c == '\r';
+    if (c == '\n' && after_cr) {
+        return;
+    }
+
+    if (_raw_target != RAW_NONE) {
+        _raw += c;
+        if (_raw.size() == _raw_expected) {
+            processRaw(time_ns);
+        }
+        return;
+    }
+
+    if (c == '\r') {
+        std::string line;
+        line.swap(_line);
+        processLine(line, time_ns);
+    } else {
+        _line += c;
+    }
+}
+
+void A76XXSimulator::processLine(const std::string& line, uint64_t time_ns) {
+    if (config.echo) {
+        schedule(line + "\r", time_ns);
+    }
+
+    // anything else than a command line is ignored
+    if (line.size() < 2 || toupper(line[0]) != 'A' || toupper(line[1]) != 'T') {
+        return;
+    }
+    commands_received++;
+
+    uint64_t time_rsp = time_ns + static_cast<uint64_t>(config.command_latency_us) * 1000;
+    std::string response;
+    for (const std::string& cmd : splitCommands(line.substr(2))) {
+        switch (execute(cmd, response, time_rsp)) {
+            case RESULT_OK : {
+                break;
+            }
+            case RESULT_ERROR : {
+                schedule(response + "\r\nERROR\r\n", time_rsp);
+                return;
+            }
+            case RESULT_DONE : {
+                // the rest of the line is ignored
+                schedule(response, time_rsp);
+                return;
+            }
+        }
+    }
+    schedule(response + "\r\nOK\r\n", time_rsp);
+}
+
+A76XXSimulator::Result_t A76XXSimulator::execute(const std::string& cmd,
+                                                 std::string& response,
+                                                 uint64_t time_ns) {
+    // the name includes the type of command, e.g. "+CREG?", "+CREG=" or "+CGMM"
+    size_t end = cmd.find_first_of("=?");
+    std::string name = cmd.substr(0, end == std::string::npos ? cmd.size() : end + 1);
+    std::vector<std::string> args;
+    if (end != std::string::npos && cmd[end] == '=') {
+        // test commands, e.g. "+CREG=?", are all accepted
+        if (end + 1 < cmd.size() && cmd[end + 1] == '?') {
+            return RESULT_OK;
+        }
+        args = splitArgs(cmd.substr(end + 1));
+    }
+
+    for (size_t i = 0; i < name.size(); i++) {
+        name[i] = toupper(name[i]);
+    }
+
+    if (name.compare(0, 6, "+CMQTT") == 0) {
+        return executeMQTT(name, args, response, time_ns);
+    }
+    if (name.compare(0, 5, "+HTTP") == 0) {
+        return executeHTTP(name, args, response, time_ns);
+    }
+    if (name.compare(0, 5, "+CGNS") == 0 || name.compare(0, 4, "+CGP") == 0) {
+        return executeGNSS(name, args, response, time_ns);
+    }
+
+    char line[64];
+
+    if (name == "" || name == "E0" || name == "E1") {
+        config.echo = name == "E1" ? true : name == "E0" ? false : config.echo;
+        return RESULT_OK;
+    }
+    if (name == "+CPIN?") {
+        response += "\r\n+CPIN: READY\r\n";
+        return RESULT_OK;
+    }
+    if (name == "+CREG?" || name == "+CGREG?" || name == "+CEREG?") {
+        snprintf(line, sizeof(line), "\r\n%s: 0,%u\r\n",
+                 name.substr(0, name.size() - 1).c_str(), config.registration_status);
+        response += line;
+        return RESULT_OK;
+    }
+    if (name == "+CNSMOD?") {
+        response += "\r\n+CNSMOD: 0,8\r\n";
+        return RESULT_OK;
+    }
+    if (name == "+CGACT=") {
+        _pdp_active = toInt(args, 0) == 1;
+        return RESULT_OK;
+    }
+    if (name == "+CGACT?") {
+        snprintf(line, sizeof(line), "\r\n+CGACT: 1,%d\r\n", _pdp_active ? 1 : 0);
+        response += line;
+        return RESULT_OK;
+    }
+    if (name == "+CCLK?") {
+        response += std::string("\r\n+CCLK: \"") + config.clock + "\"\r\n";
+        return RESULT_OK;
+    }
+    if (name == "+CNTP") {
+        schedule("\r\n+CNTP: 0\r\n", time_ns + static_cast<uint64_t>(config.network_latency_us) * 1000);
+        return RESULT_OK;
+    }
+    if (name == "+CGMM") {
+        response += "\r\nA7670E-LASE\r\n";
+        return RESULT_OK;
+    }
+    if (name == "+CGMR") {
+        response += "\r\n+CGMR: A011B07A7670M7_F\r\n";
+        return RESULT_OK;
+    }
+    if (name == "+CCERTDOWN=") {
+        _raw_name = args.size() > 0 ? args[0] : "";
+        return prompt("\r\n>", RAW_CERT, toInt(args, 1, 0), response);
+    }
+    if (name == "+CCERTLIST") {
+        for (const std::string& cert : _certs) {
+            response += "\r\n+CCERTLIST: \"" + cert + "\"";
+        }
+        response += "\r\n";
+        return RESULT_OK;
+    }
+    if (name == "+CCERTDELE=") {
+        return args.size() > 0 && _certs.erase(args[0]) > 0 ? RESULT_OK : RESULT_ERROR;
+    }
+
+    // setters that are only acknowledged
+    static const char* const accepted[] = {
+        "+CMEE=", "+CTZR=", "+CTZU=", "+CFUN=", "+CSCLK=", "+CPIN=", "+CGDCONT=",
+        "+CGAUTH=", "+CNTP=", "+CSSLCFG=", "+CCHSSLCFG=", "+IPR=", "+CPOF", "+CRESET",
+        "+CREG=", "+CGREG=", "+CEREG=", "+CGEREP="
+    };
+    for (const char* accepted_name : accepted) {
+        if (name == accepted_name) {
+            return RESULT_OK;
+        }
+    }
+
+    return RESULT_ERROR;
+}
+
+A76XXSimulator::Result_t A76XXSimulator::prompt(const char* prompt,
+                                                RawTarget_t target,
+                                                size_t length,
+                                                std::string& response) {
+    if (length == 0) {
+        return RESULT_ERROR;
+    }
+    _raw_target   = target;
+    _raw_expected = length;
+    _raw.clear();
+    response += prompt;
+    return RESULT_DONE;
+}
+
+void A76XXSimulator::processRaw(uint64_t time_ns) {
+    uint64_t time_rsp = time_ns + static_cast<uint64_t>(config.command_latency_us) * 1000;
+    uint64_t time_net = time_ns + static_cast<uint64_t>(config.network_latency_us) * 1000;
+    uint8_t c = _raw_client;
+    char line[32];
+
+    switch (_raw_target) {
+        case RAW_CERT : {
+            _certs.insert(_raw_name);
+            break;
+        }
+        case RAW_MQTT_TOPIC : {
+            _mqtt_topic[c] = _raw;
+            break;
+        }
+        case RAW_MQTT_PAYLOAD : {
+            _mqtt_payload[c] = _raw;
+            break;
+        }
+        case RAW_MQTT_SUBTOPIC :
+        case RAW_MQTT_UNSUBTOPIC : {
+            _mqtt_pending_topics[c].push_back(_raw);
+            break;
+        }
+        case RAW_MQTT_SUB : {
+            _mqtt_subscribed[c].insert(_raw);
+            snprintf(line, sizeof(line), "\r\n+CMQTTSUB: %u,0\r\n", c);
+            schedule(line, time_net);
+            break;
+        }
+        case RAW_MQTT_UNSUB : {
+            _mqtt_subscribed[c].erase(_raw);
+            snprintf(line, sizeof(line), "\r\n+CMQTTUNSUB: %u,0\r\n", c);
+            schedule(line, time_net);
+            break;
+        }
+        case RAW_HTTP_DATA : {
+            _http_data = _raw;
+            break;
+        }
+        default : {
+            // will topic and message are not used
+            break;
+        }
+    }
+
+    _raw_target = RAW_NONE;
+    _raw.clear();
+    schedule("\r\nOK\r\n", time_rsp);
+}
+
+A76XXSimulator::Result_t A76XXSimulator::executeMQTT(const std::string& name,
+                                                     const std::vector<std::string>& args,
+                                                     std::string& response,
+                                                     uint64_t time_ns) {
+    uint64_t time_net = time_ns + static_cast<uint64_t>(config.network_latency_us) * 1000;
+    char line[48];
+
+    if (name == "+CMQTTSTART") {
+        if (_mqtt_started) {
+            return RESULT_ERROR;
+        }
+        _mqtt_started = true;
+        response += "\r\nOK\r\n\r\n+CMQTTSTART: 0\r\n";
+        return RESULT_DONE;
+    }
+    if (name == "+CMQTTSTOP") {
+        if (!_mqtt_started) {
+            return RESULT_ERROR;
+        }
+        _mqtt_started = false;
+        for (uint8_t i = 0; i < 2; i++) {
+            _mqtt_acquired[i]  = false;
+            _mqtt_connected[i] = false;
+            _mqtt_subscribed[i].clear();
+        }
+        response += "\r\nOK\r\n\r\n+CMQTTSTOP: 0\r\n";
+        return RESULT_DONE;
+    }
+    if (!_mqtt_started) {
+        return RESULT_ERROR;
+    }
+
+    if (name == "+CMQTTDISC?") {
+        for (uint8_t i = 0; i < 2; i++) {
+            snprintf(line, sizeof(line), "\r\n+CMQTTDISC: %u,%d", i, _mqtt_connected[i] ? 0 : 1);
+            response += line;
+        }
+        response += "\r\n";
+        return RESULT_OK;
+    }
+
+    // all other commands start with the client index
+    int c = toInt(args, 0);
+    if (c < 0 || c > 1) {
+        return RESULT_ERROR;
+    }
+    _raw_client = c;
+
+    if (name == "+CMQTTACCQ=") {
+        // the client is used
+        if (_mqtt_acquired[c]) {
+            snprintf(line, sizeof(line), "\r\n+CMQTTACCQ: %d,19", c);
+            response += line;
+            return RESULT_ERROR;
+        }
+        _mqtt_acquired[c] = true;
+        return RESULT_OK;
+    }
+    if (name == "+CMQTTREL=") {
+        _mqtt_acquired[c]  = false;
+        _mqtt_connected[c] = false;
+        _mqtt_subscribed[c].clear();
+        return RESULT_OK;
+    }
+    if (name == "+CMQTTSSLCFG=") {
+        return RESULT_OK;
+    }
+    if (name == "+CMQTTWILLTOPIC=") {
+        return prompt("\r\n>", RAW_MQTT_WILL_TOPIC, toInt(args, 1, 0), response);
+    }
+    if (name == "+CMQTTWILLMSG=") {
+        return prompt("\r\n>", RAW_MQTT_WILL_MSG, toInt(args, 1, 0), response);
+    }
+    if (name == "+CMQTTCONNECT=") {
+        _mqtt_connected[c] = time_ns >= _mqtt_outage_end[c];
+        snprintf(line, sizeof(line), "\r\n+CMQTTCONNECT: %d,%d\r\n", c, _mqtt_connected[c] ? 0 : 3);
+        schedule(line, time_net);
+        return RESULT_OK;
+    }
+    if (name == "+CMQTTDISC=") {
+        _mqtt_connected[c] = false;
+        snprintf(line, sizeof(line), "\r\n+CMQTTDISC: %d,0\r\n", c);
+        schedule(line, time_net);
+        return RESULT_OK;
+    }
+    if (name == "+CMQTTTOPIC=") {
+        return prompt("\r\n>", RAW_MQTT_TOPIC, toInt(args, 1, 0), response);
+    }
+    if (name == "+CMQTTPAYLOAD=") {
+        return prompt("\r\n>", RAW_MQTT_PAYLOAD, toInt(args, 1, 0), response);
+    }
+    if (name == "+CMQTTPUB=") {
+        if (!_mqtt_connected[c] || _mqtt_topic[c].empty()) {
+            return RESULT_ERROR;
+        }
+        SimulatorMessage_t msg;
+        msg.topic    = _mqtt_topic[c];
+        msg.payload  = _mqtt_payload[c];
+        msg.qos      = toInt(args, 1, 0);
+        msg.retained = toInt(args, 3, 0) == 1;
+        _published.push_back(msg);
+        mqtt_messages_published++;
+        _mqtt_topic[c].clear();
+        _mqtt_payload[c].clear();
+
+        snprintf(line, sizeof(line), "\r\n+CMQTTPUB: %d,0\r\n", c);
+        schedule(line, time_net);
+
+        // the message comes back from the broker after a round trip
+        if (config.mqtt_loopback) {
+            for (const std::string& filter : _mqtt_subscribed[c]) {
+                if (topicMatches(filter, msg.topic)) {
+                    deliverMQTT(c, msg.topic, msg.payload, time_net + (time_net - time_ns));
+                    break;
+                }
+            }
+        }
+        return RESULT_OK;
+    }
+    if (name == "+CMQTTSUBTOPIC=") {
+        return prompt("\r\n>", RAW_MQTT_SUBTOPIC, toInt(args, 1, 0), response);
+    }
+    if (name == "+CMQTTUNSUBTOPIC=") {
+        return prompt("\r\n>", RAW_MQTT_UNSUBTOPIC, toInt(args, 1, 0), response);
+    }
+    if (name == "+CMQTTSUB=" || name == "+CMQTTUNSUB=") {
+        bool sub = name == "+CMQTTSUB=";
+        // with a length the topic follows, otherwise the topics set before are used
+        if (args.size() > 1) {
+            return prompt("\r\n>", sub ? RAW_MQTT_SUB : RAW_MQTT_UNSUB, toInt(args, 1, 0), response);
+        }
+        if (_mqtt_pending_topics[c].empty()) {
+            return RESULT_ERROR;
+        }
+        for (const std::string& topic : _mqtt_pending_topics[c]) {
+            if (sub) {
+                _mqtt_subscribed[c].insert(topic);
+            } else {
+                _mqtt_subscribed[c].erase(topic);
+            }
+        }
+        _mqtt_pending_topics[c].clear();
+        snprintf(line, sizeof(line), "\r\n+CMQTT%s: %d,0\r\n", sub ? "SUB" : "UNSUB", c);
+        schedule(line, time_net);
+        return RESULT_OK;
+    }
+
+    return RESULT_ERROR;
+}
+
+A76XXSimulator::Result_t A76XXSimulator::executeHTTP(const std::string& name,
+                                                     const std::vector<std::string>& args,
+                                                     std::string& response,
+                                                     uint64_t time_ns) {
+    uint64_t time_net = time_ns + static_cast<uint64_t>(config.network_latency_us) * 1000;
+    char line[48];
+
+    if (name == "+HTTPINIT") {
+        if (_http_started) {
+            return RESULT_ERROR;
+        }
+        _http_started  = true;
+        _http_response = NULL;
+        return RESULT_OK;
+    }
+    if (!_http_started) {
+        return RESULT_ERROR;
+    }
+
+    if (name == "+HTTPTERM") {
+        _http_started = false;
+        return RESULT_OK;
+    }
+    if (name == "+HTTPPARA=") {
+        if (args.size() > 1 && args[0] == "URL") {
+            _http_url = args[1];
+        }
+        return RESULT_OK;
+    }
+    if (name == "+HTTPDATA=") {
+        return prompt("\r\nDOWNLOAD\r\n", RAW_HTTP_DATA, toInt(args, 0, 0), response);
+    }
+    if (name == "+HTTPACTION=") {
+        int method = toInt(args, 0);
+        if (method < 0 || method > 4) {
+            return RESULT_ERROR;
+        }
+        std::map<std::string, SimulatorResource_t>::const_iterator it = _resources.find(urlPath(_http_url));
+        _http_response = it != _resources.end() ? &it->second : &_not_found;
+        http_requests++;
+
+        // the transfer time of the body is not included
+        snprintf(line, sizeof(line), "\r\n+HTTPACTION: %d,%u,%zu\r\n", method,
+                 _http_response->status_code, _http_response->body.size());
+        schedule(line, time_net);
+        return RESULT_OK;
+    }
+    if (_http_response == NULL) {
+        return RESULT_ERROR;
+    }
+    if (name == "+HTTPHEAD") {
+        snprintf(line, sizeof(line), "\r\n+HTTPHEAD: %zu\r\n", _http_response->header.size());
+        response += line + _http_response->header + "\r\n";
+        return RESULT_OK;
+    }
+    if (name == "+HTTPREAD?") {
+        snprintf(line, sizeof(line), "\r\n+HTTPREAD: LEN,%zu\r\n", _http_response->body.size());
+        response += line;
+        return RESULT_OK;
+    }
+    if (name == "+HTTPREAD=") {
+        const std::string& body = _http_response->body;
+        size_t offset = toInt(args, 0, 0);
+        size_t length = toInt(args, 1, 0);
+        if (offset > body.size()) {
+            return RESULT_ERROR;
+        }
+        length = length < body.size() - offset ? length : body.size() - offset;
+        snprintf(line, sizeof(line), "\r\nOK\r\n\r\n+HTTPREAD: %zu\r\n", length);
+        response += line;
+        response.append(body, offset, length);
+        response += "\r\n+HTTPREAD: 0\r\n";
+        return RESULT_DONE;
+    }
+
+    return RESULT_ERROR;
+}
+
+A76XXSimulator::Result_t A76XXSimulator::executeGNSS(const std::string& name,
+                                                     const std::vector<std::string>& args,
+                                                     std::string& response,
+                                                     uint64_t time_ns) {
+    if (name == "+CGNSSPWR=") {
+        _gnss_power = toInt(args, 0) == 1;
+        if (_gnss_power) {
+            schedule("\r\n+CGNSSPWR: READY!\r\n",
+                     time_ns + static_cast<uint64_t>(config.network_latency_us) * 1000);
+        }
+        return RESULT_OK;
+    }
+    if (!_gnss_power) {
+        return RESULT_ERROR;
+    }
+
+    if (name == "+CGNSSTST=") {
+        _nmea_output = toInt(args, 0) == 1;
+        if (_nmea_output && _nmea_rate > 0) {
+            _nmea_next_ns = time_ns + 1000000000ULL / _nmea_rate;
+        }
+        return RESULT_OK;
+    }
+    if (name == "+CGNSSINFO") {
+        response += "\r\n+CGNSSINFO: 3,10,05,04,5130.12345,N,00010.12345,W,010124,120000.00,50.0,0.0,0.0,1.1,0.9,0.7\r\n";
+        return RESULT_OK;
+    }
+    if (name == "+CGPSINFO") {
+        response += "\r\n+CGPSINFO: 5130.123456,N,00010.123456,W,010124,120000.0,50.0,0.0,0.0\r\n";
+        return RESULT_OK;
+    }
+
+    // configuration commands, e.g. CGNSSMODE, CGNSSNMEA or CGPSCOLD, are only acknowledged
+    return RESULT_OK;
+}
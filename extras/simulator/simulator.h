@@ -0,0 +1,330 @@
+#ifndef A76XX_SIMULATOR_H_
+#define A76XX_SIMULATOR_H_
+
+/*
+    Host-side stand-in for a SIMCOM A76XX module, for end-to-end tests and
+    benchmarks of the library on Linux.
+
+    The simulator is a Stream: the library writes AT commands to it and reads
+    the responses, exactly as with the UART connected to a real module. It
+    implements the commands used by the library (V.25TER, CPIN, CREG/CGREG/CEREG,
+    CGACT, CCLK, CNTP, CSSLCFG, CCERT*, CMQTT*, HTTP*, CGNSS*), including chained
+    command lines, raw data after '>' and DOWNLOAD prompts, and URCs for the
+    results of network operations. Timing is in real time, based on micros():
+
+    - every response is delayed by SimulatorConfig_t::command_latency_us;
+    - the results of network operations, e.g. +CMQTTPUB or +HTTPACTION, are
+      delayed by SimulatorConfig_t::network_latency_us;
+    - data in both directions is limited by SimulatorConfig_t::baud_rate,
+      assuming 10 bits per byte, as on a 8N1 UART;
+    - data sent by the module is stored in a receive FIFO of the host of size
+      SimulatorConfig_t::rx_buffer_size until read, like the buffer of the
+      HardwareSerial driver on a microcontroller. Data arriving when the FIFO
+      is full is lost, and counted in A76XXSimulator::bytes_dropped.
+
+    URCs can be injected at any time, e.g. MQTT messages with ::injectMQTTMessage,
+    and NMEA sentences are produced at a given rate once GNSS is powered on and
+    NMEA output is enabled with AT+CGNSSTST=1.
+
+    The simulator is not thread-safe. To use it from a different process, attach
+    it to a pseudo terminal with SimulatorPty.
+*/
+
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+/*
+    @brief Timing and behaviour of the simulator.
+*/
+struct SimulatorConfig_t {
+    // UART speed in bits per second, 0 for unlimited
+    uint32_t baud_rate            = 115200;
+
+    // time from the reception of a command line to its response
+    uint32_t command_latency_us   = 2000;
+
+    // time to complete network operations, e.g. an MQTT publish or an HTTP request
+    uint32_t network_latency_us   = 50000;
+
+    // size of the receive FIFO of the host, 0 for unlimited
+    uint32_t rx_buffer_size       = 0;
+
+    // echo command lines back, as the module does until ATE0 is received
+    bool     echo                 = true;
+
+    // maximum length of the chunks of topic and payload of received MQTT messages
+    uint32_t mqtt_rx_chunk_size   = 1024;
+
+    // deliver published messages back to the device if it is subscribed to the topic
+    bool     mqtt_loopback        = false;
+
+    // registration status reported by CREG/CGREG/CEREG, 1 is registered, home network
+    uint8_t  registration_status  = 1;
+
+    // date and time reported by CCLK
+    const char* clock             = "24/01/01,12:00:00+00";
+};
+
+/*
+    @brief A message published by the device.
+*/
+struct SimulatorMessage_t {
+    std::string topic;
+    std::string payload;
+    uint8_t     qos;
+    bool        retained;
+};
+
+/*
+    @brief An HTTP resource served by the simulator.
+*/
+struct SimulatorResource_t {
+    uint16_t    status_code;
+    std::string header;
+    std::string body;
+};
+
+class A76XXSimulator : public Stream {
+  public:
+    SimulatorConfig_t config;
+
+    /*
+        Counters, reset with ::resetCounters.
+    */
+    uint32_t commands_received;
+    uint32_t bytes_received;
+    uint32_t bytes_sent;
+    uint32_t bytes_dropped;
+    uint32_t mqtt_messages_published;
+    uint32_t mqtt_messages_injected;
+    uint32_t nmea_sentences_sent;
+    uint32_t http_requests;
+
+    A76XXSimulator();
+
+    A76XXSimulator(const SimulatorConfig_t& cfg);
+
+    // Stream interface
+    int available();
+    int read();
+    int peek();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    void flush();
+    using Print::write;
+
+    /*
+        @brief Process pending events, i.e. scheduled URCs and NMEA sentences.
+
+        @details This is called by all Stream functions, so it is only needed
+            when the simulator is not polled, e.g. to let time pass.
+    */
+    void update();
+
+    /*
+        @brief Queue a string to be sent to the device, e.g. a URC.
+
+        @param [IN] data The data, including line terminations if needed.
+        @param [IN] delay_us Send the data after this delay from now.
+    */
+    void inject(const std::string& data, uint32_t delay_us = 0);
+
+    /*
+        @brief Queue the URCs of an MQTT message received from the broker, i.e.
+            "+CMQTTRXSTART: ...", "+CMQTTRXTOPIC: ...", one or more
+            "+CMQTTRXPAYLOAD: ..." chunks and "+CMQTTRXEND: ...".
+
+        @param [IN] client_index The client the message is delivered to.
+        @param [IN] topic The message topic.
+        @param [IN] payload The message payload.
+        @param [IN] delay_us Send the message after this delay from now.
+    */
+    void injectMQTTMessage(uint8_t client_index,
+                           const std::string& topic,
+                           const std::string& payload,
+                           uint32_t delay_us = 0);
+
+    /*
+        @brief Drop the connection of an MQTT client to the broker, as when the
+            network is lost, with the URC "+CMQTTCONNLOST: <client_index>,3".
+            Messages cannot be published until the client connects again, and
+            the subscriptions are lost, as with a clean session.
+
+        @param [IN] outage_ms The time during which connecting fails, with
+            "+CMQTTCONNECT: <client_index>,3", as when the network is down.
+    */
+    void dropMQTTConnection(uint8_t client_index, uint32_t outage_ms = 0);
+
+    /*
+        @brief Produce NMEA sentences, a GGA and a RMC sentence per epoch, at the
+            given rate, while GNSS is powered and NMEA output is enabled.
+
+        @details The UTC time field of the sentences is a counter of the sentences
+            sent, so that drops can be detected by the receiver.
+        @param [IN] rate_Hz The number of epochs per second, 0 to stop.
+    */
+    void setNMEARate(uint32_t rate_Hz);
+
+    /*
+        @brief Serve an HTTP resource.
+
+        @param [IN] path The path of the resource in the URL, including the leading
+            "/", e.g. "/data.json". Scheme, server and port are ignored.
+    */
+    void addHTTPResource(const std::string& path,
+                         const std::string& body,
+                         uint16_t status_code = 200,
+                         const std::string& header = "HTTP/1.1 200 OK\r\nContent-Type: text/plain");
+
+    /*
+        @brief The messages published by the device, in order.
+    */
+    std::vector<SimulatorMessage_t>& published() { return _published; }
+
+    /*
+        @brief The body of the last HTTP request sent by the device with HTTPDATA.
+    */
+    const std::string& lastHTTPData() const { return _http_data; }
+
+    /*
+        @brief Whether there is no data left to be sent to the device, now or later.
+    */
+    bool idle();
+
+    void resetCounters();
+
+  private:
+    // data sent to the device: the bytes of a segment leave the module one every
+    // byte time from the start of the segment, segments are sent one after the other
+    struct Segment_t {
+        uint64_t    start_ns;
+        std::string data;
+        size_t      pos;
+    };
+
+    // data to be sent at a later time, e.g. responses and URCs
+    struct ScheduledOutput_t {
+        uint64_t    time_ns;
+        uint64_t    seq;
+        std::string data;
+        bool operator > (const ScheduledOutput_t& other) const {
+            return time_ns != other.time_ns ? time_ns > other.time_ns : seq > other.seq;
+        }
+    };
+
+    // raw data expected after a prompt, and what to do with it
+    enum RawTarget_t {
+        RAW_NONE,
+        RAW_CERT,
+        RAW_MQTT_WILL_TOPIC,
+        RAW_MQTT_WILL_MSG,
+        RAW_MQTT_TOPIC,
+        RAW_MQTT_PAYLOAD,
+        RAW_MQTT_SUBTOPIC,
+        RAW_MQTT_SUB,
+        RAW_MQTT_UNSUBTOPIC,
+        RAW_MQTT_UNSUB,
+        RAW_HTTP_DATA
+    };
+
+    // outcome of a command in a command line
+    enum Result_t {
+        RESULT_OK,
+        RESULT_ERROR,
+        // the command has produced its complete response
+        RESULT_DONE
+    };
+
+    std::priority_queue<ScheduledOutput_t,
+        std::vector<ScheduledOutput_t>,
+        std::greater<ScheduledOutput_t> >          _scheduled;
+    uint64_t                                        _sequence;
+    std::deque<Segment_t>                               _out;
+
+    // time at which the last byte queued to the device leaves the module
+    uint64_t                                     _out_free_ns;
+
+    // receive FIFO of the host
+    std::string                                           _rx;
+    size_t                                            _rx_pos;
+
+    // time at which the last byte written by the device reaches the module
+    uint64_t                                      _in_free_ns;
+
+    std::string                                         _line;
+    RawTarget_t                                   _raw_target;
+    size_t                                      _raw_expected;
+    std::string                                          _raw;
+    std::string                                     _raw_name;
+    uint8_t                                       _raw_client;
+    bool                                            _after_cr;
+
+    // state of the module
+    bool                                        _mqtt_started;
+    std::string                               _mqtt_topic[2];
+    std::string                             _mqtt_payload[2];
+    bool                                    _mqtt_acquired[2];
+    bool                                   _mqtt_connected[2];
+    uint64_t                              _mqtt_outage_end[2];
+    std::vector<std::string>           _mqtt_pending_topics[2];
+    std::set<std::string>                 _mqtt_subscribed[2];
+    std::vector<SimulatorMessage_t>                _published;
+
+    std::map<std::string, SimulatorResource_t>     _resources;
+    bool                                        _http_started;
+    std::string                                     _http_url;
+    std::string                                    _http_data;
+    const SimulatorResource_t*                 _http_response;
+    SimulatorResource_t                            _not_found;
+
+    std::set<std::string>                              _certs;
+    bool                                          _pdp_active;
+    bool                                          _gnss_power;
+    bool                                         _nmea_output;
+    uint32_t                                       _nmea_rate;
+    uint64_t                                   _nmea_next_ns;
+    uint32_t                                      _nmea_count;
+
+    uint64_t now() const;
+    uint64_t byteTime() const;
+
+    // queue data to be sent to the device at the given time
+    void schedule(const std::string& data, uint64_t time_ns);
+
+    // start sending data to the device, at the given time or when the UART is free
+    void send(const std::string& data, uint64_t time_ns);
+
+    // move the bytes that have left the module to the receive FIFO of the host
+    void receive(uint64_t time_ns);
+
+    void processByte(char c, uint64_t time_ns);
+    void processLine(const std::string& line, uint64_t time_ns);
+    void processRaw(uint64_t time_ns);
+
+    // execute a single command of a command line, appending its information
+    // text to `response`, or the complete response if RESULT_DONE is returned
+    Result_t execute(const std::string& cmd, std::string& response, uint64_t time_ns);
+    Result_t executeMQTT(const std::string& name, const std::vector<std::string>& args,
+                         std::string& response, uint64_t time_ns);
+    Result_t executeHTTP(const std::string& name, const std::vector<std::string>& args,
+                         std::string& response, uint64_t time_ns);
+    Result_t executeGNSS(const std::string& name, const std::vector<std::string>& args,
+                         std::string& response, uint64_t time_ns);
+
+    // wait for `length` bytes of raw data after a prompt
+    Result_t prompt(const char* prompt, RawTarget_t target, size_t length, std::string& response);
+
+    void sendNMEA(uint64_t time_ns);
+    void deliverMQTT(uint8_t client_index, const std::string& topic,
+                     const std::string& payload, uint64_t time_ns);
+};
+
+#endif A76XX_SIMULATOR_H_
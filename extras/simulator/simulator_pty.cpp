@@ -0,0 +1,87 @@
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "simulator_pty.h"
+
+SimulatorPty::SimulatorPty(A76XXSimulator& sim)
+    : _sim(sim)
+    , _master_fd(-1)
+    , _slave_fd(-1)
+    , _running(false) {}
+
+SimulatorPty::~SimulatorPty() {
+    end();
+}
+
+bool SimulatorPty::begin() {
+    _master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (_master_fd < 0 || grantpt(_master_fd) != 0 || unlockpt(_master_fd) != 0) {
+        end();
+        return false;
+    }
+    _path = ptsname(_master_fd);
+
+    // keep the slave open, so that the master does not see a hang up when the
+    // other process closes it, and put it in raw mode, as a serial port
+    _slave_fd = open(_path.c_str(), O_RDWR | O_NOCTTY);
+    if (_slave_fd < 0) {
+        end();
+        return false;
+    }
+    struct termios tio;
+    tcgetattr(_slave_fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(_slave_fd, TCSANOW, &tio);
+
+    _running = true;
+    _thread  = std::thread(&SimulatorPty::run, this);
+    return true;
+}
+
+void SimulatorPty::end() {
+    _running = false;
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    if (_slave_fd >= 0) {
+        close(_slave_fd);
+        _slave_fd = -1;
+    }
+    if (_master_fd >= 0) {
+        close(_master_fd);
+        _master_fd = -1;
+    }
+}
+
+void SimulatorPty::run() {
+    uint8_t buffer[512];
+    struct pollfd pfd = {_master_fd, POLLIN, 0};
+
+    while (_running) {
+        // wake up at least every millisecond to send scheduled data
+        if (poll(&pfd, 1, 1) > 0 && (pfd.revents & POLLIN)) {
+            ssize_t n = ::read(_master_fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _sim.write(buffer, n);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t n = 0;
+        while (n < sizeof(buffer) && _sim.available() > 0) {
+            buffer[n++] = static_cast<uint8_t>(_sim.read());
+        }
+        size_t written = 0;
+        while (written < n) {
+            ssize_t ret = ::write(_master_fd, buffer + written, n - written);
+            if (ret <= 0) {
+                break;
+            }
+            written += ret;
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef A76XX_SIMULATOR_PTY_H_
+#define A76XX_SIMULATOR_PTY_H_
+
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "simulator.h"
+
+/*
+    @brief Attach an A76XXSimulator to a Linux pseudo terminal, so that it can
+        be used by another process, e.g. the library built with HostSerial, or
+        a terminal program such as minicom.
+
+    @details The simulator is driven by a background thread, that forwards data
+        between the master side of the pseudo terminal and the simulator. The
+        slave side, whose path is returned by ::path, behaves like the serial
+        port of the module. Since the simulator is not thread-safe, access it,
+        e.g. to inject URCs, only while holding the lock returned by ::mutex.
+*/
+class SimulatorPty {
+  private:
+    A76XXSimulator&                                 _sim;
+    int                                       _master_fd;
+    int                                        _slave_fd;
+    std::string                                    _path;
+    std::thread                                  _thread;
+    std::mutex                                    _mutex;
+    volatile bool                               _running;
+
+    void run();
+
+  public:
+    SimulatorPty(A76XXSimulator& sim);
+
+    ~SimulatorPty();
+
+    /*
+        @brief Open the pseudo terminal and start forwarding data.
+
+        @return False if the pseudo terminal could not be opened.
+    */
+    bool begin();
+
+    /*
+        @brief Stop forwarding data and close the pseudo terminal.
+    */
+    void end();
+
+    /*
+        @brief The path of the slave side of the pseudo terminal, e.g. "/dev/pts/3".
+    */
+    const char* path() const { return _path.c_str(); }
+
+    std::mutex& mutex() { return _mutex; }
+};
+
+#endif A76XX_SIMULATOR_PTY_H_
@@ -5,30 +5,161 @@
 #include "time.h"
 
 #ifndef A76XX_URC_QUEUE_SIZE
-    /* Controls the size of the queue where URCs are stored */
+    /* Controls the size of the queue where URC events are stored, see A76XX::enableURCEvents */
     #define A76XX_URC_QUEUE_SIZE 10
 #endif
 
 #ifndef A76XX_MAX_EVENT_HANDLERS
-    /* Controls the maximum number of event handlers that are stored in A76XX::ModemSerial  */
-    #define A76XX_MAX_EVENT_HANDLERS 10
+    /* 
+        Controls the maximum number of event handlers that are stored in A76XX::ModemSerial.
+        A76XX::enableURCEvents uses up to 7, the MQTT client 1 and the GNSS client 6.
+    */
+    #define A76XX_MAX_EVENT_HANDLERS 16
+#endif
+
+#ifndef A76XX_EVENT_HANDLER_TIMEOUT
+    /* 
+        Controls the default time in ms within which the rest of a URC must be received
+        after its match string, before the partial URC is discarded, see EventHandler_t
+    */
+    #define A76XX_EVENT_HANDLER_TIMEOUT 1000
+#endif
+
+#ifndef A76XX_RX_BUFFER_SIZE
+    /* Controls the size of the staging buffer for data received from the module */
+    #define A76XX_RX_BUFFER_SIZE 256
+#endif
+
+#ifndef A76XX_TX_BUFFER_SIZE
+    /* Controls the size of the buffer where commands are formatted before being sent */
+    #define A76XX_TX_BUFFER_SIZE 128
+#endif
+
+#ifndef A76XX_BATCH_MAX_COMMANDS
+    /* Controls the maximum number of commands in a CommandBatch_t */
+    #define A76XX_BATCH_MAX_COMMANDS 8
+#endif
+
+#ifndef A76XX_BATCH_BUFFER_SIZE
+    /* Controls the size of the buffer where the commands of a CommandBatch_t are stored */
+    #define A76XX_BATCH_BUFFER_SIZE 512
+#endif
+
+#ifndef A76XX_MAX_COMMAND_LINE_LENGTH
+    /* Controls the maximum length of a line of commands chained by ModemSerial::sendBatch */
+    #define A76XX_MAX_COMMAND_LINE_LENGTH 256
+#endif
+
+#ifndef A76XX_MATCHER_MAX_STATES
+    /* 
+        Controls the number of states of the automaton used by A76XX::ModemSerial to 
+        match URCs and responses. It must be at least as large as the total number 
+        of characters in the match strings of all event handlers plus those of the
+        responses being waited for. Event handlers that would leave less than
+        A76XX_MATCHER_RESPONSE_STATES states for the responses are not registered.
+    */
+    #define A76XX_MATCHER_MAX_STATES 192
+#endif
+
+#ifndef A76XX_MATCHER_RESPONSE_STATES
+    /* 
+        Controls the number of states of the automaton reserved for the response
+        strings, i.e. OK, ERROR and the match strings of A76XX::ModemSerial::waitResponse
+    */
+    #define A76XX_MATCHER_RESPONSE_STATES 64
+#endif
+
+/* 
+    Define A76XX_ENABLE_STATS to record per-command statistics in ModemSerial,
+    see CommandStats_t. When not defined, the code is compiled out completely.
+    It must be defined for all translation units, i.e. as a build flag, e.g.
+    `build_flags = -DA76XX_ENABLE_STATS` in platformio.ini.
+*/
+#ifdef A76XX_ENABLE_STATS
+    #ifndef A76XX_STATS_MAX_COMMANDS
+        /* Controls the maximum number of command prefixes in the statistics table */
+        #define A76XX_STATS_MAX_COMMANDS 16
+    #endif
+
+    #ifndef A76XX_STATS_PREFIX_LENGTH
+        /* Controls the maximum length of the command prefixes in the statistics table */
+        #define A76XX_STATS_PREFIX_LENGTH 15
+    #endif
 #endif
 
 #ifndef MQTT_PAYLOAD_BUFFER_LEN
-    /* Controls the maximum payload size in bytes of an MQTT message */
+    /* Controls the maximum payload size in bytes of an MQTTMessage_t */
     #define MQTT_PAYLOAD_BUFFER_LEN 64
 #endif
 
 #ifndef MQTT_TOPIC_BUFFER_LEN
-    /* Controls the maximum topic size of an MQTT message */
+    /* Controls the maximum topic size of an MQTTMessage_t and of the topic passed to a MQTTMessageSink_t */
     #define MQTT_TOPIC_BUFFER_LEN 32
 #endif
 
 #ifndef MQTT_MESSAGE_QUEUE_SIZE
-    /* Controls the size of the queue to store MQTT message */
+    /* Controls the default size of the MQTT message arena, in messages of maximum size */
     #define MQTT_MESSAGE_QUEUE_SIZE 10
 #endif
 
+#ifndef MQTT_MESSAGE_ARENA_SIZE
+    /* 
+        Controls the size in bytes of the arena where received MQTT messages are queued.
+        Messages are packed, so a message takes its topic and payload lengths plus 12 bytes.
+    */
+    #define MQTT_MESSAGE_ARENA_SIZE (MQTT_MESSAGE_QUEUE_SIZE * (MQTT_TOPIC_BUFFER_LEN + MQTT_PAYLOAD_BUFFER_LEN))
+#endif
+
+#ifndef MQTT_MAX_SUBSCRIPTIONS
+    /* Controls the maximum number of subscriptions whose filter is stored for routing and reconnections, see A76XXMQTTClient::subscribe */
+    #define MQTT_MAX_SUBSCRIPTIONS 16
+#endif
+
+#ifndef MQTT_TOPIC_TRIE_NODES
+    /* Controls the maximum number of distinct topic levels in the filters of the subscriptions */
+    #define MQTT_TOPIC_TRIE_NODES 64
+#endif
+
+#ifndef MQTT_TOPIC_TRIE_POOL_SIZE
+    /* Controls the total length in bytes of the distinct topic levels of the subscriptions */
+    #define MQTT_TOPIC_TRIE_POOL_SIZE 512
+#endif
+
+#ifndef MQTT_FILTER_BUFFER_LEN
+    /* Controls the maximum length of the filters subscribed again after a reconnection, see A76XXMQTTClient::setAutoReconnect */
+    #define MQTT_FILTER_BUFFER_LEN 128
+#endif
+
+#ifndef MQTT_PUBLISH_WINDOW
+    /* Controls the maximum number of messages in flight, see A76XXMQTTClient::publishNonBlocking */
+    #define MQTT_PUBLISH_WINDOW 8
+#endif
+
+#ifndef MQTT_OUTBOX_MAX_MESSAGE_SIZE
+    /* Controls the maximum length of the topic and payload of a message in A76XXMQTTOutbox, plus one */
+    #define MQTT_OUTBOX_MAX_MESSAGE_SIZE 256
+#endif
+
+#ifndef MQTT_OUTBOX_RETRY_INTERVAL
+    /* Controls the time in milliseconds after which A76XXMQTTOutbox tries again to send messages after a failure */
+    #define MQTT_OUTBOX_RETRY_INTERVAL 1000
+#endif
+
+#ifndef MQTT_AGGREGATOR_TOPICS
+    /* Controls the maximum number of topics of A76XXMQTTAggregator */
+    #define MQTT_AGGREGATOR_TOPICS 4
+#endif
+
+#ifndef MQTT_AGGREGATOR_BUFFER_SIZE
+    /* Controls the maximum length of the messages published by A76XXMQTTAggregator */
+    #define MQTT_AGGREGATOR_BUFFER_SIZE 256
+#endif
+
+#ifndef HTTP_READ_CHUNK_SIZE
+    /* Controls the default number of bytes read with each HTTPREAD by A76XXHTTPClient::getResponseBody */
+    #define HTTP_READ_CHUNK_SIZE 4096
+#endif
+
 #ifndef NMEA_MESSAGE_SIZE
     /* Length size of NMEA message */
     #define NMEA_MESSAGE_SIZE 100
@@ -49,12 +180,19 @@ enum Response_t {
     A76XX_RESPONSE_MATCH_2ND = 2,
     A76XX_RESPONSE_MATCH_3RD = 3,
     A76XX_RESPONSE_ERROR     = 4,
-    A76XX_RESPONSE_TIMEOUT   = 5
+    A76XX_RESPONSE_TIMEOUT   = 5,
+    A76XX_RESPONSE_PENDING   = 6
 };
 
 #define RESPONSE_OK "OK\r\n"
 #define RESPONSE_ERROR "ERROR\r\n"
 
+// number of strings, in addition to those of the event handlers, matched by waitResponse
+#define A76XX_NUM_RESPONSE_PATTERNS 5
+
+// number of MQTT clients supported by the module
+#define A76XX_MQTT_MAX_CLIENTS 2
+
 // error codes
 #define A76XX_OPERATION_SUCCEEDED             0
 #define A76XX_OPERATION_TIMEDOUT             -1
@@ -66,6 +204,13 @@ enum Response_t {
 #define A76XX_SIM_PIN_MODEM_ERROR            -7
 #define A76XX_GNSS_NOT_READY                 -8
 #define A76XX_GNSS_GENERIC_ERROR             -9
+#define A76XX_OPERATION_PENDING             -10
+#define A76XX_ASYNC_COMMAND_BUSY            -11
+#define A76XX_COMMAND_NOT_EXECUTED          -12
+#define A76XX_BATCH_OVERFLOW                -13
+#define A76XX_MQTT_WINDOW_FULL              -14
+#define A76XX_MQTT_NO_FREE_CLIENT           -15
+#define A76XX_MQTT_CONNECTION_LOST          -16
 
 // if retcode is an error, return it
 #define A76XX_RETCODE_ASSERT_RETURN(retcode) {        \
@@ -106,9 +251,22 @@ enum Response_t {
     }
 
 #include "utils/base64.h"
+#include "utils/pattern_matcher.h"
+#include "utils/field_tokenizer.h"
+#include "utils/record_queue.h"
+#include "utils/topic_trie.h"
+#include "utils/cbor.h"
+#include "utils/lz77.h"
+#include "utils/outbox_storage.h"
 
 #include "event_handlers.h"
+#include "async_command.h"
+#include "command_batch.h"
+#ifdef A76XX_ENABLE_STATS
+#include "command_stats.h"
+#endif
 #include "modem_serial.h"
+#include "urc_events.h"
 
 #include "commands/internet_service.h"
 #include "commands/serial_interface.h"
@@ -127,6 +285,8 @@ enum Response_t {
 #include "clients/base.h"
 #include "clients/secure.h"
 #include "clients/mqtt.h"
+#include "clients/outbox.h"
+#include "clients/aggregator.h"
 #include "clients/http.h"
 #include "clients/gnss.h"
 
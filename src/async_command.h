@@ -0,0 +1,186 @@
+#ifndef A76XX_ASYNCCOMMAND_H_
+#define A76XX_ASYNCCOMMAND_H_
+
+// forward declarations
+class ModemSerial;
+class AsyncCommand_t;
+
+/*
+    @brief Function called when an asynchronous command completes.
+
+    @param [IN] command The command that has completed. Use AsyncCommand_t::result
+        to get its outcome.
+    @param [IN] context The pointer passed to AsyncCommand_t::setCallback.
+*/
+typedef void (*AsyncCallback_t)(AsyncCommand_t* command, void* context);
+
+/*
+    @brief Base class for asynchronous commands.
+
+    @details Synchronous commands block in ModemSerial::waitResponse until the
+        module responds, which can take up to two minutes, e.g. for HTTP requests.
+        An asynchronous command instead is a state machine that is submitted to
+        ModemSerial::submit and then driven by calls to ModemSerial::poll, which
+        never block for longer than it takes to process the data already received
+        from the module. URCs are dispatched to the event handlers in between.
+
+        Each step of a command sends data to the module, if needed, and declares
+        with ::expect the strings it waits for, with the same semantics as
+        ModemSerial::waitResponse. When one of these is matched, or the step times
+        out, ::process is called with the corresponding Response_t, and the command
+        either moves to the next step or calls ::finish with its return code. The
+        fields following a matched string are collected with ::expectLine, since
+        reading them with ModemSerial::readLine would block.
+
+        Command objects are allocated by the user and double as a future-like
+        handle: check ::isPending and ::result, or register a callback with
+        ::setCallback. An object must not be destroyed or modified while pending,
+        and can be reused after completion. Commands are executed one at a time,
+        in order of submission.
+*/
+class AsyncCommand_t {
+  friend class ModemSerial;
+
+  private:
+    enum State_t {
+        IDLE,
+        QUEUED,
+        RUNNING
+    };
+
+    State_t                                   _state;
+    int8_t                                   _result;
+    AsyncCommand_t*                            _next;
+    AsyncCallback_t                        _callback;
+    void*                                   _context;
+
+    // response strings of the current step, as in ModemSerial::waitResponse
+    const char*   _responses[A76XX_NUM_RESPONSE_PATTERNS];
+    uint32_t                                 _tstart;
+    uint32_t                                _timeout;
+
+    // buffer of the line collected by the current step, if any, see ::expectLine
+    char*                                      _line;
+    size_t                                _line_size;
+    LineReader_t                             _reader;
+
+  protected:
+    /*
+        @brief Start the command, i.e. send the first AT command and call ::expect.
+    */
+    virtual void start(ModemSerial* serial) = 0;
+
+    /*
+        @brief Process the response of the current step and move to the next one,
+            by calling ::expect again, or complete the command with ::finish.
+
+        @param [IN] serial The serial connection, to send the next command.
+        @param [IN] rsp The response string matched, or A76XX_RESPONSE_TIMEOUT.
+    */
+    virtual void process(ModemSerial* serial, Response_t rsp) = 0;
+
+    /*
+        @brief Set the strings the current step waits for. Arguments are as
+            in ModemSerial::waitResponse. The timeout starts now.
+    */
+    void expect(const char* match_1,
+                const char* match_2,
+                const char* match_3,
+                uint32_t timeout,
+                bool match_OK = true,
+                bool match_ERROR = true) {
+        _responses[0] = match_1;
+        _responses[1] = match_2;
+        _responses[2] = match_3;
+        _responses[3] = match_ERROR ? RESPONSE_ERROR : NULL;
+        _responses[4] = match_OK    ? RESPONSE_OK    : NULL;
+        _timeout      = timeout;
+        _tstart       = millis();
+    }
+
+    void expect(const char* match_1,
+                uint32_t timeout,
+                bool match_OK = true,
+                bool match_ERROR = true) {
+        expect(match_1, NULL, NULL, timeout, match_OK, match_ERROR);
+    }
+
+    /*
+        @brief Collect the rest of the current line in `buffer` as it arrives, e.g.
+            the fields following the string just matched. ::process is called with
+            A76XX_RESPONSE_MATCH_1ST when the line is complete, or with 
+            A76XX_RESPONSE_TIMEOUT if it is not complete within `timeout`.
+
+        @detail The line is stored as by ModemSerial::readLine, i.e. without the 
+            line terminator and truncated if it does not fit.
+        @param [OUT] buffer The destination buffer, valid until the step completes.
+        @param [IN] size The size of the buffer, which must be positive.
+    */
+    void expectLine(char* buffer, size_t size, uint32_t timeout = 1000) {
+        expect(NULL, NULL, NULL, timeout, false, false);
+        _line      = buffer;
+        _line_size = size;
+        _line[0]   = '\0';
+        _reader.clear();
+    }
+
+    /*
+        @brief Complete the command.
+
+        @param [IN] retcode The result of the command, e.g. A76XX_OPERATION_SUCCEEDED.
+    */
+    void finish(int8_t retcode) {
+        _result = retcode;
+        _state  = IDLE;
+    }
+
+  public:
+    AsyncCommand_t()
+        : _state(IDLE)
+        , _result(A76XX_OPERATION_SUCCEEDED)
+        , _next(NULL)
+        , _callback(NULL)
+        , _context(NULL)
+        , _tstart(0)
+        , _timeout(0)
+        , _line(NULL)
+        , _line_size(0) {
+        for (uint8_t i = 0; i < A76XX_NUM_RESPONSE_PATTERNS; i++) {
+            _responses[i] = NULL;
+        }
+    }
+
+    virtual ~AsyncCommand_t() {}
+
+    /*
+        @brief Set a function to be called, from ModemSerial::poll, when the
+            command completes.
+
+        @param [IN] callback The function, or NULL to remove it.
+        @param [IN] context A pointer passed to the function, e.g. to an object.
+    */
+    void setCallback(AsyncCallback_t callback, void* context = NULL) {
+        _callback = callback;
+        _context  = context;
+    }
+
+    /*
+        @brief Whether the command has been submitted and has not completed yet.
+    */
+    bool isPending() const {
+        return _state != IDLE;
+    }
+
+    /*
+        @brief The result of the command.
+
+        @return A76XX_OPERATION_PENDING if the command has not completed yet,
+            otherwise the return code of the command, e.g. A76XX_OPERATION_SUCCEEDED,
+            A76XX_OPERATION_TIMEDOUT or A76XX_GENERIC_ERROR.
+    */
+    int8_t result() const {
+        return isPending() ? A76XX_OPERATION_PENDING : _result;
+    }
+};
+
+#endif A76XX_ASYNCCOMMAND_H_
@@ -0,0 +1,133 @@
+#include "A76XX.h"
+
+A76XXMQTTAggregator::A76XXMQTTAggregator(A76XXMQTTClient& client,
+                                         uint32_t window,
+                                         uint16_t threshold,
+                                         uint8_t qos,
+                                         uint8_t pub_timeout,
+                                         char separator)
+    : _client(client)
+    , _window(window)
+    , _threshold(threshold > MQTT_AGGREGATOR_BUFFER_SIZE ? MQTT_AGGREGATOR_BUFFER_SIZE : threshold)
+    , _qos(qos)
+    , _pub_timeout(pub_timeout)
+    , _separator(separator)
+    , _num_topics(0)
+    , _last_error_code(0) {
+    resetStats();
+}
+
+bool A76XXMQTTAggregator::add(const char* topic, const uint8_t* record, uint32_t length, bool priority) {
+    Buffer_t* buffer = length <= MQTT_AGGREGATOR_BUFFER_SIZE ? findBuffer(topic) : NULL;
+    if (buffer == NULL) {
+        _stats.dropped++;
+        _last_error_code = A76XX_OUT_OF_MEMORY;
+        return false;
+    }
+
+    // publish the records so far if this one does not fit after them
+    if (buffer->records > 0 && buffer->length + 1 + length > MQTT_AGGREGATOR_BUFFER_SIZE) {
+        if (flushBuffer(*buffer) == false) {
+            _stats.dropped++;
+            return false;
+        }
+    }
+
+    if (buffer->records == 0) {
+        buffer->tstart = millis();
+    } else {
+        buffer->data[buffer->length++] = _separator;
+    }
+    memcpy(buffer->data + buffer->length, record, length);
+    buffer->length += length;
+    buffer->records++;
+
+    if (priority || buffer->length >= _threshold) {
+        return flushBuffer(*buffer);
+    }
+    return true;
+}
+
+bool A76XXMQTTAggregator::add(const char* topic, const char* record, bool priority) {
+    return add(topic, reinterpret_cast<const uint8_t*>(record), strlen(record), priority);
+}
+
+void A76XXMQTTAggregator::loop() {
+    for (uint8_t i = 0; i < _num_topics; i++) {
+        Buffer_t& buffer = _buffers[i];
+        if (buffer.records > 0 && millis() - buffer.tstart >= _window) {
+            flushBuffer(buffer);
+        }
+    }
+}
+
+bool A76XXMQTTAggregator::flush() {
+    bool ok = true;
+    for (uint8_t i = 0; i < _num_topics; i++) {
+        if (_buffers[i].records > 0) {
+            ok = flushBuffer(_buffers[i]) && ok;
+        }
+    }
+    return ok;
+}
+
+bool A76XXMQTTAggregator::flush(const char* topic) {
+    for (uint8_t i = 0; i < _num_topics; i++) {
+        if (strcmp(_buffers[i].topic, topic) == 0) {
+            return _buffers[i].records == 0 || flushBuffer(_buffers[i]);
+        }
+    }
+    return true;
+}
+
+const AggregatorStats_t& A76XXMQTTAggregator::getStats() {
+    return _stats;
+}
+
+float A76XXMQTTAggregator::recordsPerFlush() {
+    return _stats.flushes > 0 ? static_cast<float>(_stats.records) / _stats.flushes : 0;
+}
+
+void A76XXMQTTAggregator::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+int8_t A76XXMQTTAggregator::getLastError() {
+    return _last_error_code;
+}
+
+A76XXMQTTAggregator::Buffer_t* A76XXMQTTAggregator::findBuffer(const char* topic) {
+    for (uint8_t i = 0; i < _num_topics; i++) {
+        if (strcmp(_buffers[i].topic, topic) == 0) {
+            return &_buffers[i];
+        }
+    }
+
+    if (_num_topics == MQTT_AGGREGATOR_TOPICS || strlen(topic) >= MQTT_TOPIC_BUFFER_LEN) {
+        return NULL;
+    }
+    Buffer_t& buffer = _buffers[_num_topics++];
+    strcpy(buffer.topic, topic);
+    buffer.length  = 0;
+    buffer.records = 0;
+    return &buffer;
+}
+
+bool A76XXMQTTAggregator::flushBuffer(Buffer_t& buffer) {
+    if (_client.publish(buffer.topic, buffer.data, buffer.length, _qos, _pub_timeout) == false) {
+        // try again after another window
+        _stats.failures++;
+        _last_error_code = _client.getLastError();
+        buffer.tstart = millis();
+        return false;
+    }
+
+    _stats.flushes++;
+    _stats.records         += buffer.records;
+    _stats.bytes_published += buffer.length;
+    _stats.bytes_saved     += (buffer.records - 1) * (strlen(buffer.topic) + PUBLISH_OVERHEAD - 1);
+
+    buffer.length  = 0;
+    buffer.records = 0;
+    return true;
+}
@@ -0,0 +1,155 @@
+#ifndef A76XX_MQTT_AGGREGATOR_H_
+#define A76XX_MQTT_AGGREGATOR_H_
+
+/*
+    @brief Statistics of an A76XXMQTTAggregator.
+*/
+struct AggregatorStats_t {
+    // messages published and records they contained
+    uint32_t    flushes;
+    uint32_t    records;
+
+    // length of the payloads published, including separators
+    uint32_t    bytes_published;
+
+    // estimate of the bytes not sent on the UART thanks to aggregation, i.e. the
+    // topic and commands of the messages not published, minus the separators
+    uint32_t    bytes_saved;
+
+    // messages that could not be published and records dropped
+    uint32_t    failures;
+    uint32_t    dropped;
+};
+
+/*
+    @brief Aggregate small records, e.g. sensor readings, into fewer MQTT messages.
+
+    @details Each message published with A76XXMQTTClient::publish costs three
+        commands and an acknowledgement from the broker, whatever the size of
+        the payload. Records added with ::add are appended to a buffer for their
+        topic, separated by a separator character, e.g. one JSON document or
+        CSV row per line, and a buffer is published as a single message when:
+        - its length reaches the size threshold, or the next record does not fit;
+        - the time window since its first record expires, checked by ::loop;
+        - a record is added with priority, e.g. an alarm, so that it is not delayed.
+
+        Records must not contain the separator. Buffers are allocated for the
+        first MQTT_AGGREGATOR_TOPICS topics used, and are never freed. If a
+        message cannot be published, e.g. when not connected, the buffer is kept
+        and published again after the time window, and a record that does not
+        fit in it is dropped.
+*/
+class A76XXMQTTAggregator {
+  private:
+    // approximate length of the commands of a publish and of their responses,
+    // excluding the topic and payload
+    static const uint32_t PUBLISH_OVERHEAD = 96;
+
+    struct Buffer_t {
+        char                                 topic[MQTT_TOPIC_BUFFER_LEN];
+        uint8_t                         data[MQTT_AGGREGATOR_BUFFER_SIZE];
+        uint16_t                                                  length;
+        uint16_t                                                 records;
+        uint32_t                                                  tstart;
+    };
+
+    A76XXMQTTClient&                                             _client;
+    uint32_t                                                     _window;
+    uint16_t                                                  _threshold;
+    uint8_t                                                         _qos;
+    uint8_t                                                 _pub_timeout;
+    char                                                      _separator;
+    Buffer_t                                _buffers[MQTT_AGGREGATOR_TOPICS];
+    uint8_t                                                  _num_topics;
+    AggregatorStats_t                                             _stats;
+    int8_t                                              _last_error_code;
+
+    // the buffer of a topic, allocated if needed, or NULL
+    Buffer_t* findBuffer(const char* topic);
+
+    bool flushBuffer(Buffer_t& buffer);
+
+  public:
+    /*
+        @brief Construct an aggregator.
+
+        @param [IN] client The client used to publish the messages.
+        @param [IN] window The maximum time in milliseconds a record is kept
+            before being published.
+        @param [IN] threshold The length of the payload at which a buffer is
+            published, at most MQTT_AGGREGATOR_BUFFER_SIZE.
+        @param [IN] qos The quality of service of the messages: 0, 1 or 2.
+        @param [IN] pub_timeout The timeout of the publish command, in seconds.
+        @param [IN] separator The character between records.
+    */
+    A76XXMQTTAggregator(A76XXMQTTClient& client,
+                        uint32_t window = 5000,
+                        uint16_t threshold = MQTT_AGGREGATOR_BUFFER_SIZE,
+                        uint8_t qos = 1,
+                        uint8_t pub_timeout = 30,
+                        char separator = '\n');
+
+    /*
+        @brief Add a record.
+
+        @param [IN] topic The topic of the message the record is published in.
+        @param [IN] record The record.
+        @param [IN] length The length of the record.
+        @param [IN] priority Whether to publish the buffer of the topic now.
+        @return True if the record has been added and, if a message had to be
+            published, it has been. If false, getLastError() returns
+            A76XX_OUT_OF_MEMORY if the record is longer than
+            MQTT_AGGREGATOR_BUFFER_SIZE or there is no buffer for a new topic,
+            in which case the record is dropped, or the error of
+            A76XXMQTTClient::publish.
+    */
+    bool add(const char* topic, const uint8_t* record, uint32_t length, bool priority = false);
+
+    /*
+        @brief Add a record given as a string.
+    */
+    bool add(const char* topic, const char* record, bool priority = false);
+
+    /*
+        @brief Publish the buffers whose time window has expired.
+
+        @details Call this function frequently, e.g. with A76XXMQTTClient::loop.
+    */
+    void loop();
+
+    /*
+        @brief Publish the records of all topics now.
+
+        @return False if any message could not be published.
+    */
+    bool flush();
+
+    /*
+        @brief Publish the records of a topic now.
+
+        @return False if the message could not be published.
+    */
+    bool flush(const char* topic);
+
+    /*
+        @brief Get the statistics since construction or the last call to ::resetStats.
+    */
+    const AggregatorStats_t& getStats();
+
+    /*
+        @brief The average number of records per message published.
+    */
+    float recordsPerFlush();
+
+    /*
+        @brief Reset the statistics.
+    */
+    void resetStats();
+
+    /*
+        @brief Get the last error.
+    */
+    int8_t getLastError();
+};
+
+#endif A76XX_MQTT_AGGREGATOR_H_
@@ -17,48 +17,46 @@ struct NMEAMessage_t {
         incoming NMEA if they arrive at a high rate and the user is not parsing
         them appropriately. The size of this buffer is defines by the variable 
         GNSS_NMEA_QUEUE_SIZE. If messages arrive at a faster rate than they 
-        are read, older messages are dropped.
+        are read, older messages are dropped. The message being received is
+        assembled in a buffer that can be shared by several handlers, since
+        only one handler receives data at any time.
 */
 class GNSSOnNMEAMessage : public EventHandler_t {
   public:
     CircularBuffer<NMEAMessage_t, GNSS_NMEA_QUEUE_SIZE>&   _nmea_queue;
+    NMEAMessage_t&                                                _msg;
+    LineReader_t                                               _reader;
 
     /*
         @brief Constructor
 
         @param [IN] match_string the NMEA string to match
         @param [IN] queue a CircularBuffer for storing NMEA messages
-    
+        @param [IN] msg the buffer where the message being received is assembled
     */
     GNSSOnNMEAMessage(const char* match_string, 
-        CircularBuffer<NMEAMessage_t, GNSS_NMEA_QUEUE_SIZE>& queue)
+        CircularBuffer<NMEAMessage_t, GNSS_NMEA_QUEUE_SIZE>& queue,
+        NMEAMessage_t& msg)
         : EventHandler_t(match_string)
-        , _nmea_queue(queue) {}
-    
-    void process(ModemSerial* serial) {
-        NMEAMessage_t msg;
+        , _nmea_queue(queue)
+        , _msg(msg) {}
 
+    void begin() {
         // copy the match string at the beginning of the message to have the full message
-        for (uint i = 0; i < strlen(match_string); i++)
-            msg.payload[i] = match_string[i];
-        
-        // keep reading from that point until <CR>, then read <LF> and close the string
-        for (uint i = strlen(match_string); i < NMEA_MESSAGE_SIZE; i++) {
-            // wait until a char becomes available
-            while (serial->available() == 0) {}
-
-            // read and process
-            char c = static_cast<char>(serial->read());
-            if (c == '\r') {
-                serial->read(); 
-                msg.payload[i] = '\0';
-                break;
-            } else {
-                msg.payload[i] = c;
-            }
-        }
+        size_t len = strlen(match_string);
+        memcpy(_msg.payload, match_string, len);
+        _reader.clear(len);
+    }
 
-        _nmea_queue.push(msg);
+    size_t feed(const char* data, size_t length, State_t& state) {
+        // the rest of the message is up to <LF>, the <CR> is dropped
+        bool complete;
+        size_t n = _reader.feed(data, length, _msg.payload, NMEA_MESSAGE_SIZE, complete);
+        if (complete) {
+            _nmea_queue.push(_msg);
+            state = DONE;
+        }
+        return n;
     }
 };
 
@@ -69,6 +67,9 @@ class A76XXGNSSClient : public A76XXBaseClient {
     // use a single queue for all types of messages
     CircularBuffer<NMEAMessage_t, GNSS_NMEA_QUEUE_SIZE>          _nmea_queue;
 
+    // the message being received, shared by the handlers
+    NMEAMessage_t                                                 _nmea_msg;
+
     // array of handlers
     GNSSOnNMEAMessage                                      _nmea_handlers[6];
 
@@ -84,12 +85,12 @@ class A76XXGNSSClient : public A76XXBaseClient {
     A76XXGNSSClient(A76XX& modem) 
         : A76XXBaseClient(modem)
         , _gnss_cmds(_serial)
-        , _nmea_handlers {{"$GP", _nmea_queue},
-                          {"$GA", _nmea_queue},
-                          {"$GB", _nmea_queue},
-                          {"$GN", _nmea_queue},
-                          {"$GL", _nmea_queue},
-                          {"$BD", _nmea_queue}} {
+        , _nmea_handlers {{"$GP", _nmea_queue, _nmea_msg},
+                          {"$GA", _nmea_queue, _nmea_msg},
+                          {"$GB", _nmea_queue, _nmea_msg},
+                          {"$GN", _nmea_queue, _nmea_msg},
+                          {"$GL", _nmea_queue, _nmea_msg},
+                          {"$BD", _nmea_queue, _nmea_msg}} {
     }
 
     bool enableGNSS(GPSStart_t start,
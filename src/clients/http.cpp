@@ -10,7 +10,10 @@ A76XXHTTPClient::A76XXHTTPClient(A76XX& modem,
     , _use_ssl(use_ssl)
     , _server_name(server_name)
     , _server_port(server_port)
-    , _user_agent(user_agent) {}
+    , _user_agent(user_agent)
+    , _compressor(NULL)
+    , _compression_buffer(NULL)
+    , _compression_buffer_size(0) {}
 
 bool A76XXHTTPClient::begin() {
     int8_t retcode = _http_cmds.init();
@@ -60,42 +63,131 @@ bool A76XXHTTPClient::getResponseBody(String& body) {
     return true;
 }
 
-bool A76XXHTTPClient::request(uint8_t method,
-                              const char* path,
-                              const char* content_body,
-                              const char* content_type,
-                              const char* accept) {
+bool A76XXHTTPClient::getResponseBody(uint8_t* buffer, uint32_t size, uint32_t offset, uint32_t& length) {
+    int8_t retcode = _http_cmds.readResponseBodyRange(offset, buffer, size, length);
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    return true;
+}
+
+bool A76XXHTTPClient::getResponseBody(Print& output,
+                                      uint32_t chunk_size,
+                                      HTTPProgressCallback_t progress,
+                                      void* context) {
+    chunk_size = chunk_size > 0 ? chunk_size : HTTP_READ_CHUNK_SIZE;
+
+    uint32_t received = 0;
+    while (received < _last_body_length) {
+        uint32_t remaining = _last_body_length - received;
+        uint32_t length;
+        int8_t retcode = _http_cmds.readResponseBodyRange(received,
+                                                          remaining < chunk_size ? remaining : chunk_size,
+                                                          output, length);
+        A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+        // the body is shorter than reported
+        if (length == 0) {
+            _last_error_code = A76XX_GENERIC_ERROR;
+            return false;
+        }
+        received += length;
+
+        if (progress != NULL) {
+            progress(received, _last_body_length, context);
+        }
+    }
+    return true;
+}
+
+void A76XXHTTPClient::setCompression(LZCompressor_t* compressor, uint8_t* buffer, uint32_t size) {
+    _compressor              = buffer != NULL ? compressor : NULL;
+    _compression_buffer      = buffer;
+    _compression_buffer_size = size;
+}
+
+bool A76XXHTTPClient::prepareRequest(const char* path,
+                                     const char* content_body,
+                                     uint32_t content_length,
+                                     const char* content_type,
+                                     const char* accept) {
     int8_t retcode;
-    
+    CommandBatch_t batch;
+
     // set url
-    retcode = _http_cmds.configHttpURL(_server_name, _server_port, path, _use_ssl);
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    _http_cmds.configHttpURL(batch, _server_name, _server_port, path, _use_ssl);
 
     // set user agent
     if (_user_agent != NULL) {
-        addHeader("User-Agent", _user_agent);
+        _http_cmds.configHttpUserData(batch, "User-Agent", _user_agent);
     }
 
     // set Accept: header
     if (accept != NULL) {
-        retcode = _http_cmds.configHttpAccept(accept);
-        A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+        _http_cmds.configHttpAccept(batch, accept);
     }
 
     // set Content-Type: header
     if (content_type != NULL) {
-        retcode = _http_cmds.configHttpContentType(content_type);
-        A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+        _http_cmds.configHttpContentType(batch, content_type);
     }
 
-    // write request body
+    // the URL can contain ';', so commands are pipelined rather than chained
+    retcode = _serial.sendBatch(batch);
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+    // write request body, compressed if enabled and shorter
     if (content_body != NULL) {
-        retcode = _http_cmds.inputData(content_body, strlen(content_body));
+        size_t compressed = 0;
+        if (_compressor != NULL) {
+            compressed = _compressor->compress(reinterpret_cast<const uint8_t*>(content_body), content_length,
+                                               _compression_buffer, _compression_buffer_size);
+        }
+        if (compressed > 0) {
+            content_body   = reinterpret_cast<const char*>(_compression_buffer);
+            content_length = compressed;
+        }
+        retcode = _http_cmds.inputData(content_body, content_length);
         A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
     }
 
+    return true;
+}
+
+bool A76XXHTTPClient::request(uint8_t method,
+                              const char* path,
+                              const char* content_body,
+                              uint32_t content_length,
+                              const char* content_type,
+                              const char* accept) {
+    if (prepareRequest(path, content_body, content_length, content_type, accept) == false) {
+        return false;
+    }
+
     // execute request and get status code and content length
-    retcode = _http_cmds.action(method, &_last_status_code, &_last_body_length); 
+    int8_t retcode = _http_cmds.action(method, &_last_status_code, &_last_body_length); 
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+    return true;
+}
+
+bool A76XXHTTPClient::requestAsync(AsyncHTTPAction_t& command,
+                                   uint8_t method,
+                                   const char* path,
+                                   const char* content_body,
+                                   uint32_t content_length,
+                                   const char* content_type,
+                                   const char* accept) {
+    // the configuration of the request must not change while in progress
+    if (command.isPending()) {
+        _last_error_code = A76XX_ASYNC_COMMAND_BUSY;
+        return false;
+    }
+
+    if (prepareRequest(path, content_body, content_length, content_type, accept) == false) {
+        return false;
+    }
+
+    // status code and content length are stored when the request completes
+    int8_t retcode = _http_cmds.actionAsync(command, method, &_last_status_code, &_last_body_length); 
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
 
     return true;
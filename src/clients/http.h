@@ -1,6 +1,16 @@
 #ifndef A76XX_HTTP_CLIENT_H_
 #define A76XX_HTTP_CLIENT_H_
 
+/*
+    @brief Function called as the body of a response is read, see
+        A76XXHTTPClient::getResponseBody.
+
+    @param [IN] received The number of bytes of the body read so far.
+    @param [IN] total The length of the body.
+    @param [IN] context The pointer given with the callback.
+*/
+typedef void (*HTTPProgressCallback_t)(uint32_t received, uint32_t total, void* context);
+
 class A76XXHTTPClient : public A76XXSecureClient {
   private:
     HTTPCommands              _http_cmds;
@@ -11,6 +21,11 @@ class A76XXHTTPClient : public A76XXSecureClient {
     uint32_t           _last_body_length;
     uint16_t           _last_status_code;
 
+    // compression of the request bodies, see ::setCompression
+    LZCompressor_t*          _compressor;
+    uint8_t*         _compression_buffer;
+    uint32_t    _compression_buffer_size;
+
   public:
     /*
         @brief Construct an HTTP client.
@@ -90,7 +105,7 @@ class A76XXHTTPClient : public A76XXSecureClient {
             getResponseStatusCode to get the response status code.
     */
     bool get(const char* path, const char* accept = NULL) {
-        return request(0, path, NULL, NULL, accept);
+        return request(0, path, NULL, 0, NULL, accept);
     }
 
     /*
@@ -109,7 +124,58 @@ class A76XXHTTPClient : public A76XXSecureClient {
               const char* content_body,
               const char* content_type = NULL,
               const char* accept = NULL) {
-        return request(1, path, content_body, content_type, accept);
+        return request(1, path, content_body, content_body != NULL ? strlen(content_body) : 0,
+                       content_type, accept);
+    }
+
+    /*
+        @brief Execute a POST request with a binary body, e.g. encoded with CBORWriter_t.
+
+        @param [IN] path The path to the resource, EXCLUDING the leading "/".
+        @param [IN] content_body The body of the post request.
+        @param [IN] content_length The length of the body.
+        @param [IN] content_type The value of the "Content-Type" header, e.g.
+            "application/cbor". If NULL, it defaults to "text/plain".
+        @param [IN] accept The value of the "Accept" header. If NULL, it defaults to "*\/*".
+        @return See ::post.
+    */
+    bool post(const char* path,
+              const uint8_t* content_body,
+              uint32_t content_length,
+              const char* content_type = NULL,
+              const char* accept = NULL) {
+        return request(1, path, reinterpret_cast<const char*>(content_body), content_length,
+                       content_type, accept);
+    }
+
+    /*
+        @brief Execute a GET request, without waiting for the response.
+
+        @details The request is configured synchronously, then the HTTPACTION command
+            is queued with A76XX::submit and runs while A76XX::poll is called. When
+            `command` completes, use getResponseStatusCode, getResponseBodyLength,
+            getResponseHeader and getResponseBody as for ::get.
+        @param [IN] command The command object, which must stay alive until it
+            completes. Use it to check the result or to set a callback.
+        @param [IN] path The path to the resource, EXCLUDING the leading "/".
+        @param [IN] accept The value of the "Accept" header. If NULL, it defaults to "*\/*".
+        @return True if the request has been configured and queued. If false, use 
+            getLastError() to get details on the error.
+    */
+    bool getAsync(AsyncHTTPAction_t& command, const char* path, const char* accept = NULL) {
+        return requestAsync(command, 0, path, NULL, 0, NULL, accept);
+    }
+
+    /*
+        @brief Execute a POST request, without waiting for the response. See ::getAsync.
+    */
+    bool postAsync(AsyncHTTPAction_t& command,
+                   const char* path,
+                   const char* content_body,
+                   const char* content_type = NULL,
+                   const char* accept = NULL) {
+        return requestAsync(command, 1, path, content_body,
+                            content_body != NULL ? strlen(content_body) : 0, content_type, accept);
     }
 
     /*
@@ -146,7 +212,68 @@ class A76XXHTTPClient : public A76XXSecureClient {
     */
     bool getResponseBody(String& body);
 
+    /*
+        @brief Read part of the response body of the last successful request 
+            into a buffer, e.g. to process a large body in pieces.
+
+        @param [OUT] buffer The buffer.
+        @param [IN] size The size of the buffer, i.e. the maximum number of bytes
+            read with a single HTTPREAD.
+        @param [IN] offset The offset in the body of the first byte to read.
+        @param [OUT] length The number of bytes read, less than `size` at the
+            end of the body.
+        @return True on success. If false, use getLastError() to get detail on
+            the error.
+    */
+    bool getResponseBody(uint8_t* buffer, uint32_t size, uint32_t offset, uint32_t& length);
+
+    /*
+        @brief Stream the response body of the last successful request to a
+            Print, e.g. a file, so that bodies larger than the available RAM can
+            be downloaded.
+
+        @details The body is read with HTTPREAD in chunks of `chunk_size` bytes,
+            which go from the receive buffer of ModemSerial to `output` with no
+            other buffer. Larger chunks take fewer commands, hence fewer round
+            trips, so the transfer gets closer to the speed of the UART.
+        @param [IN] output The destination of the body.
+        @param [IN] chunk_size The number of bytes read with each HTTPREAD.
+        @param [IN] progress An optional function called after each chunk.
+        @param [IN] context A pointer passed to `progress`.
+        @return True if the whole body has been written to `output`. If false,
+            getLastError() returns A76XX_OUT_OF_MEMORY if `output` did not take
+            all the bytes written to it, or the error of HTTPREAD.
+    */
+    bool getResponseBody(Print& output,
+                         uint32_t chunk_size = HTTP_READ_CHUNK_SIZE,
+                         HTTPProgressCallback_t progress = NULL,
+                         void* context = NULL);
+
+    /*
+        @brief Compress the body of the requests made from now on.
+
+        @details Bodies are compressed with LZCompressor_t into `buffer` and
+            sent compressed only if shorter, so the server must check each body
+            with lzIsCompressed, or the same header, and decompress it. The
+            "Content-Type" header is not changed.
+        @param [IN] compressor The compressor, or NULL to disable compression,
+            which is the default.
+        @param [IN] buffer The buffer for the compressed body, which limits
+            the length of the bodies that are compressed.
+        @param [IN] size The size of the buffer.
+    */
+    void setCompression(LZCompressor_t* compressor, uint8_t* buffer, uint32_t size);
+
   private:
+    /*
+        @brief Set URL, headers and body of a request, see ::request.
+    */
+    bool prepareRequest(const char* path,
+                        const char* content_body,
+                        uint32_t content_length,
+                        const char* content_type,
+                        const char* accept);
+
     /*
         @brief Private request function used to unify all other types of requests
 
@@ -154,6 +281,7 @@ class A76XXHTTPClient : public A76XXSecureClient {
             3 is "DELETE",  4 is "PUT".
         @param [IN] path The path to the resource
         @param [IN] content_body The body content, can be NULL
+        @param [IN] content_length The length of the body content
         @param [IN] content_type The value of the "Content-Type" header. If NULL, it
             defaults to "text/plain".
         @param [IN] accept The value of the "Accept" header. If NULL, it defaults to "*\/*".
@@ -164,8 +292,20 @@ class A76XXHTTPClient : public A76XXSecureClient {
     bool request(uint8_t method,
                  const char* path,
                  const char* content_body,
+                 uint32_t content_length,
                  const char* content_type,
                  const char* accept);
+
+    /*
+        @brief Asynchronous version of ::request.
+    */
+    bool requestAsync(AsyncHTTPAction_t& command,
+                      uint8_t method,
+                      const char* path,
+                      const char* content_body,
+                      uint32_t content_length,
+                      const char* content_type,
+                      const char* accept);
 };
 
 #endif A76XX_HTTP_CLIENT_H_
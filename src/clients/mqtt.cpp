@@ -1,55 +1,302 @@
 #include "A76XX.h"
 
 
-void MQTTOnMessageRx::process(ModemSerial* serial) {
-    MQTTMessage_t msg;
+void MQTTOnMessageRx::begin() {
+    _step           = Step_t::START;
+    _topic_length   = 0;
+    _payload_length = 0;
+    _topic[0]       = '\0';
+    _sink_started   = false;
+    _record         = NULL;
+    _reader.clear();
+}
 
-    // skip the client index
-    serial->find(','); uint16_t   topic_length = serial->parseInt();
-    serial->find(','); uint16_t payload_length = serial->parseInt();
+bool MQTTOnMessageRx::peek(MQTTMessageView_t& msg) {
+    size_t length;
+    const uint8_t* record = _queue.peek(length);
+    if (record == NULL) {
+        return false;
+    }
+    memcpy(&msg.topic_length, record, sizeof(uint32_t));
+    memcpy(&msg.payload_length, record + sizeof(uint32_t), sizeof(uint32_t));
+    msg.topic   = reinterpret_cast<const char*>(record + HEADER_SIZE);
+    msg.payload = record + HEADER_SIZE + msg.topic_length + 1;
+    return true;
+}
 
-    serial->waitResponse("+CMQTTRXTOPIC: "); serial->find('\n');
-    if (topic_length < sizeof(msg.topic)) {
-        serial->readBytes(msg.topic, topic_length);
-        msg.topic[topic_length] = '\0';
-    } else {
-        // read what we can't store, then overwrite
-        serial->readBytes(msg.topic, topic_length - sizeof(msg.topic) + 1);
-        serial->readBytes(msg.topic, sizeof(msg.topic) - 1);
-        msg.topic[sizeof(msg.topic)] = '\0';
+void MQTTOnMessageRx::discard() {
+    if (_sink_started) {
+        _sink->abort();
+    }
+}
+
+void MQTTOnMessageRx::startSink() {
+    if (_sink_started == false) {
+        _sink->begin(_topic, _topic_total_len, _payload_total_len);
+        _sink_started = true;
+    }
+}
+
+EventHandler_t::State_t MQTTOnMessageRx::processLine() {
+    // +CMQTTRXSTART: <client_index>,<topic_total_len>,<payload_total_len>
+    if (_step == Step_t::START) {
+        _step = Step_t::LINE;
+        FieldTokenizer tokenizer(_line);
+        if (tokenizer.skip() == false ||
+            tokenizer.nextInt(_topic_total_len) == false ||
+            tokenizer.nextInt(_payload_total_len) == false) {
+            return DISCARDED;
+        }
+        // topic and payload are NULL terminated
+        if (_sink == NULL) {
+            _record = _queue.reserve(HEADER_SIZE + _topic_total_len + _payload_total_len + 2);
+            if (_record == NULL) {
+                _dropped++;
+            }
+        }
+        return PENDING;
+    }
+
+    // a blank line follows the topic and each chunk of the payload
+    if (_line[0] == '\0') {
+        return PENDING;
+    }
+
+    // +CMQTTRXEND: <client_index>
+    if (strncmp(_line, "+CMQTTRXEND: ", 13) == 0) {
+        if (_sink != NULL) {
+            startSink();
+            _sink->end();
+        } else if (_record != NULL) {
+            memcpy(_record, &_topic_length, sizeof(uint32_t));
+            memcpy(_record + sizeof(uint32_t), &_payload_length, sizeof(uint32_t));
+            _record[HEADER_SIZE + _topic_length] = '\0';
+            _record[HEADER_SIZE + _topic_length + 1 + _payload_length] = '\0';
+            _queue.commit(HEADER_SIZE + _topic_length + _payload_length + 2);
+        }
+        return DONE;
     }
 
-    serial->waitResponse("+CMQTTRXPAYLOAD: "); serial->find('\n');
-    if (payload_length < sizeof(msg.payload)) {
-        serial->readBytes(msg.payload, payload_length);
-        msg.payload[payload_length] = '\0';
+    // +CMQTTRXTOPIC: <client_index>,<sub_topic_len>
+    // +CMQTTRXPAYLOAD: <client_index>,<sub_payload_len>
+    const char* fields;
+    if (strncmp(_line, "+CMQTTRXTOPIC: ", 15) == 0) {
+        _step  = Step_t::TOPIC;
+        fields = _line + 15;
+    } else if (strncmp(_line, "+CMQTTRXPAYLOAD: ", 17) == 0) {
+        _step  = Step_t::PAYLOAD;
+        fields = _line + 17;
     } else {
-        // read what we can't store, then overwrite
-        serial->readBytes(msg.payload, payload_length - sizeof(msg.payload) + 1);
-        serial->readBytes(msg.payload, sizeof(msg.payload) - 1);
-        msg.payload[sizeof(msg.payload)] = '\0';
+        // not part of a message, e.g. data has been lost
+        return DISCARDED;
+    }
+
+    FieldTokenizer tokenizer(fields);
+    if (tokenizer.skip() == false || tokenizer.nextInt(_remaining) == false) {
+        return DISCARDED;
+    }
+    if (_remaining == 0) {
+        _step = Step_t::LINE;
+    }
+    return PENDING;
+}
+
+size_t MQTTOnMessageRx::feed(const char* data, size_t length, State_t& state) {
+    size_t count = 0;
+    while (count < length && state == PENDING) {
+        if (_step == Step_t::START || _step == Step_t::LINE) {
+            bool complete;
+            count += _reader.feed(data + count, length - count, _line, sizeof(_line), complete);
+            if (complete) {
+                state = processLine();
+                _reader.clear();
+            }
+            if (state == DISCARDED) {
+                discard();
+            }
+            continue;
+        }
+
+        size_t n = length - count < _remaining ? length - count : _remaining;
+
+        if (_step == Step_t::PAYLOAD && _sink != NULL) {
+            // the payload goes straight from the RX buffer to the sink
+            startSink();
+            _sink->write(reinterpret_cast<const uint8_t*>(data + count), n);
+        } else if (_step == Step_t::TOPIC) {
+            // copy what fits, in the record or in the buffer for the sink
+            char*  buffer = _record != NULL ? reinterpret_cast<char*>(_record + HEADER_SIZE) : _topic;
+            size_t size   = _record != NULL ? _topic_total_len : sizeof(_topic) - 1;
+            size_t m      = _topic_length < size ? size - _topic_length : 0;
+            m = n < m ? n : m;
+            memcpy(buffer + _topic_length, data + count, m);
+            _topic_length += m;
+            if (_record == NULL) {
+                _topic[_topic_length] = '\0';
+            }
+        } else if (_record != NULL) {
+            // the payload follows the topic in the record
+            uint8_t* buffer = _record + HEADER_SIZE + _topic_length + 1;
+            size_t   m      = _payload_length < _payload_total_len ? _payload_total_len - _payload_length : 0;
+            m = n < m ? n : m;
+            memcpy(buffer + _payload_length, data + count, m);
+            _payload_length += m;
+        }
+        count      += n;
+        _remaining -= n;
+
+        if (_remaining == 0) {
+            _step = Step_t::LINE;
+        }
+    }
+    return count;
+}
+
+uint16_t MQTTOnPublished::add(uint32_t timeout) {
+    if (_count == MQTT_PUBLISH_WINDOW) {
+        return 0;
+    }
+    if (++_next_handle == 0) {
+        _next_handle = 1;
+    }
+    InFlight_t& entry = _in_flight[(_head + _count) % MQTT_PUBLISH_WINDOW];
+    entry.handle  = _next_handle;
+    entry.result  = A76XX_OPERATION_PENDING;
+    entry.tstart  = millis();
+    entry.timeout = timeout;
+    _count++;
+    return entry.handle;
+}
+
+void MQTTOnPublished::complete(int8_t result) {
+    _in_flight[(_head + _completed) % MQTT_PUBLISH_WINDOW].result = result;
+    _completed++;
+}
+
+void MQTTOnPublished::expire() {
+    while (_completed < _count) {
+        const InFlight_t& entry = _in_flight[(_head + _completed) % MQTT_PUBLISH_WINDOW];
+        if (millis() - entry.tstart < entry.timeout) {
+            return;
+        }
+        complete(A76XX_OPERATION_TIMEDOUT);
+    }
+}
+
+void MQTTOnPublished::fail(int8_t result) {
+    while (_completed < _count) {
+        complete(result);
+    }
+}
+
+bool MQTTOnPublished::next(uint16_t& handle, int8_t& result) {
+    if (_completed == 0) {
+        return false;
     }
+    handle = _in_flight[_head].handle;
+    result = _in_flight[_head].result;
+    _head = (_head + 1) % MQTT_PUBLISH_WINDOW;
+    _count--;
+    _completed--;
+    return true;
+}
 
-    serial->waitResponse("+CMQTTRXEND: "); serial->find('\n');
+bool MQTTOnPublished::takeLast(int8_t& result) {
+    if (_count == 0 || _completed < _count) {
+        return false;
+    }
+    result = _in_flight[(_head + _count - 1) % MQTT_PUBLISH_WINDOW].result;
+    _count--;
+    _completed--;
+    return true;
+}
 
-    messageQueue.push(msg);
+void MQTTOnPublished::begin() {
+    _reader.clear();
+}
+
+size_t MQTTOnPublished::feed(const char* data, size_t length, State_t& state) {
+    bool complete_line;
+    size_t n = _reader.feed(data, length, _line, sizeof(_line), complete_line);
+    if (complete_line == false) {
+        return n;
+    }
+
+    // <client_index>,<err>
+    FieldTokenizer tokenizer(_line);
+    uint8_t client_index;
+    int8_t err;
+    if (tokenizer.nextInt(client_index) == false || tokenizer.nextInt(err) == false) {
+        state = DISCARDED;
+        return n;
+    }
+
+    // the response to a CMQTTPUB whose outcome is waited for, e.g. by
+    // MQTTCommands::publish, is not seen here, so a URC with no message in 
+    // flight is late, e.g. after the message timed out, and is ignored
+    if (_completed < _count) {
+        complete(err == 0 ? A76XX_OPERATION_SUCCEEDED : err);
+    }
+    state = DONE;
+    return n;
 }
 
 A76XXMQTTClient::A76XXMQTTClient(A76XX& modem, const char* clientID, bool use_ssl)
     : A76XXSecureClient(modem)
+    , _modem(modem)
     , _mqtt_cmds(_serial)
+    , _service(modem.mqttService)
     , _clientID(clientID)
     , _use_ssl(use_ssl)
-    , _client_index(0)
-    , _session_id(0) {
-        // enable parsing MQTT URCs
-        _serial.registerEventHandler(&_on_message_rx_handler);
+    , _publish_window(MQTT_PUBLISH_WINDOW)
+    , _publish_callback(NULL)
+    , _publish_context(NULL)
+    , _default_handler(NULL)
+    , _default_context(NULL)
+    , _started(false)
+    , _compressor(NULL)
+    , _compression_buffer(NULL)
+    , _compression_buffer_size(0)
+    , _resumed(false)
+    , _connection_lost(false)
+    , _connections(0)
+    , _auto_reconnect(false)
+    , _apn(NULL)
+    , _min_backoff(1000)
+    , _max_backoff(60000)
+    , _backoff_step(0)
+    , _lost_time(0)
+    , _next_attempt(0)
+    , _prng(0)
+    , _reconnect_stats() {
+        for (auto& subscription : _subscriptions) {
+            subscription.handler = NULL;
+            subscription.context = NULL;
+            subscription.used    = false;
+        }
+
+        // enable parsing MQTT URCs, routed by client index
+        _client_index = _service.allocateClient(&_on_message_rx_handler, &_on_published_handler);
+        _session_id   = _client_index;
     }
 
+A76XXMQTTClient::~A76XXMQTTClient() {
+    _service.freeClient(_client_index);
+}
+
 bool A76XXMQTTClient::begin() {
-    // start
-    int8_t retcode = _mqtt_cmds.start();
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    if (_client_index == _service.NONE) {
+        _last_error_code = A76XX_MQTT_NO_FREE_CLIENT;
+        return false;
+    }
+
+    // start, unless already started by another client
+    int8_t retcode = A76XX_OPERATION_SUCCEEDED;
+    if (_started == false) {
+        retcode = _service.start();
+        A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+        _started = true;
+    }
 
     // acquire client
     uint8_t server_type = _use_ssl ? 1 : 0;
@@ -73,8 +320,51 @@ bool A76XXMQTTClient::connect(const char* server_name, int port,
                               const char* will_topic,
                               const char* will_message,
                               int will_qos) {
+    _connect_params = {server_name, port, clean_session, keepalive, username, password,
+                       will_topic, will_message, will_qos};
+
+    // a loss reported before is about a previous connection
+    uint32_t timestamp;
+    uint8_t  cause;
+    _service.takeConnectionLost(_client_index, timestamp, cause);
+
+    int8_t retcode = connectWithParams();
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+    _connection_lost = false;
+    _connections++;
+    return true;
+}
+
+int8_t A76XXMQTTClient::connectWithParams() {
+    const ConnectParams_t& p = _connect_params;
+    int8_t retcode;
+
+    if (p.will_message != NULL && p.will_topic != NULL) {
+        retcode = _mqtt_cmds.setWillTopic(_client_index, p.will_topic);
+        A76XX_RETCODE_ASSERT_RETURN(retcode);
+        retcode = _mqtt_cmds.setWillMessage(_client_index, p.will_message, p.will_qos);
+        A76XX_RETCODE_ASSERT_RETURN(retcode);
+    }
+
+    return _mqtt_cmds.connect(_client_index, p.server_name, p.port, p.clean_session,
+                              p.keep_alive, p.username, p.password);
+}
+
+bool A76XXMQTTClient::connectAsync(AsyncMQTTConnect_t& command,
+                                   const char* server_name, int port,
+                                   bool clean_session,
+                                   int keepalive,
+                                   const char* username,
+                                   const char* password,
+                                   const char* will_topic,
+                                   const char* will_message,
+                                   int will_qos) {
     int8_t retcode;
 
+    _connect_params = {server_name, port, clean_session, keepalive, username, password,
+                       will_topic, will_message, will_qos};
+
     if (will_message != NULL && will_topic != NULL) {
         retcode = _mqtt_cmds.setWillTopic(_client_index, will_topic);
         A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
@@ -82,12 +372,91 @@ bool A76XXMQTTClient::connect(const char* server_name, int port,
         A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
     }
 
-    retcode = _mqtt_cmds.connect(_client_index, server_name, port, clean_session, keepalive, username, password);
+    uint32_t timestamp;
+    uint8_t  cause;
+    _service.takeConnectionLost(_client_index, timestamp, cause);
+
+    retcode = _mqtt_cmds.connectAsync(command, _client_index, server_name, port, clean_session, keepalive, username, password);
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
 
+    // the outcome is not known here, so the connection is counted as restored
+    _connection_lost = false;
+    _connections++;
     return true;
 }
 
+bool A76XXMQTTClient::resume(const char* server_name, int port,
+                             bool clean_session,
+                             int keepalive,
+                             const char* username,
+                             const char* password,
+                             const char* will_topic,
+                             const char* will_message,
+                             int will_qos) {
+    _resumed = false;
+    if (_client_index == _service.NONE) {
+        _last_error_code = A76XX_MQTT_NO_FREE_CLIENT;
+        return false;
+    }
+    _connect_params = {server_name, port, clean_session, keepalive, username, password,
+                       will_topic, will_message, will_qos};
+
+    bool connected[A76XX_MQTT_MAX_CLIENTS] = {};
+    int8_t retcode = _mqtt_cmds.getConnectionStates(connected);
+    if (retcode != A76XX_OPERATION_SUCCEEDED && retcode != A76XX_MQTT_ALREADY_STOPPED) {
+        _last_error_code = retcode;
+        return false;
+    }
+    bool running = retcode == A76XX_OPERATION_SUCCEEDED;
+
+    if (running && _started == false) {
+        _service.attach();
+        _started = true;
+    }
+
+    // losses reported before are about a previous connection
+    uint32_t timestamp;
+    uint8_t  cause;
+    _service.takeConnectionLost(_client_index, timestamp, cause);
+
+    if (running && connected[_client_index]) {
+        _resumed         = true;
+        _connection_lost = false;
+        _connections++;
+        return true;
+    }
+
+    if (running == false) {
+        return begin() && connect(server_name, port, clean_session, keepalive,
+                                  username, password, will_topic, will_message, will_qos);
+    }
+
+    // the client may still be acquired, with other settings
+    uint8_t server_type = _use_ssl ? 1 : 0;
+    retcode = _mqtt_cmds.acquireClient(_client_index, _clientID, server_type);
+    if (retcode != A76XX_OPERATION_SUCCEEDED) {
+        _mqtt_cmds.releaseClient(_client_index);
+        retcode = _mqtt_cmds.acquireClient(_client_index, _clientID, server_type);
+    }
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+    if (_use_ssl) {
+        retcode = _mqtt_cmds.setSSLContext(_session_id, _ssl_ctx_index);
+        A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    }
+
+    retcode = connectWithParams();
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+    _connection_lost = false;
+    _connections++;
+    return true;
+}
+
+bool A76XXMQTTClient::resumed() {
+    return _resumed;
+}
+
 bool A76XXMQTTClient::disconnect(uint8_t timeout) {
     int8_t retcode = _mqtt_cmds.disconnect(_client_index, timeout);
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
@@ -98,8 +467,12 @@ bool A76XXMQTTClient::end() {
     int8_t retcode = _mqtt_cmds.releaseClient(_client_index);
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
 
-    retcode = _mqtt_cmds.stop();
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    // stop, unless used by another client
+    if (_started) {
+        _started = false;
+        retcode = _service.stop();
+        A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    }
 
     return true;
 }
@@ -111,18 +484,127 @@ bool A76XXMQTTClient::publish(const char* topic,
                               uint8_t pub_timeout,
                               bool retained,
                               bool dup) {
-    int8_t retcode = _mqtt_cmds.setTopic(_client_index, topic);
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    checkConnectionLost();
+    if (_connection_lost) {
+        _last_error_code = A76XX_MQTT_CONNECTION_LOST;
+        return false;
+    }
 
-    retcode = _mqtt_cmds.setPayload(_client_index, payload, length);
+    // the outcome is reported as for the messages in flight, to tell it apart 
+    // from the outcome of the messages in flight of this or other clients
+    while (_on_published_handler.size() == MQTT_PUBLISH_WINDOW) {
+        _serial.poll();
+        dispatchPublished();
+    }
+
+    payload = compressPayload(payload, length);
+    int8_t retcode = _mqtt_cmds.sendMessage(_client_index, topic, payload, length, qos,
+                                            pub_timeout, retained, dup);
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
 
-    retcode = _mqtt_cmds.publish(_client_index, qos, pub_timeout, retained, dup);
+    _on_published_handler.add(1000 * static_cast<uint32_t>(pub_timeout) + A76XX_EVENT_HANDLER_TIMEOUT);
+    while (_on_published_handler.takeLast(retcode) == false) {
+        _serial.poll();
+        _on_published_handler.expire();
+        checkConnectionLost();
+    }
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
 
     return true;
 }
 
+uint16_t A76XXMQTTClient::publishNonBlocking(const char* topic,
+                                             const uint8_t* payload,
+                                             uint32_t length,
+                                             uint8_t qos,
+                                             uint8_t pub_timeout,
+                                             bool retained,
+                                             bool dup,
+                                             uint32_t timeout) {
+    checkConnectionLost();
+    if (_connection_lost) {
+        _last_error_code = A76XX_MQTT_CONNECTION_LOST;
+        return 0;
+    }
+
+    _on_published_handler.expire();
+    if (_on_published_handler.pending() >= _publish_window ||
+        _on_published_handler.size() == MQTT_PUBLISH_WINDOW) {
+        _last_error_code = A76XX_MQTT_WINDOW_FULL;
+        return 0;
+    }
+
+    payload = compressPayload(payload, length);
+    int8_t retcode = _mqtt_cmds.sendMessage(_client_index, topic, payload, length, qos,
+                                            pub_timeout, retained, dup);
+    if (retcode != A76XX_OPERATION_SUCCEEDED) {
+        _last_error_code = retcode;
+        return 0;
+    }
+
+    if (timeout == 0) {
+        timeout = 1000 * static_cast<uint32_t>(pub_timeout) + A76XX_EVENT_HANDLER_TIMEOUT;
+    }
+    return _on_published_handler.add(timeout);
+}
+
+void A76XXMQTTClient::setPublishWindow(uint8_t size) {
+    _publish_window = size < 1 ? 1 : size > MQTT_PUBLISH_WINDOW ? MQTT_PUBLISH_WINDOW : size;
+}
+
+void A76XXMQTTClient::setCompression(LZCompressor_t* compressor, uint8_t* buffer, uint32_t size) {
+    _compressor              = buffer != NULL ? compressor : NULL;
+    _compression_buffer      = buffer;
+    _compression_buffer_size = size;
+}
+
+const uint8_t* A76XXMQTTClient::compressPayload(const uint8_t* payload, uint32_t& length) {
+    if (_compressor == NULL) {
+        return payload;
+    }
+    size_t compressed = _compressor->compress(payload, length, _compression_buffer, _compression_buffer_size);
+    if (compressed == 0) {
+        return payload;
+    }
+    length = compressed;
+    return _compression_buffer;
+}
+
+void A76XXMQTTClient::onPublished(MQTTPublishCallback_t callback, void* context) {
+    _publish_callback = callback;
+    _publish_context  = context;
+}
+
+uint8_t A76XXMQTTClient::publishesInFlight() {
+    return _on_published_handler.size();
+}
+
+bool A76XXMQTTClient::waitPublished(uint32_t timeout) {
+    uint32_t tstart = millis();
+    while (true) {
+        _serial.poll();
+        dispatchPublished();
+        if (_on_published_handler.size() == 0) {
+            return true;
+        }
+        if (millis() - tstart >= timeout) {
+            return false;
+        }
+    }
+}
+
+void A76XXMQTTClient::dispatchPublished() {
+    _on_published_handler.expire();
+
+    uint16_t handle;
+    int8_t   result;
+    while (_on_published_handler.next(handle, result)) {
+        if (_publish_callback != NULL) {
+            _publish_callback(handle, result, _publish_context);
+        }
+    }
+}
+
 bool A76XXMQTTClient::publish(const char* topic,
                               const char* payload,
                               uint8_t qos,
@@ -133,20 +615,356 @@ bool A76XXMQTTClient::publish(const char* topic,
             pub_timeout, retained, dup);
 }
 
+bool A76XXMQTTClient::publishAsync(AsyncMQTTPublish_t& command,
+                                   const char* topic,
+                                   const uint8_t* payload,
+                                   uint32_t length,
+                                   uint8_t qos,
+                                   uint8_t pub_timeout,
+                                   bool retained,
+                                   bool dup) {
+    int8_t retcode = _mqtt_cmds.publishAsync(command, _client_index, topic, payload, length, qos, pub_timeout, retained, dup);
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    return true;
+}
+
 bool A76XXMQTTClient::subscribe(const char* topic, uint8_t qos) {
+    // stored, if there is space, to subscribe again after a reconnection
+    bool added;
+    uint8_t id = reserveSubscription(topic, added);
+
     int8_t retcode = _mqtt_cmds.subscribe(_client_index, topic, qos);
+    if (retcode != A76XX_OPERATION_SUCCEEDED && added && id != _topic_trie.NONE) {
+        _subscriptions[id].used = false;
+        _topic_trie.remove(topic);
+    }
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+    if (id != _topic_trie.NONE) {
+        _subscriptions[id].qos = qos;
+    }
     return true;
 }
 
+bool A76XXMQTTClient::subscribe(const char* topic, uint8_t qos, MQTTMessageHandler_t handler, void* context) {
+    if (handler == NULL) {
+        return subscribe(topic, qos);
+    }
+
+    bool added;
+    uint8_t id = reserveSubscription(topic, added);
+    if (id == _topic_trie.NONE) {
+        _last_error_code = A76XX_OUT_OF_MEMORY;
+        return false;
+    }
+
+    int8_t retcode = _mqtt_cmds.subscribe(_client_index, topic, qos);
+    if (retcode != A76XX_OPERATION_SUCCEEDED && added && id != _topic_trie.NONE) {
+        _subscriptions[id].used = false;
+        _topic_trie.remove(topic);
+    }
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+    _subscriptions[id].handler = handler;
+    _subscriptions[id].context = context;
+    _subscriptions[id].qos     = qos;
+    return true;
+}
+
+bool A76XXMQTTClient::subscribeMany(const char* const topics[], uint8_t count, uint8_t qos,
+                                    MQTTMessageHandler_t handler, void* context) {
+    if (handler != NULL && count > MQTT_MAX_SUBSCRIPTIONS) {
+        _last_error_code = A76XX_OUT_OF_MEMORY;
+        return false;
+    }
+
+    // reserve the slots of all filters first, so that each filter gets a 
+    // distinct slot. Without a handler, the filters that do not fit are only
+    // not subscribed again after a reconnection
+    uint8_t ids[MQTT_MAX_SUBSCRIPTIONS];
+    bool    added[MQTT_MAX_SUBSCRIPTIONS];
+    uint8_t reserved = 0;
+    int8_t  retcode  = A76XX_OPERATION_SUCCEEDED;
+    for (; reserved < count && reserved < MQTT_MAX_SUBSCRIPTIONS; reserved++) {
+        ids[reserved] = reserveSubscription(topics[reserved], added[reserved]);
+        if (ids[reserved] == _topic_trie.NONE) {
+            retcode = handler != NULL ? A76XX_OUT_OF_MEMORY : retcode;
+            break;
+        }
+    }
+
+    for (uint8_t i = 0; i < count && retcode == A76XX_OPERATION_SUCCEEDED; i++) {
+        retcode = _mqtt_cmds.setSubscribeTopic(_client_index, topics[i], qos);
+    }
+    if (retcode == A76XX_OPERATION_SUCCEEDED) {
+        retcode = _mqtt_cmds.subscribeTopics(_client_index);
+    }
+
+    for (uint8_t i = 0; i < reserved; i++) {
+        if (retcode == A76XX_OPERATION_SUCCEEDED) {
+            // without a handler, the handler of a known filter is kept
+            if (handler != NULL) {
+                _subscriptions[ids[i]].handler = handler;
+                _subscriptions[ids[i]].context = context;
+            }
+            _subscriptions[ids[i]].qos = qos;
+        } else if (added[i]) {
+            _subscriptions[ids[i]].used = false;
+            _topic_trie.remove(topics[i]);
+        }
+    }
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    return true;
+}
+
+bool A76XXMQTTClient::unsubscribe(const char* topic) {
+    int8_t retcode = _mqtt_cmds.unsubscribe(_client_index, topic);
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    removeSubscription(topic);
+    return true;
+}
+
+bool A76XXMQTTClient::unsubscribeMany(const char* const topics[], uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        int8_t retcode = _mqtt_cmds.setUnsubscribeTopic(_client_index, topics[i]);
+        A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    }
+    int8_t retcode = _mqtt_cmds.unsubscribeTopics(_client_index);
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+
+    for (uint8_t i = 0; i < count; i++) {
+        removeSubscription(topics[i]);
+    }
+    return true;
+}
+
+uint8_t A76XXMQTTClient::reserveSubscription(const char* topic, bool& added) {
+    // the slot of the same filter, or a free one
+    uint8_t id = _topic_trie.find(topic);
+    added = id == _topic_trie.NONE;
+    for (uint8_t i = 0; i < MQTT_MAX_SUBSCRIPTIONS && id == _topic_trie.NONE; i++) {
+        if (_subscriptions[i].used == false) {
+            id = i;
+        }
+    }
+    if (id == _topic_trie.NONE || _topic_trie.insert(topic, id) == false) {
+        return _topic_trie.NONE;
+    }
+
+    // taken until removed, so that the next filters get other slots
+    if (added) {
+        _subscriptions[id].handler = NULL;
+        _subscriptions[id].context = NULL;
+        _subscriptions[id].used    = true;
+    }
+    return id;
+}
+
+void A76XXMQTTClient::removeSubscription(const char* topic) {
+    uint8_t id = _topic_trie.remove(topic);
+    if (id != _topic_trie.NONE) {
+        _subscriptions[id].handler = NULL;
+        _subscriptions[id].context = NULL;
+        _subscriptions[id].used    = false;
+    }
+}
+
+void A76XXMQTTClient::onMessage(MQTTMessageHandler_t handler, void* context) {
+    _default_handler = handler;
+    _default_context = context;
+}
+
+void A76XXMQTTClient::loop() {
+    _serial.poll();
+    superviseConnection();
+    dispatchPublished();
+
+    MQTTMessageView_t msg;
+    while (peekMessage(msg)) {
+        bool handled = false;
+        _topic_trie.match(msg.topic, msg.topic_length, [&](uint8_t id) {
+            if (_subscriptions[id].handler != NULL) {
+                _subscriptions[id].handler(msg, _subscriptions[id].context);
+                handled = true;
+            }
+        });
+        if (handled == false && _default_handler != NULL) {
+            _default_handler(msg, _default_context);
+        }
+        consumeMessage();
+    }
+}
+
+void A76XXMQTTClient::setMessageSink(MQTTMessageSink_t* sink) {
+    _on_message_rx_handler.setSink(sink);
+}
+
 uint32_t A76XXMQTTClient::messageAvailable() {
-    return _on_message_rx_handler.messageQueue.size();
+    return _on_message_rx_handler.available();
+}
+
+bool A76XXMQTTClient::peekMessage(MQTTMessageView_t& msg) {
+    return _on_message_rx_handler.peek(msg);
+}
+
+void A76XXMQTTClient::consumeMessage() {
+    _on_message_rx_handler.consume();
 }
 
 MQTTMessage_t A76XXMQTTClient::getMessage() {
-    return _on_message_rx_handler.messageQueue.shift();
+    MQTTMessage_t msg;
+    MQTTMessageView_t view;
+    if (_on_message_rx_handler.peek(view) == false) {
+        msg.topic[0] = msg.payload[0] = '\0';
+        return msg;
+    }
+
+    size_t n = view.topic_length < sizeof(msg.topic) - 1 ? view.topic_length : sizeof(msg.topic) - 1;
+    memcpy(msg.topic, view.topic, n);
+    msg.topic[n] = '\0';
+
+    n = view.payload_length < sizeof(msg.payload) - 1 ? view.payload_length : sizeof(msg.payload) - 1;
+    memcpy(msg.payload, view.payload, n);
+    msg.payload[n] = '\0';
+
+    _on_message_rx_handler.consume();
+    return msg;
+}
+
+uint32_t A76XXMQTTClient::messagesDropped() {
+    return _on_message_rx_handler.dropped();
+}
+
+size_t A76XXMQTTClient::messageQueueHighWaterMark() {
+    return _on_message_rx_handler.highWaterMark();
 }
 
 bool A76XXMQTTClient::isConnected() {
     return _mqtt_cmds.isConnected(_client_index);
+}
+
+void A76XXMQTTClient::setAutoReconnect(bool enable, const char* apn,
+                                       uint32_t min_backoff, uint32_t max_backoff) {
+    _auto_reconnect = enable;
+    _apn            = apn;
+    _min_backoff    = min_backoff > 0 ? min_backoff : 1;
+    _max_backoff    = max_backoff > _min_backoff ? max_backoff : _min_backoff;
+}
+
+bool A76XXMQTTClient::connectionLost() {
+    checkConnectionLost();
+    return _connection_lost;
+}
+
+uint32_t A76XXMQTTClient::connections() {
+    return _connections;
+}
+
+MQTTReconnectStats_t A76XXMQTTClient::getReconnectStats() {
+    return _reconnect_stats;
+}
+
+void A76XXMQTTClient::checkConnectionLost() {
+    uint32_t timestamp;
+    uint8_t  cause;
+    if (_service.takeConnectionLost(_client_index, timestamp, cause) == false ||
+        _connection_lost) {
+        return;
+    }
+
+    _connection_lost = true;
+    _lost_time       = timestamp;
+    _next_attempt    = timestamp;
+    _backoff_step    = 0;
+    _reconnect_stats.losses++;
+
+    // their outcome will not be reported
+    _on_published_handler.fail(A76XX_MQTT_CONNECTION_LOST);
+}
+
+void A76XXMQTTClient::superviseConnection() {
+    checkConnectionLost();
+    if (_auto_reconnect && _connection_lost &&
+        static_cast<int32_t>(millis() - _next_attempt) >= 0) {
+        reconnect();
+    }
+}
+
+bool A76XXMQTTClient::reconnect() {
+    _reconnect_stats.attempts++;
+
+    // losses reported until now are about the lost connection
+    uint32_t timestamp;
+    uint8_t  cause;
+    _service.takeConnectionLost(_client_index, timestamp, cause);
+
+    int8_t retcode = connectWithParams();
+    if (retcode != A76XX_OPERATION_SUCCEEDED) {
+        // the bearer or the service may have gone too, e.g. after the PDP
+        // context has been deactivated, so set everything up again
+        if (_apn != NULL && _modem.isGPRSConnected() == false) {
+            _modem.GPRSConnect(_apn);
+        }
+        _mqtt_cmds.start();
+        uint8_t server_type = _use_ssl ? 1 : 0;
+        _mqtt_cmds.acquireClient(_client_index, _clientID, server_type);
+        if (_use_ssl) {
+            _mqtt_cmds.setSSLContext(_session_id, _ssl_ctx_index);
+        }
+        retcode = connectWithParams();
+    }
+
+    if (retcode == A76XX_OPERATION_SUCCEEDED) {
+        retcode = resubscribe();
+        if (retcode != A76XX_OPERATION_SUCCEEDED) {
+            _mqtt_cmds.disconnect(_client_index, 10);
+        }
+    }
+
+    if (retcode != A76XX_OPERATION_SUCCEEDED) {
+        _last_error_code = retcode;
+
+        // exponential backoff, with a random jitter of up to half the delay
+        uint32_t delay = _min_backoff;
+        for (uint8_t i = 0; i < _backoff_step && delay < _max_backoff; i++) {
+            delay *= 2;
+        }
+        delay = delay < _max_backoff ? delay : _max_backoff;
+        _backoff_step++;
+
+        // xorshift32, seeded with the time
+        _prng ^= millis() | 1;
+        _prng ^= _prng << 13;
+        _prng ^= _prng >> 17;
+        _prng ^= _prng << 5;
+        _next_attempt = millis() + delay - (_prng % (delay / 2 + 1));
+        return false;
+    }
+
+    uint32_t recovery = millis() - _lost_time;
+    _reconnect_stats.reconnections++;
+    _reconnect_stats.last_recovery   = recovery;
+    _reconnect_stats.total_recovery += recovery;
+    if (recovery > _reconnect_stats.max_recovery) {
+        _reconnect_stats.max_recovery = recovery;
+    }
+    _connection_lost = false;
+    _connections++;
+    return true;
+}
+
+int8_t A76XXMQTTClient::resubscribe() {
+    int8_t  retcode = A76XX_OPERATION_SUCCEEDED;
+    uint8_t count   = 0;
+    char    filter[MQTT_FILTER_BUFFER_LEN];
+    _topic_trie.forEach(filter, sizeof(filter), [&](const char* topic, uint8_t id) {
+        if (retcode == A76XX_OPERATION_SUCCEEDED) {
+            retcode = _mqtt_cmds.setSubscribeTopic(_client_index, topic, _subscriptions[id].qos);
+            count++;
+        }
+    });
+    if (retcode == A76XX_OPERATION_SUCCEEDED && count > 0) {
+        retcode = _mqtt_cmds.subscribeTopics(_client_index);
+    }
+    return retcode;
 }
\ No newline at end of file
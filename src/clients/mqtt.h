@@ -9,44 +9,433 @@ struct MQTTMessage_t {
     char payload[MQTT_PAYLOAD_BUFFER_LEN];
 };
 
+/*
+    @brief A view of an MQTT message stored in the queue of a client, see
+        A76XXMQTTClient::peekMessage.
+
+    @details The pointers are valid until A76XXMQTTClient::consumeMessage.
+        Topic and payload are followed by a NULL character, so they can be used
+        as strings if the payload is text.
+*/
+struct MQTTMessageView_t {
+    const char*                                                    topic;
+    uint32_t                                                topic_length;
+    const uint8_t*                                               payload;
+    uint32_t                                              payload_length;
+};
+
+/*
+    @brief Function called with the messages received on a subscription, see
+        A76XXMQTTClient::subscribe and A76XXMQTTClient::loop.
+
+    @param [IN] msg The message, valid during the call.
+    @param [IN] context The pointer given with the handler.
+*/
+typedef void (*MQTTMessageHandler_t)(const MQTTMessageView_t& msg, void* context);
+
+/*
+    @brief Interface of objects receiving MQTT messages as they arrive, see
+        A76XXMQTTClient::setMessageSink.
+
+    @details For each message, ::begin is called with the topic and the total
+        length of the payload. Then ::write is called with consecutive chunks of
+        the payload, straight from the receive buffer of ModemSerial, so that
+        payloads of any length can be received without storing them. Finally
+        ::end is called, or ::abort if the message is not received completely.
+        These functions are called while data is received, e.g. from A76XX::poll
+        or while a command waits for its response, so they must return quickly
+        and must not send commands to the module.
+*/
+class MQTTMessageSink_t {
+  public:
+    /*
+        @brief Start of a message.
+
+        @param [IN] topic The topic, truncated to MQTT_TOPIC_BUFFER_LEN - 1 characters.
+        @param [IN] topic_length The length of the whole topic.
+        @param [IN] payload_length The length of the whole payload.
+    */
+    virtual void begin(const char* topic, uint32_t topic_length, uint32_t payload_length) = 0;
+
+    /*
+        @brief A chunk of the payload.
+
+        @param [IN] data The data, only valid during the call.
+        @param [IN] length The number of bytes, which can be zero.
+    */
+    virtual void write(const uint8_t* data, size_t length) = 0;
+
+    /*
+        @brief End of the message, all of the payload has been written.
+    */
+    virtual void end() {}
+
+    /*
+        @brief The message has not been received completely, e.g. because data
+            has been lost, and the payload written so far should be dropped.
+    */
+    virtual void abort() {}
+};
+
+/*
+    @brief A sink writing the payload of the messages to a Print object, e.g. a File.
+*/
+class MQTTPrintSink_t : public MQTTMessageSink_t {
+  private:
+    Print&                                                          _out;
+
+  public:
+    MQTTPrintSink_t(Print& out)
+        : _out(out) {}
+
+    void begin(const char* topic, uint32_t topic_length, uint32_t payload_length) {}
+
+    void write(const uint8_t* data, size_t length) {
+        _out.write(data, length);
+    }
+};
+
 /*
     @brief Handler of the URC "+CMQTTRXSTART".
 
     @details This object is responsible of detecting, parsing and storing 
-        incoming MQTT messages sent to the device. It has one important 
-        member, "messageQueue", i.e. a CircularBuffer object used to store 
-        incoming messages if they arrive at a high rate. The size of this
-        buffer is define by the variable MQTT_MESSAGE_QUEUE_SIZE. If messages
-        arrive at a faster rate than they are read, older messages are dropped.
-        The maximum length of the topic and payload of MQTT messages shored in 
-        this queue if defined by the variables MQTT_TOPIC_BUFFER_LEN and 
-        MQTT_PAYLOAD_BUFFER_LEN, respectively.
-
-        This event does not produces a A76XXURC_t URC code when A76XX::listen
-        is called.
+        incoming MQTT messages sent to the device. Messages are stored in a
+        RecordQueue_t of MQTT_MESSAGE_ARENA_SIZE bytes, packed with their 
+        lengths, so that small messages take little space and large ones are
+        not truncated. The space for a message is reserved when it starts 
+        arriving, since its length is known, and the message is written there
+        directly. If there is not enough free space, e.g. because messages 
+        arrive at a faster rate than they are read, the new message is dropped,
+        so that the messages in the queue can be read in place. Alternatively, 
+        messages are streamed to a MQTTMessageSink_t, if one is set, and are
+        not queued.
+
+        The message is parsed as it arrives, i.e. the "+CMQTTRXTOPIC: ", one or
+        more "+CMQTTRXPAYLOAD: " chunks and the "+CMQTTRXEND: " URCs that follow,
+        and is only stored when complete. A message with unexpected lines is
+        dropped. The default timeout is 5000 ms, to receive large messages.
+
+        The URCs of other clients are not passed to this handler, see 
+        MQTTService_t. This event does not produces a A76XXURC_t URC code when
+        A76XX::listen is called.
 */
 class MQTTOnMessageRx : public EventHandler_t {
+  private:
+    enum Step_t {
+        START,   // the rest of the +CMQTTRXSTART line
+        LINE,    // the next URC line
+        TOPIC,   // the bytes of the topic
+        PAYLOAD  // the bytes of a chunk of the payload
+    };
+
+    Step_t                                                      _step;
+    LineReader_t                                              _reader;
+    char                                                     _line[32];
+    char                                 _topic[MQTT_TOPIC_BUFFER_LEN];
+    uint32_t                                               _remaining;
+    uint32_t                                            _topic_length;
+    uint32_t                                          _payload_length;
+    uint32_t                                           _topic_total_len;
+    uint32_t                                         _payload_total_len;
+    MQTTMessageSink_t*                                            _sink;
+    bool                                                  _sink_started;
+
+    // the queue and the space reserved for the message, NULL if dropped
+    RecordQueue_t<MQTT_MESSAGE_ARENA_SIZE>                        _queue;
+    uint8_t*                                                    _record;
+    uint32_t                                                   _dropped;
+
+    // lengths of topic and payload at the start of a record
+    static const size_t HEADER_SIZE = 2 * sizeof(uint32_t);
+
+    // start the message on the sink, once the topic is known
+    void startSink();
+
+    // process a complete line, return the state of the message
+    State_t processLine();
+
   public:
-    CircularBuffer<MQTTMessage_t, MQTT_MESSAGE_QUEUE_SIZE>  messageQueue;
-    
     MQTTOnMessageRx()
-        : EventHandler_t("+CMQTTRXSTART: ") {}
-    
-    void process(ModemSerial* serial);
+        : EventHandler_t("+CMQTTRXSTART: ", 5000)
+        , _sink(NULL)
+        , _sink_started(false)
+        , _record(NULL)
+        , _dropped(0) {}
+
+    /*
+        @brief The number of messages in the queue.
+    */
+    uint32_t available() {
+        return _queue.size();
+    }
+
+    /*
+        @brief Get the oldest message in the queue, without copying it.
+
+        @return False if the queue is empty.
+    */
+    bool peek(MQTTMessageView_t& msg);
+
+    /*
+        @brief Remove the oldest message from the queue.
+    */
+    void consume() {
+        _queue.consume();
+    }
+
+    /*
+        @brief The number of messages dropped because the queue was full.
+    */
+    uint32_t dropped() {
+        return _dropped;
+    }
+
+    /*
+        @brief The largest number of bytes of the arena used so far.
+    */
+    size_t highWaterMark() {
+        return _queue.highWaterMark();
+    }
+
+    /*
+        @brief Stream messages to a sink instead of storing them in the queue.
+
+        @param [IN] sink The sink, or NULL to use the queue.
+    */
+    void setSink(MQTTMessageSink_t* sink) {
+        _sink = sink;
+    }
+
+    void begin();
+
+    size_t feed(const char* data, size_t length, State_t& state);
+
+    void discard();
+};
+
+/*
+    @brief Function called when a message published with 
+        A76XXMQTTClient::publishNonBlocking completes, see A76XXMQTTClient::loop.
+
+    @param [IN] handle The handle returned by A76XXMQTTClient::publishNonBlocking.
+    @param [IN] result A76XX_OPERATION_SUCCEEDED if the message has been published,
+        the error code reported by the module, or A76XX_OPERATION_TIMEDOUT if
+        the module has not reported the outcome within the timeout.
+    @param [IN] context The pointer given with the callback.
+*/
+typedef void (*MQTTPublishCallback_t)(uint16_t handle, int8_t result, void* context);
+
+/*
+    @brief Handler of the URC "+CMQTTPUB", tracking the messages in flight.
+
+    @details After CMQTTPUB is accepted, the module reports the outcome of the
+        publish with "+CMQTTPUB: <client_index>,<err>", once the broker has
+        acknowledged the message or after the timeout of the command. This 
+        does not identify the message, but the outcomes of the messages of a
+        client are reported in the order they are published, so messages in 
+        flight are kept in a FIFO table of MQTT_PUBLISH_WINDOW entries and each 
+        URC completes the oldest one that has not completed yet. Completed
+        messages stay in the table until they are removed with ::next.
+
+        The URCs of other clients are not passed to this handler, see MQTTService_t.
+
+        A message is also completed with A76XX_OPERATION_TIMEDOUT if the URC
+        does not arrive within its own timeout, e.g. because it has been lost.
+        Timeouts are checked in order, from the oldest message in flight.
+*/
+class MQTTOnPublished : public EventHandler_t {
+  private:
+    struct InFlight_t {
+        uint16_t                                                  handle;
+        int8_t                                                    result;
+        uint32_t                                                  tstart;
+        uint32_t                                                 timeout;
+    };
+
+    InFlight_t                          _in_flight[MQTT_PUBLISH_WINDOW];
+    uint8_t                                                       _head;
+    uint8_t                                                      _count;
+    uint8_t                                                  _completed;
+    uint16_t                                                _next_handle;
+    LineReader_t                                                _reader;
+    char                                                       _line[16];
+
+    // complete the oldest message in flight
+    void complete(int8_t result);
+
+  public:
+    MQTTOnPublished()
+        : EventHandler_t("+CMQTTPUB: ")
+        , _head(0)
+        , _count(0)
+        , _completed(0)
+        , _next_handle(0) {}
+
+    /*
+        @brief The number of messages in the table, in flight or completed.
+    */
+    uint8_t size() {
+        return _count;
+    }
+
+    /*
+        @brief The number of messages in flight, i.e. not completed.
+    */
+    uint8_t pending() {
+        return _count - _completed;
+    }
+
+    /*
+        @brief Add a message that has been accepted by the module.
+
+        @param [IN] timeout The time in milliseconds within which the outcome
+            must be reported.
+        @return The handle of the message, never zero, or zero if the table is full.
+    */
+    uint16_t add(uint32_t timeout);
+
+    /*
+        @brief Complete with A76XX_OPERATION_TIMEDOUT the oldest messages in
+            flight whose timeout has expired.
+    */
+    void expire();
+
+    /*
+        @brief Complete all the messages in flight, e.g. with 
+            A76XX_MQTT_CONNECTION_LOST when the connection is lost.
+    */
+    void fail(int8_t result);
+
+    /*
+        @brief Remove the oldest message from the table, if completed.
+
+        @param [OUT] handle The handle of the message.
+        @param [OUT] result The outcome, see MQTTPublishCallback_t.
+        @return False if the oldest message is in flight or the table is empty.
+    */
+    bool next(uint16_t& handle, int8_t& result);
+
+    /*
+        @brief Remove the newest message from the table, once all messages have
+            completed, e.g. to wait for the outcome of a single message.
+
+        @param [OUT] result The outcome, see MQTTPublishCallback_t.
+        @return False if messages are in flight or the table is empty.
+    */
+    bool takeLast(int8_t& result);
+
+    void begin();
+
+    size_t feed(const char* data, size_t length, State_t& state);
 };
 
+/*
+    @brief Statistics of the automatic reconnections of a client, see
+        A76XXMQTTClient::setAutoReconnect. Times are in milliseconds, from the
+        reception of "+CMQTTCONNLOST" to the restored subscriptions.
+*/
+struct MQTTReconnectStats_t {
+    uint32_t                                                      losses;
+    uint32_t                                               reconnections;
+    uint32_t                                                    attempts;
+    uint32_t                                               last_recovery;
+    uint32_t                                                max_recovery;
+    uint32_t                                              total_recovery;
+};
 
 class A76XXMQTTClient : public A76XXSecureClient {
   private:
+    A76XX&                                               _modem;
     MQTTCommands                                     _mqtt_cmds;
+    MQTTService_t&                                     _service;
     const char*                                       _clientID;
     bool                                               _use_ssl;
     MQTTOnMessageRx                      _on_message_rx_handler;
-
-    // these two are set to zero by default until a use
-    // case for allowing these to change comes up
+    MQTTOnPublished                         _on_published_handler;
+    uint8_t                                         _publish_window;
+    MQTTPublishCallback_t                         _publish_callback;
+    void*                                          _publish_context;
+
+    // the subscriptions, at the index given by the trie of their filters, with 
+    // an optional handler
+    struct Subscription_t {
+        MQTTMessageHandler_t                                     handler;
+        void*                                                    context;
+        uint8_t                                                      qos;
+        bool                                                        used;
+    };
+    Subscription_t                   _subscriptions[MQTT_MAX_SUBSCRIPTIONS];
+    TopicTrie<MQTT_TOPIC_TRIE_NODES, MQTT_TOPIC_TRIE_POOL_SIZE> _topic_trie;
+    MQTTMessageHandler_t                               _default_handler;
+    void*                                              _default_context;
+
+    // allocated by the MQTT service, the SSL session has the same index
     uint8_t                                       _client_index;
     uint8_t                                         _session_id;
+    bool                                               _started;
+
+    // compression of the payloads, see ::setCompression
+    LZCompressor_t*                                 _compressor;
+    uint8_t*                                _compression_buffer;
+    uint32_t                           _compression_buffer_size;
+
+    // the arguments of the last call to ::connect or ::connectAsync
+    struct ConnectParams_t {
+        const char*                                          server_name;
+        int                                                         port;
+        bool                                               clean_session;
+        int                                                   keep_alive;
+        const char*                                             username;
+        const char*                                             password;
+        const char*                                           will_topic;
+        const char*                                         will_message;
+        int                                                     will_qos;
+    };
+    ConnectParams_t                                 _connect_params;
+
+    // state of the connection and of the reconnections, see ::setAutoReconnect
+    bool                                                   _resumed;
+    bool                                           _connection_lost;
+    uint32_t                                           _connections;
+    bool                                            _auto_reconnect;
+    const char*                                                _apn;
+    uint32_t                                           _min_backoff;
+    uint32_t                                           _max_backoff;
+    uint8_t                                            _backoff_step;
+    uint32_t                                             _lost_time;
+    uint32_t                                          _next_attempt;
+    uint32_t                                                  _prng;
+    MQTTReconnectStats_t                           _reconnect_stats;
+
+    // the payload to send, compressed if enabled and shorter
+    const uint8_t* compressPayload(const uint8_t* payload, uint32_t& length);
+
+    // call the publish callback for the messages that have completed
+    void dispatchPublished();
+
+    // set the will message, if any, and connect with _connect_params
+    int8_t connectWithParams();
+
+    // take the loss of the connection reported by the module, if any, and 
+    // fail the messages in flight
+    void checkConnectionLost();
+
+    // reconnect if the connection is lost and the next attempt is due
+    void superviseConnection();
+
+    // connect again, restarting the service and the bearer if needed, and
+    // subscribe again, or schedule the next attempt
+    bool reconnect();
+
+    // subscribe again to all the filters, with a single request
+    int8_t resubscribe();
+
+    // the slot of the handler of a filter, adding the filter to the trie if
+    // needed, or TopicTrie::NONE if there is no space
+    uint8_t reserveSubscription(const char* topic, bool& added);
+
+    // remove the handler of a filter, if any
+    void removeSubscription(const char* topic);
 
   public:
     /*
@@ -63,11 +452,24 @@ class A76XXMQTTClient : public A76XXSecureClient {
     A76XXMQTTClient(A76XX& modem, const char* clientID, bool use_ssl = false);
 
     /*
-        @brief Start the MQTT service.
+        @brief Free the client index, see MQTTService_t.
+    */
+    ~A76XXMQTTClient();
 
-        @detail Must be called before any other MQTT operations.
+    /*
+        @brief Start the MQTT service and acquire the client.
+
+        @detail Must be called before any other MQTT operations. The module 
+            supports A76XX_MQTT_MAX_CLIENTS clients, e.g. a connection for control
+            messages and one for telemetry, each constructed with the same modem.
+            Each client gets its own index when constructed, and the service is 
+            shared, see A76XX::mqttService. To use the service and the
+            connection left by a previous run of the application, call 
+            ::resume instead.
         @return True if the service was started successfully. If false, use
-            getLastError() to get detail on the error
+            getLastError() to get detail on the error. This is 
+            A76XX_MQTT_NO_FREE_CLIENT if all the client indices are used by
+            other clients.
     */
     bool begin();
 
@@ -98,6 +500,65 @@ class A76XXMQTTClient : public A76XXSecureClient {
                  const char* will_message = NULL,
                  int will_qos = 0);
 
+    /*
+        @brief Connect to the MQTT server, without waiting for the connection to
+            be established.
+
+        @details The will message, if any, is set synchronously. The connection
+            then proceeds while A76XX::poll is called. The arguments are as for
+            ::connect and the strings must stay valid until `command` completes.
+        @param [IN] command The command object, which must stay alive until it
+            completes. Use it to check the result or to set a callback.
+        @return True if the connection request has been queued. If false, use
+            getLastError() to get detail on the error.
+    */
+    bool connectAsync(AsyncMQTTConnect_t& command,
+                      const char* server_name,
+                      int port,
+                      bool clean_session,
+                      int keep_alive = 60,
+                      const char* username = NULL,
+                      const char* password = NULL,
+                      const char* will_topic = NULL,
+                      const char* will_message = NULL,
+                      int will_qos = 0);
+
+    /*
+        @brief Resume the connection left by a previous run of the application,
+            e.g. after the micro-controller wakes up from deep sleep while the
+            module stayed powered, or start the service and connect as with
+            ::begin and ::connect.
+
+        @details The state of the service and of the connections is queried with
+            a single CMQTTDISC?. If the client is still connected, it is used as
+            is, so the first message can be published right away, and ::resumed
+            returns true. The subscriptions are kept by the module and by the
+            broker, but not their handlers: subscribe again to route messages with
+            ::loop, e.g. with ::subscribeMany. Otherwise, CMQTTSTART is skipped if
+            the service is running, the client is acquired again if needed, and
+            the connection is established with the given arguments, which are
+            as for ::connect and are also used by ::setAutoReconnect.
+
+            The client index given by the MQTT service must be the one used by
+            the previous run, e.g. by constructing the clients in the same order.
+        @return True if the client is connected. If false, use getLastError() to
+            get detail on the error.
+    */
+    bool resume(const char* server_name,
+                int port,
+                bool clean_session,
+                int keep_alive = 60,
+                const char* username = NULL,
+                const char* password = NULL,
+                const char* will_topic = NULL,
+                const char* will_message = NULL,
+                int will_qos = 0);
+
+    /*
+        @brief Whether the last call to ::resume found the client connected.
+    */
+    bool resumed();
+
     /*
         @brief Disconnect from the broker.
 
@@ -108,7 +569,8 @@ class A76XXMQTTClient : public A76XXSecureClient {
     bool disconnect(uint8_t timeout = 60);
 
     /*
-        @brief Release the client and terminate the MQTT service.
+        @brief Release the client and terminate the MQTT service, unless it is
+            used by another client.
 
         @return True on success. If false, use getLastError() to get detail on the error.
     */
@@ -156,6 +618,106 @@ class A76XXMQTTClient : public A76XXSecureClient {
                  bool retained = false,
                  bool dup = false);
 
+    /*
+        @brief Publish a message, without waiting for it to be sent.
+
+        @details The arguments are as for ::publish. Topic and payload are not
+            copied and must stay valid until `command` completes, while
+            A76XX::poll is called.
+        @param [IN] command The command object, which must stay alive until it
+            completes. Use it to check the result or to set a callback.
+        @return True if the message has been queued. If false, use getLastError() 
+            to get detail on the error.
+    */
+    bool publishAsync(AsyncMQTTPublish_t& command,
+                      const char* topic,
+                      const uint8_t* payload,
+                      uint32_t length,
+                      uint8_t qos,
+                      uint8_t pub_timeout,
+                      bool retained = false,
+                      bool dup = false);
+
+    /*
+        @brief Publish a message, without waiting for the broker to acknowledge it.
+
+        @details The topic and the payload are sent to the module as in ::publish,
+            which takes a few round trips on the UART, but the function returns
+            as soon as the module has accepted the message, instead of waiting
+            for the outcome, which can take hundreds of milliseconds on a cellular
+            link. Up to ::setPublishWindow messages can be in flight at the same
+            time. Their outcome is passed to the callback set with ::onPublished,
+            from ::loop. The topic and the payload are copied by the module, so 
+            they can be reused right away.
+
+            The outcome of a message is not identified by the module, but it is
+            reported in order, see MQTTOnPublished. ::publish tracks its message
+            in the same way, so it can be called with messages in flight, but
+            ::publishAsync cannot.
+        @param [IN] timeout The time in milliseconds after which the message is
+            completed with A76XX_OPERATION_TIMEDOUT, if the module has not reported
+            its outcome. It should be longer than `pub_timeout`, after which the 
+            module reports the failure itself. The default, zero, is `pub_timeout`
+            plus A76XX_EVENT_HANDLER_TIMEOUT.
+        @return A handle to the message, passed to the callback, or zero on failure.
+            getLastError() returns A76XX_MQTT_WINDOW_FULL if the maximum number of 
+            messages are in flight, in which case call ::loop and try again.
+    */
+    uint16_t publishNonBlocking(const char* topic,
+                                const uint8_t* payload,
+                                uint32_t length,
+                                uint8_t qos,
+                                uint8_t pub_timeout,
+                                bool retained = false,
+                                bool dup = false,
+                                uint32_t timeout = 0);
+
+    /*
+        @brief Set the maximum number of messages in flight, see ::publishNonBlocking.
+
+        @param [IN] size The size of the window, from 1 to MQTT_PUBLISH_WINDOW, 
+            which is also the default.
+    */
+    void setPublishWindow(uint8_t size);
+
+    /*
+        @brief Compress the payload of the messages published from now on with
+            ::publish and ::publishNonBlocking.
+
+        @details Payloads are compressed with LZCompressor_t into `buffer` and
+            sent compressed only if shorter, so receivers must check each
+            message with lzIsCompressed and decompress it with lzDecompress
+            or LZDecoder_t. Payloads that do not compress, e.g. short ones,
+            are sent unchanged.
+        @param [IN] compressor The compressor, or NULL to disable compression,
+            which is the default.
+        @param [IN] buffer The buffer for the compressed payload, which limits
+            the length of the payloads that are compressed.
+        @param [IN] size The size of the buffer.
+    */
+    void setCompression(LZCompressor_t* compressor, uint8_t* buffer, uint32_t size);
+
+    /*
+        @brief Set the function called by ::loop when a message published with
+            ::publishNonBlocking completes.
+    */
+    void onPublished(MQTTPublishCallback_t callback, void* context = NULL);
+
+    /*
+        @brief The number of messages published with ::publishNonBlocking whose 
+            outcome has not been dispatched yet.
+    */
+    uint8_t publishesInFlight();
+
+    /*
+        @brief Process data from the module until all messages published with
+            ::publishNonBlocking have completed, dispatching their outcome.
+
+        @param [IN] timeout The maximum time to wait in milliseconds.
+        @return True if no messages are in flight.
+    */
+    bool waitPublished(uint32_t timeout);
+
     /*
         @brief Subscribe to a topic.
 
@@ -165,6 +727,97 @@ class A76XXMQTTClient : public A76XXSecureClient {
     */
     bool subscribe(const char* topic, uint8_t qos = 0);
 
+    /*
+        @brief Subscribe to a topic and route the messages received on it to a handler.
+
+        @details Messages are dispatched by ::loop. The topic filters of all the
+            subscriptions with a handler are stored in a trie, so that the cost of
+            routing a message depends on the depth of its topic, not on the number
+            of subscriptions. A message matching several filters, e.g. "a/+" and 
+            "a/#", is passed to each of their handlers. Subscribing again to the 
+            same filter replaces its handler. See MQTT_MAX_SUBSCRIPTIONS,
+            MQTT_TOPIC_TRIE_NODES and MQTT_TOPIC_TRIE_POOL_SIZE.
+        @param [IN] topic The topic filter, which can include the '+' and '#' wildcards.
+        @param [IN] qos The quality of service of the subscription.
+        @param [IN] handler The function called with the messages.
+        @param [IN] context A pointer passed to the handler, e.g. an object.
+        @return True on successful subscription. On failure, getLastError() returns
+            A76XX_OUT_OF_MEMORY if the handler cannot be stored.
+    */
+    bool subscribe(const char* topic, uint8_t qos, MQTTMessageHandler_t handler, void* context = NULL);
+
+    /*
+        @brief Subscribe to several topics with a single request to the broker.
+
+        @details The topics are set one by one with CMQTTSUBTOPIC, which only
+            involves the module, then a single CMQTTSUB subscribes to all of them,
+            so that the time taken by the broker round trip is paid only once, 
+            e.g. when subscriptions are restored after a reconnection. If a 
+            topic is not accepted, no subscription is made, but the topics set 
+            before it may stay pending in the module until the next call.
+        @param [IN] topics The topic filters.
+        @param [IN] count The number of topics.
+        @param [IN] qos The quality of service of the subscriptions.
+        @param [IN] handler An optional function called with the messages received
+            on any of the topics, see ::subscribe.
+        @param [IN] context A pointer passed to the handler.
+        @return True on successful subscription. On failure, getLastError() returns
+            A76XX_OUT_OF_MEMORY if the handlers cannot be stored.
+    */
+    bool subscribeMany(const char* const topics[], uint8_t count, uint8_t qos = 0,
+                       MQTTMessageHandler_t handler = NULL, void* context = NULL);
+
+    /*
+        @brief Unsubscribe from a topic, and remove its handler, if any.
+
+        @param [IN] topic The topic filter, as given to ::subscribe.
+        @return True on success. If false, use getLastError() to get detail on the error.
+    */
+    bool unsubscribe(const char* topic);
+
+    /*
+        @brief Unsubscribe from several topics with a single request to the broker,
+            with CMQTTUNSUBTOPIC and CMQTTUNSUB, see ::subscribeMany.
+
+        @param [IN] topics The topic filters.
+        @param [IN] count The number of topics.
+        @return True on success. If false, use getLastError() to get detail on the error.
+    */
+    bool unsubscribeMany(const char* const topics[], uint8_t count);
+
+    /*
+        @brief Set the handler of the messages that match no subscription with a 
+            handler, when dispatched by ::loop. Without it, these messages are dropped.
+    */
+    void onMessage(MQTTMessageHandler_t handler, void* context = NULL);
+
+    /*
+        @brief Process data from the module and dispatch the messages received to
+            the handlers of the subscriptions.
+
+        @details Call this function frequently, e.g. from `loop`, instead of reading 
+            messages with ::getMessage or ::peekMessage. It calls ModemSerial::poll,
+            then passes every message in the queue to the handlers of the filters
+            matching its topic, or to the handler set with ::onMessage, and removes
+            it from the queue. Handlers can send commands, e.g. to publish a reply.
+            The outcome of the messages published with ::publishNonBlocking is 
+            also passed to the callback set with ::onPublished.
+            Messages streamed to a sink, see ::setMessageSink, are not dispatched.
+    */
+    void loop();
+
+    /*
+        @brief Stream received messages to a sink, instead of storing them in
+            the queue read with ::getMessage.
+
+        @details With a sink, the payload is passed to it in chunks as it is
+            received, so that it is not truncated to MQTT_PAYLOAD_BUFFER_LEN. Set
+            the sink when no message is being received, e.g. before subscribing.
+        @param [IN] sink The sink, which must stay alive while set, or NULL to go
+            back to the queue.
+    */
+    void setMessageSink(MQTTMessageSink_t* sink);
+
     /*
         @brief Check if messages have been received.
 
@@ -173,20 +826,101 @@ class A76XXMQTTClient : public A76XXSecureClient {
     uint32_t messageAvailable();
 
     /*
-        @brief Get last message received.
+        @brief Get the oldest message received, without removing it from the queue
+            and without copying it.
+
+        @param [OUT] msg A view of the message, valid until ::consumeMessage.
+        @return False if no messages are available.
+    */
+    bool peekMessage(MQTTMessageView_t& msg);
+
+    /*
+        @brief Remove the oldest message from the queue, e.g. after ::peekMessage.
+    */
+    void consumeMessage();
+
+    /*
+        @brief Get the oldest message received and remove it from the queue.
 
         @details You should only call this function if the result of calling
             A76XXMQTTClient::messageAvailable is greater than zero. The result of 
             calling this function when no messages are available is undetermined.
+            Topic and payload are copied and truncated to MQTT_TOPIC_BUFFER_LEN
+            and MQTT_PAYLOAD_BUFFER_LEN, use ::peekMessage to avoid that.
 
         @return A MQTTMessage_t object, with fields `topic` and `payload`.
     */
     MQTTMessage_t getMessage();
 
+    /*
+        @brief Get the number of messages dropped because the queue was full.
+    */
+    uint32_t messagesDropped();
+
+    /*
+        @brief Get the largest number of bytes of the message queue used so far,
+            to size MQTT_MESSAGE_ARENA_SIZE.
+    */
+    size_t messageQueueHighWaterMark();
+
     /*
         @brief Check if the connection with the broker is active or not.
     */
     bool isConnected();
+
+    /*
+        @brief Reconnect automatically when the connection to the broker is lost.
+
+        @details The module reports the loss with "+CMQTTCONNLOST", which is
+            seen as soon as data is processed, e.g. by ::loop or while a message
+            is published. The messages in flight then complete with
+            A76XX_MQTT_CONNECTION_LOST, and so do the messages published until
+            the connection is restored, instead of waiting for their timeout.
+
+            ::loop then connects again with the arguments of the last call to
+            ::connect or ::connectAsync, whose strings must stay valid. If that
+            fails, the PDP context is activated again with `apn` if given and
+            down, the MQTT service is started again and the client acquired
+            again, before another attempt. The subscriptions are then restored
+            with a single request, see ::subscribeMany, and the messages waiting
+            in an A76XXMQTTOutbox are sent again. Subscriptions whose filter
+            could not be stored, see MQTT_MAX_SUBSCRIPTIONS, are not restored.
+
+            The first attempt is immediate. After a failure, the next one is
+            delayed by `min_backoff`, doubled after each failure up to
+            `max_backoff`, with a random jitter of up to half the delay, so that
+            devices losing the connection at the same time do not reconnect at
+            the same time. Each attempt blocks ::loop for up to the timeout of 
+            the commands involved, i.e. a few seconds.
+        @param [IN] enable Whether to reconnect, which is disabled by default.
+        @param [IN] apn The access point name used to activate the PDP context,
+            or NULL to leave the bearer to the application.
+        @param [IN] min_backoff The delay after the first failed attempt, in ms.
+        @param [IN] max_backoff The maximum delay between attempts, in ms.
+    */
+    void setAutoReconnect(bool enable,
+                          const char* apn = NULL,
+                          uint32_t min_backoff = 1000,
+                          uint32_t max_backoff = 60000);
+
+    /*
+        @brief Whether the loss of the connection has been reported by the module
+            and the connection has not been established again, without sending
+            commands, unlike ::isConnected.
+    */
+    bool connectionLost();
+
+    /*
+        @brief The number of times the connection has been established, by
+            ::connect or by the automatic reconnection, e.g. to find out that
+            the client has reconnected.
+    */
+    uint32_t connections();
+
+    /*
+        @brief Get the statistics of the automatic reconnections.
+    */
+    MQTTReconnectStats_t getReconnectStats();
 };
 
 #endif A76XX_MQTT_CLIENT_H_
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include "A76XX.h"
+
+A76XXMQTTOutbox::A76XXMQTTOutbox(A76XXMQTTClient& client, OutboxStorage_t& storage, uint8_t pub_timeout)
+    : _client(client)
+    , _storage(storage)
+    , _pub_timeout(pub_timeout)
+    , _last_error_code(0)
+    , _log_size(0)
+    , _head(0)
+    , _tail(0)
+    , _count(0)
+    , _generation(0)
+    , _markers_dirty(false)
+    , _send(0)
+    , _unsent(0)
+    , _resend(0)
+    , _paused(false)
+    , _pause_time(0)
+    , _connections(client.connections())
+    , _in_flight_head(0)
+    , _in_flight_count(0)
+    , _corrupted(0) {}
+
+bool A76XXMQTTOutbox::begin() {
+    _log_size = _storage.size() > LOG_START ? _storage.size() - LOG_START : 0;
+    if (_log_size < recordSize(1)) {
+        _last_error_code = A76XX_OUT_OF_MEMORY;
+        return false;
+    }
+
+    // the most recent valid copy of the markers
+    bool found = false;
+    for (uint8_t slot = 0; slot < 2; slot++) {
+        Markers_t markers;
+        if (_storage.read(slot * SLOT_SIZE, reinterpret_cast<uint8_t*>(&markers), sizeof(markers)) == false ||
+            markers.magic != MARKERS_MAGIC ||
+            markers.crc != outboxCRC32(reinterpret_cast<uint8_t*>(&markers), offsetof(Markers_t, crc)) ||
+            markers.head >= _log_size || markers.tail >= _log_size ||
+            (found && markers.generation < _generation)) {
+            continue;
+        }
+        found       = true;
+        _generation = markers.generation;
+        _head       = markers.head;
+        _tail       = markers.tail;
+        _count      = markers.count;
+    }
+
+    if (found == false) {
+        _generation = 0;
+        _head       = 0;
+        _tail       = 0;
+        _count      = 0;
+        if (writeMarkers() == false) {
+            _last_error_code = A76XX_GENERIC_ERROR;
+            return false;
+        }
+    }
+
+    _send            = _head;
+    _unsent          = _count;
+    _resend          = 0;
+    _paused          = false;
+    _in_flight_count = 0;
+    _client.onPublished(onPublished, this);
+    return true;
+}
+
+bool A76XXMQTTOutbox::publish(const char* topic,
+                              const uint8_t* payload,
+                              uint32_t length,
+                              uint8_t qos,
+                              bool retained) {
+    size_t topic_length = strlen(topic);
+    if (topic_length + 1 + length > MQTT_OUTBOX_MAX_MESSAGE_SIZE) {
+        _last_error_code = A76XX_OUT_OF_MEMORY;
+        return false;
+    }
+
+    // an empty log starts again from the start of the storage
+    if (_count == 0) {
+        _head = _tail = _send = 0;
+    }
+
+    // a record that does not fit before the end is written at the start
+    uint32_t size = recordSize(topic_length + 1 + length);
+    uint32_t pad  = _tail + size > _log_size ? _log_size - _tail : 0;
+    if (used() + pad + size > _log_size) {
+        _last_error_code = A76XX_OUT_OF_MEMORY;
+        return false;
+    }
+
+    RecordHeader_t header;
+    if (pad >= sizeof(header)) {
+        header.magic = PAD_MAGIC;
+        if (_storage.write(LOG_START + _tail, reinterpret_cast<uint8_t*>(&header), sizeof(header)) == false) {
+            _last_error_code = A76XX_GENERIC_ERROR;
+            return false;
+        }
+    }
+    uint32_t offset = pad > 0 ? 0 : _tail;
+
+    header.magic          = RECORD_MAGIC;
+    header.qos            = qos;
+    header.retained       = retained ? 1 : 0;
+    header.topic_length   = topic_length;
+    header.payload_length = length;
+    header.crc            = 0;
+    uint32_t crc = outboxCRC32(reinterpret_cast<uint8_t*>(&header), sizeof(header));
+    crc = outboxCRC32(reinterpret_cast<const uint8_t*>(topic), topic_length + 1, crc);
+    header.crc = outboxCRC32(payload, length, crc);
+
+    // the record must be durable before the markers point to it
+    uint32_t at = LOG_START + offset;
+    if (_storage.write(at, reinterpret_cast<uint8_t*>(&header), sizeof(header)) == false ||
+        _storage.write(at + sizeof(header), reinterpret_cast<const uint8_t*>(topic), topic_length + 1) == false ||
+        _storage.write(at + sizeof(header) + topic_length + 1, payload, length) == false ||
+        _storage.sync() == false) {
+        _last_error_code = A76XX_GENERIC_ERROR;
+        return false;
+    }
+
+    _tail = (offset + size) % _log_size;
+    _count++;
+    _unsent++;
+    if (writeMarkers() == false) {
+        _last_error_code = A76XX_GENERIC_ERROR;
+        return false;
+    }
+    return true;
+}
+
+bool A76XXMQTTOutbox::publish(const char* topic,
+                              const char* payload,
+                              uint8_t qos,
+                              bool retained) {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload), strlen(payload), qos, retained);
+}
+
+void A76XXMQTTOutbox::loop() {
+    _client.loop();
+    advance();
+
+    // send right away after the client has reconnected
+    if (_client.connections() != _connections) {
+        _connections = _client.connections();
+        _paused = false;
+    }
+
+    if (_paused && millis() - _pause_time < MQTT_OUTBOX_RETRY_INTERVAL) {
+        return;
+    }
+    _paused = false;
+
+    while (_unsent > 0 && _in_flight_count < MQTT_PUBLISH_WINDOW && sendNext()) {}
+    advance();
+}
+
+void A76XXMQTTOutbox::resume() {
+    _paused = false;
+}
+
+uint32_t A76XXMQTTOutbox::pending() {
+    return _count;
+}
+
+uint32_t A76XXMQTTOutbox::bytesUsed() {
+    return used();
+}
+
+uint32_t A76XXMQTTOutbox::corrupted() {
+    return _corrupted;
+}
+
+int8_t A76XXMQTTOutbox::getLastError() {
+    return _last_error_code;
+}
+
+void A76XXMQTTOutbox::onPublished(uint16_t handle, int8_t result, void* context) {
+    A76XXMQTTOutbox* outbox = static_cast<A76XXMQTTOutbox*>(context);
+    for (uint8_t i = 0; i < outbox->_in_flight_count; i++) {
+        InFlight_t& entry = outbox->_in_flight[(outbox->_in_flight_head + i) % MQTT_PUBLISH_WINDOW];
+        if (entry.handle == handle && entry.state == IN_FLIGHT) {
+            entry.state = result == A76XX_OPERATION_SUCCEEDED ? DELIVERED : FAILED;
+            return;
+        }
+    }
+}
+
+uint32_t A76XXMQTTOutbox::used() {
+    if (_count == 0) {
+        return 0;
+    }
+    return _tail > _head ? _tail - _head : _log_size - _head + _tail;
+}
+
+uint32_t A76XXMQTTOutbox::skipPadding(uint32_t offset) {
+    if (_log_size - offset < sizeof(RecordHeader_t)) {
+        return 0;
+    }
+    uint16_t magic;
+    if (_storage.read(LOG_START + offset, reinterpret_cast<uint8_t*>(&magic), sizeof(magic)) && 
+        magic == PAD_MAGIC) {
+        return 0;
+    }
+    return offset;
+}
+
+bool A76XXMQTTOutbox::writeMarkers() {
+    Markers_t markers;
+    markers.magic      = MARKERS_MAGIC;
+    markers.generation = ++_generation;
+    markers.head       = _head;
+    markers.tail       = _tail;
+    markers.count      = _count;
+    markers.crc        = outboxCRC32(reinterpret_cast<uint8_t*>(&markers), offsetof(Markers_t, crc));
+
+    // the other copy is still valid if this write is interrupted
+    uint32_t slot = _generation % 2;
+    _markers_dirty = _storage.write(slot * SLOT_SIZE, reinterpret_cast<uint8_t*>(&markers), sizeof(markers)) == false ||
+                     _storage.sync() == false;
+    return _markers_dirty == false;
+}
+
+void A76XXMQTTOutbox::advance() {
+    bool changed = false;
+    while (_in_flight_count > 0) {
+        InFlight_t& entry = _in_flight[_in_flight_head];
+        if (entry.state == IN_FLIGHT) {
+            break;
+        }
+        if (entry.state == FAILED) {
+            // the messages sent after it might have been delivered, but are sent again
+            _resend          = _count - _unsent;
+            _send            = _head;
+            _unsent          = _count;
+            _in_flight_count = 0;
+            _paused          = true;
+            _pause_time      = millis();
+            break;
+        }
+        _head = (skipPadding(_head) + entry.size) % _log_size;
+        _count--;
+        _in_flight_head = (_in_flight_head + 1) % MQTT_PUBLISH_WINDOW;
+        _in_flight_count--;
+        changed = true;
+    }
+
+    if (changed || _markers_dirty) {
+        writeMarkers();
+    }
+}
+
+bool A76XXMQTTOutbox::sendNext() {
+    uint32_t offset = skipPadding(_send);
+
+    RecordHeader_t header;
+    header.magic = 0;
+    uint32_t length = 0;
+    if (_storage.read(LOG_START + offset, reinterpret_cast<uint8_t*>(&header), sizeof(header))) {
+        length = header.topic_length + 1 + header.payload_length;
+    }
+    if (header.magic != RECORD_MAGIC || length > MQTT_OUTBOX_MAX_MESSAGE_SIZE ||
+        offset + recordSize(length) > _log_size) {
+        // the rest of the log cannot be parsed and is dropped
+        _corrupted += _unsent;
+        _count     -= _unsent;
+        _unsent     = 0;
+        _tail       = offset;
+        _markers_dirty = true;
+        return false;
+    }
+    uint32_t size = recordSize(length);
+
+    uint32_t crc = header.crc;
+    header.crc = 0;
+    bool valid = _storage.read(LOG_START + offset + sizeof(header), _buffer, length) &&
+                 _buffer[header.topic_length] == '\0' &&
+                 crc == outboxCRC32(_buffer, length, outboxCRC32(reinterpret_cast<uint8_t*>(&header), sizeof(header)));
+
+    InFlight_t& entry = _in_flight[(_in_flight_head + _in_flight_count) % MQTT_PUBLISH_WINDOW];
+    entry.handle = 0;
+    entry.size   = size;
+    entry.state  = DELIVERED;
+    if (valid == false) {
+        // dropped as if delivered
+        _corrupted++;
+    } else {
+        entry.handle = _client.publishNonBlocking(reinterpret_cast<const char*>(_buffer),
+                                                  _buffer + header.topic_length + 1,
+                                                  header.payload_length,
+                                                  header.qos,
+                                                  _pub_timeout,
+                                                  header.retained == 1,
+                                                  _resend > 0 && header.qos > 0);
+        if (entry.handle == 0) {
+            // try again later, unless waiting for messages in flight
+            if (_client.getLastError() != A76XX_MQTT_WINDOW_FULL) {
+                _paused     = true;
+                _pause_time = millis();
+            }
+            return false;
+        }
+        // messages with QoS 0 are not acknowledged by the broker
+        entry.state = header.qos == 0 ? DELIVERED : IN_FLIGHT;
+    }
+
+    _in_flight_count++;
+    _send = (offset + size) % _log_size;
+    _unsent--;
+    _resend -= _resend > 0 ? 1 : 0;
+    return true;
+}
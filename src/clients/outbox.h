@@ -0,0 +1,211 @@
+#ifndef A76XX_MQTT_OUTBOX_H_
+#define A76XX_MQTT_OUTBOX_H_
+
+/*
+    @brief Store-and-forward outbox for MQTT messages.
+
+    @details Messages are appended to a log in an OutboxStorage_t, e.g. in RAM or
+        in a file, and ::publish returns without waiting for the network, so
+        that messages are neither lost nor block the application while the
+        connection to the broker is down. ::loop sends them in order, with up to
+        MQTT_PUBLISH_WINDOW messages in flight, see
+        A76XXMQTTClient::publishNonBlocking, and removes them from the log when
+        delivered: messages with QoS 0 when accepted by the module, the others
+        when acknowledged by the broker. When a message cannot be sent or is
+        not acknowledged, sending starts again from the oldest message in the
+        log after MQTT_OUTBOX_RETRY_INTERVAL, so delivery is at least once, and
+        messages sent again have the dup flag set.
+
+        The log is a ring of records, each with a CRC, after two copies of the
+        head and tail markers, which are written alternately, each with a CRC
+        and a generation number. Records are written before the markers point
+        to them, so after a power loss the outbox is restored by ::begin to the
+        last consistent state: messages being appended are lost and messages
+        delivered since the markers were last written are sent again. Markers
+        are written when messages are appended and at most once per call to
+        ::loop when messages are delivered, to limit the wear of flash storage.
+
+        The outbox sets the callback of A76XXMQTTClient::onPublished.
+*/
+class A76XXMQTTOutbox {
+  private:
+    // copies of the markers at the start of the storage
+    struct Markers_t {
+        uint32_t                                                   magic;
+        uint32_t                                              generation;
+        uint32_t                                                    head;
+        uint32_t                                                    tail;
+        uint32_t                                                   count;
+        uint32_t                                                     crc;
+    };
+
+    // header of the records, followed by the topic, a NULL character and the payload
+    struct RecordHeader_t {
+        uint16_t                                                   magic;
+        uint8_t                                                      qos;
+        uint8_t                                                 retained;
+        uint16_t                                            topic_length;
+        uint16_t                                          payload_length;
+        uint32_t                                                     crc;
+    };
+
+    // a message sent and not yet removed from the log
+    enum State_t {
+        IN_FLIGHT,
+        DELIVERED,
+        FAILED
+    };
+
+    struct InFlight_t {
+        uint16_t                                                  handle;
+        uint32_t                                                    size;
+        State_t                                                    state;
+    };
+
+    static const uint32_t MARKERS_MAGIC = 0x584F424D;
+    static const uint16_t RECORD_MAGIC  = 0x4D52;
+    static const uint16_t PAD_MAGIC     = 0x4450;
+    static const uint32_t SLOT_SIZE     = 32;
+    static const uint32_t LOG_START     = 2 * SLOT_SIZE;
+
+    A76XXMQTTClient&                                             _client;
+    OutboxStorage_t&                                            _storage;
+    uint8_t                                                 _pub_timeout;
+    int8_t                                              _last_error_code;
+
+    // the log, offsets are from LOG_START
+    uint32_t                                                   _log_size;
+    uint32_t                                                       _head;
+    uint32_t                                                       _tail;
+    uint32_t                                                      _count;
+    uint32_t                                                 _generation;
+    bool                                                  _markers_dirty;
+
+    // the next record to send and the number of records from there to the tail
+    uint32_t                                                       _send;
+    uint32_t                                                     _unsent;
+
+    // the number of records to send again, with the dup flag
+    uint32_t                                                     _resend;
+
+    // sending is paused for MQTT_OUTBOX_RETRY_INTERVAL after a failure
+    bool                                                         _paused;
+    uint32_t                                                 _pause_time;
+
+    // the value of A76XXMQTTClient::connections when last seen
+    uint32_t                                                _connections;
+
+    InFlight_t                               _in_flight[MQTT_PUBLISH_WINDOW];
+    uint8_t                                              _in_flight_head;
+    uint8_t                                             _in_flight_count;
+    uint32_t                                                  _corrupted;
+    uint8_t                                _buffer[MQTT_OUTBOX_MAX_MESSAGE_SIZE];
+
+    static void onPublished(uint16_t handle, int8_t result, void* context);
+
+    static uint32_t recordSize(uint32_t length) {
+        return (sizeof(RecordHeader_t) + length + 3) / 4 * 4;
+    }
+
+    uint32_t used();
+
+    // the offset of the record at `offset`, which is the start of the log after
+    // the last record before the end
+    uint32_t skipPadding(uint32_t offset);
+
+    bool writeMarkers();
+
+    // remove the delivered messages from the log, or start again from the head
+    // if a message has failed
+    void advance();
+
+    // send the next record, return false if it cannot be sent now
+    bool sendNext();
+
+  public:
+    /*
+        @brief Construct an outbox.
+
+        @param [IN] client The client used to send the messages, which must be
+            connected separately, and reconnected if the connection is lost, 
+            e.g. with A76XXMQTTClient::setAutoReconnect. Sending resumes as 
+            soon as the client has reconnected.
+        @param [IN] storage The storage of the messages, e.g. an OutboxRAMStorage_t
+            or an OutboxFileStorage_t, with room for at least a few messages
+            after 64 bytes of markers.
+        @param [IN] pub_timeout The timeout of the publish command, in seconds.
+    */
+    A76XXMQTTOutbox(A76XXMQTTClient& client, OutboxStorage_t& storage, uint8_t pub_timeout = 30);
+
+    /*
+        @brief Restore the messages in the storage, or initialise it if it holds
+            no valid markers.
+
+        @return True on success. If false, the storage cannot be written.
+    */
+    bool begin();
+
+    /*
+        @brief Append a message to the outbox.
+
+        @param [IN] topic The message topic.
+        @param [IN] payload The message.
+        @param [IN] length The length of the message.
+        @param [IN] qos The quality of service of the message: 0, 1 or 2.
+        @param [IN] retained The retain flag of the message.
+        @return True if the message has been stored. If false, getLastError()
+            returns A76XX_OUT_OF_MEMORY if the outbox is full or if the topic,
+            the payload and a NULL character exceed MQTT_OUTBOX_MAX_MESSAGE_SIZE,
+            or A76XX_GENERIC_ERROR if the storage cannot be written.
+    */
+    bool publish(const char* topic,
+                 const uint8_t* payload,
+                 uint32_t length,
+                 uint8_t qos,
+                 bool retained = false);
+
+    /*
+        @brief Append a message to the outbox, with a payload given as a string.
+    */
+    bool publish(const char* topic,
+                 const char* payload,
+                 uint8_t qos,
+                 bool retained = false);
+
+    /*
+        @brief Send the messages in the outbox and process the acknowledgements.
+
+        @details Call this function frequently, instead of A76XXMQTTClient::loop,
+            which it calls.
+    */
+    void loop();
+
+    /*
+        @brief Send messages at the next call to ::loop, without waiting for
+            MQTT_OUTBOX_RETRY_INTERVAL after a failure, e.g. after reconnecting
+            with a client other than the one of the outbox.
+    */
+    void resume();
+
+    /*
+        @brief The number of messages in the outbox, including those in flight.
+    */
+    uint32_t pending();
+
+    /*
+        @brief The number of bytes of the storage used by the messages.
+    */
+    uint32_t bytesUsed();
+
+    /*
+        @brief The number of messages dropped because their record was corrupted.
+    */
+    uint32_t corrupted();
+
+    /*
+        @brief Get the last error.
+    */
+    int8_t getLastError();
+};
+
+#endif A76XX_MQTT_OUTBOX_H_
@@ -78,13 +78,12 @@ bool A76XXSecureClient::setCerts(const char* cacertname,
 bool A76XXSecureClient::configSSL(uint8_t  sslversion,
                                 uint8_t  ignorelocaltime,
                                 uint16_t negotiatetime) {
-    int8_t retcode = _ssl_cmds.configSSLSSLversion(_ssl_ctx_index, sslversion);
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
-
-    retcode = _ssl_cmds.configSSLIgnorelocaltime(_ssl_ctx_index, ignorelocaltime);
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    CommandBatch_t batch;
+    _ssl_cmds.configSSLSSLversion(batch, _ssl_ctx_index, sslversion);
+    _ssl_cmds.configSSLIgnorelocaltime(batch, _ssl_ctx_index, ignorelocaltime);
+    _ssl_cmds.configSSLNegotiatetime(batch, _ssl_ctx_index, negotiatetime);
 
-    retcode = _ssl_cmds.configSSLNegotiatetime(_ssl_ctx_index, negotiatetime);
+    int8_t retcode = _serial.sendBatch(batch, true);
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
 
     return true;
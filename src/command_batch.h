@@ -0,0 +1,152 @@
+#ifndef A76XX_COMMANDBATCH_H_
+#define A76XX_COMMANDBATCH_H_
+
+/*
+    @brief A sequence of AT commands executed with a single call to
+        ModemSerial::sendBatch.
+
+    @details Commands are added with ::add, with the same arguments as
+        ModemSerial::sendCMD preceded by a timeout, or with the overloads of the
+        command functions that take a batch, e.g. SSLCommands::configSSLSSLversion.
+        They are formatted immediately into a buffer of size A76XX_BATCH_BUFFER_SIZE,
+        so the arguments need not outlive the call.
+
+        Only commands whose complete response is OK or ERROR can be batched, i.e.
+        setters. After execution, the result of each command is available from
+        ::result. Commands following a failed one are not executed and their
+        result is A76XX_COMMAND_NOT_EXECUTED.
+*/
+class CommandBatch_t {
+  friend class ModemSerial;
+
+  private:
+    char                _buffer[A76XX_BATCH_BUFFER_SIZE];
+    uint16_t                                    _length;
+
+    // start of each command in the buffer, as a NULL terminated string
+    uint16_t          _offsets[A76XX_BATCH_MAX_COMMANDS];
+    uint32_t         _timeouts[A76XX_BATCH_MAX_COMMANDS];
+    int8_t            _results[A76XX_BATCH_MAX_COMMANDS];
+    uint8_t                                      _count;
+
+    // set if a command did not fit and was dropped
+    bool                                      _overflow;
+
+    // append to the command being added, return false if it does not fit
+    bool append(const char* str, size_t length) {
+        if (_length + length >= A76XX_BATCH_BUFFER_SIZE) {
+            return false;
+        }
+        memcpy(_buffer + _length, str, length);
+        _length += length;
+        return true;
+    }
+
+    bool append(const char* str) {
+        return str == NULL ? true : append(str, strlen(str));
+    }
+
+    bool append(char c) {
+        return append(&c, 1);
+    }
+
+    // integers are formatted in decimal, as in ModemSerial::sendCMD
+    bool append(unsigned long value) {
+        char digits[20];
+        uint8_t i = sizeof(digits);
+        do {
+            digits[--i] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        return append(digits + i, sizeof(digits) - i);
+    }
+
+    bool append(long value) {
+        if (value < 0) {
+            return append('-') && append(0UL - static_cast<unsigned long>(value));
+        }
+        return append(static_cast<unsigned long>(value));
+    }
+
+    bool append(bool value)           { return append(value ? '1' : '0'); }
+    bool append(signed char value)    { return append(static_cast<long>(value)); }
+    bool append(unsigned char value)  { return append(static_cast<unsigned long>(value)); }
+    bool append(short value)          { return append(static_cast<long>(value)); }
+    bool append(unsigned short value) { return append(static_cast<unsigned long>(value)); }
+    bool append(int value)            { return append(static_cast<long>(value)); }
+    bool append(unsigned int value)   { return append(static_cast<unsigned long>(value)); }
+
+    template <typename HEAD, typename... TAIL>
+    bool appendAll(HEAD head, TAIL... tail) {
+        return append(head) && appendAll(tail...);
+    }
+
+    bool appendAll() {
+        // terminate the command
+        return append("", 1);
+    }
+
+  public:
+    CommandBatch_t() {
+        clear();
+    }
+
+    /*
+        @brief Add a command to the batch.
+
+        @param [IN] timeout Time out in milliseconds for the response to this command.
+        @param [IN] args The parts of the command, as for ModemSerial::sendCMD,
+            starting with "AT" and without the terminating "\r\n".
+        @return False if the command does not fit in the batch. The batch is then
+            marked as overflown and ModemSerial::sendBatch does not execute it.
+    */
+    template <typename... ARGS>
+    bool add(uint32_t timeout, ARGS... args) {
+        uint16_t start = _length;
+        if (_overflow || _count == A76XX_BATCH_MAX_COMMANDS || appendAll(args...) == false) {
+            _length   = start;
+            _overflow = true;
+            return false;
+        }
+        _offsets[_count]  = start;
+        _timeouts[_count] = timeout;
+        _results[_count]  = A76XX_COMMAND_NOT_EXECUTED;
+        _count++;
+        return true;
+    }
+
+    /*
+        @brief Remove all commands, so that the object can be reused.
+    */
+    void clear() {
+        _length   = 0;
+        _count    = 0;
+        _overflow = false;
+    }
+
+    /*
+        @brief The number of commands in the batch.
+    */
+    uint8_t size() const {
+        return _count;
+    }
+
+    /*
+        @brief The text of a command, without the terminating "\r\n".
+    */
+    const char* command(uint8_t index) const {
+        return _buffer + _offsets[index];
+    }
+
+    /*
+        @brief The result of a command after execution.
+
+        @return A76XX_OPERATION_SUCCEEDED, A76XX_OPERATION_TIMEDOUT, A76XX_GENERIC_ERROR
+            or A76XX_COMMAND_NOT_EXECUTED.
+    */
+    int8_t result(uint8_t index) const {
+        return _results[index];
+    }
+};
+
+#endif A76XX_COMMANDBATCH_H_
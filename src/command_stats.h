@@ -0,0 +1,293 @@
+#ifndef A76XX_COMMANDSTATS_H_
+#define A76XX_COMMANDSTATS_H_
+
+// number of buckets of the latency histogram, the last one is for latencies
+// of 2^(A76XX_STATS_NUM_BUCKETS - 2) ms or longer, i.e. about 131 s
+#define A76XX_STATS_NUM_BUCKETS 18
+
+/*
+    @brief Statistics of all the commands sharing the same prefix.
+*/
+struct CommandStatsEntry_t {
+    // command prefix, e.g. "AT+HTTPPARA", up to the first '=' or '?'
+    char        prefix[A76XX_STATS_PREFIX_LENGTH + 1];
+    uint32_t    calls;
+    uint32_t    bytes_sent;
+    uint32_t    bytes_received;
+    uint16_t    timeouts;
+    uint16_t    errors;
+
+    // latency in ms from sending the command to the last response matched
+    uint32_t    min_latency;
+    uint32_t    max_latency;
+    uint32_t    total_latency;
+    uint32_t    num_latencies;
+
+    // bucket i > 0 counts latencies in [2^(i-1), 2^i) ms, bucket 0 those below 1 ms
+    uint16_t    histogram[A76XX_STATS_NUM_BUCKETS];
+};
+
+/*
+    @brief Fixed-size table of per-command statistics recorded by ModemSerial.
+
+    @details Commands are grouped by prefix, e.g. all "AT+HTTPPARA=..." commands
+        share an entry. A command is tracked from the moment it is sent until
+        the next command is sent: the bytes sent and received in this interval
+        are attributed to it, its latency is the time to the last response matched,
+        e.g. the URC of HTTPACTION, and it counts as a timeout or an error if the
+        last response was a timeout or ERROR. At most A76XX_STATS_MAX_COMMANDS
+        prefixes are stored; commands with other prefixes are only counted in
+        ::dropped. The command being tracked is recorded by ::print and ::format.
+        No memory is allocated.
+
+        The table is only compiled when A76XX_ENABLE_STATS is defined.
+*/
+class CommandStats_t {
+  friend class ModemSerial;
+
+  private:
+    CommandStatsEntry_t  _entries[A76XX_STATS_MAX_COMMANDS];
+    uint8_t                                         _count;
+    uint32_t                                      _dropped;
+
+    // the command being tracked, NULL if none
+    CommandStatsEntry_t*                          _current;
+    uint32_t                                       _tstart;
+    uint32_t                                        _tlast;
+    Response_t                                   _last_rsp;
+
+    // start tracking a command, whose text starts at `cmd`
+    void begin(const char* cmd, size_t length) {
+        end();
+
+        // the prefix ends at the first '=', '?', ';' or end of line
+        size_t n = 0;
+        while (n < length && n < A76XX_STATS_PREFIX_LENGTH &&
+               cmd[n] != '=' && cmd[n] != '?' && cmd[n] != ';' && cmd[n] != '\r') {
+            n++;
+        }
+
+        _current = NULL;
+        for (uint8_t i = 0; i < _count; i++) {
+            if (strncmp(_entries[i].prefix, cmd, n) == 0 && _entries[i].prefix[n] == '\0') {
+                _current = &_entries[i];
+                break;
+            }
+        }
+
+        if (_current == NULL) {
+            if (_count == A76XX_STATS_MAX_COMMANDS) {
+                _dropped++;
+                return;
+            }
+            _current = &_entries[_count++];
+            memset(_current, 0, sizeof(CommandStatsEntry_t));
+            memcpy(_current->prefix, cmd, n);
+            _current->min_latency = UINT32_MAX;
+        }
+
+        _current->calls++;
+        _tstart   = millis();
+        _tlast    = _tstart;
+        _last_rsp = Response_t::A76XX_RESPONSE_PENDING;
+    }
+
+    void sent(size_t n) {
+        if (_current != NULL) {
+            _current->bytes_sent += n;
+        }
+    }
+
+    void received(size_t n) {
+        if (_current != NULL) {
+            _current->bytes_received += n;
+        }
+    }
+
+    void response(Response_t rsp) {
+        if (_current == NULL) {
+            return;
+        }
+        _last_rsp = rsp;
+        if (rsp != Response_t::A76XX_RESPONSE_TIMEOUT) {
+            _tlast = millis();
+        }
+    }
+
+    // stop tracking the current command and record its outcome
+    void end() {
+        if (_current == NULL) {
+            return;
+        }
+
+        switch (_last_rsp) {
+            case Response_t::A76XX_RESPONSE_PENDING : {
+                break;
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                _current->timeouts++;
+                break;
+            }
+            case Response_t::A76XX_RESPONSE_ERROR : {
+                _current->errors++;
+                // fall through, the latency of errors is recorded too
+            }
+            default : {
+                uint32_t latency = _tlast - _tstart;
+                _current->min_latency    = latency < _current->min_latency ? latency : _current->min_latency;
+                _current->max_latency    = latency > _current->max_latency ? latency : _current->max_latency;
+                _current->total_latency += latency;
+                _current->num_latencies++;
+
+                uint8_t bucket = 0;
+                while (latency > 0 && bucket < A76XX_STATS_NUM_BUCKETS - 1) {
+                    latency >>= 1;
+                    bucket++;
+                }
+                _current->histogram[bucket]++;
+            }
+        }
+        _current = NULL;
+    }
+
+  public:
+    CommandStats_t() {
+        reset();
+    }
+
+    /*
+        @brief Clear all statistics.
+    */
+    void reset() {
+        _count   = 0;
+        _dropped = 0;
+        _current = NULL;
+    }
+
+    /*
+        @brief The number of command prefixes in the table.
+    */
+    uint8_t size() const {
+        return _count;
+    }
+
+    /*
+        @brief The number of commands not recorded because the table was full.
+    */
+    uint32_t dropped() const {
+        return _dropped;
+    }
+
+    /*
+        @brief Get the statistics of a command prefix.
+
+        @param [IN] index The index of the entry, smaller than ::size.
+    */
+    const CommandStatsEntry_t& entry(uint8_t index) const {
+        return _entries[index];
+    }
+
+    /*
+        @brief The mean latency in milliseconds of a command prefix, 0 if no
+            response has been received.
+    */
+    uint32_t meanLatency(uint8_t index) const {
+        const CommandStatsEntry_t& e = entry(index);
+        return e.num_latencies > 0 ? e.total_latency / e.num_latencies : 0;
+    }
+
+    /*
+        @brief An upper bound of the 95th percentile of the latency in milliseconds
+            of a command prefix, from the histogram, i.e. the upper edge of the
+            bucket where the percentile falls, clamped to the maximum latency.
+    */
+    uint32_t p95Latency(uint8_t index) const {
+        const CommandStatsEntry_t& e = entry(index);
+        uint32_t target = e.num_latencies - e.num_latencies / 20;
+        uint32_t cumulative = 0;
+        for (uint8_t i = 0; i < A76XX_STATS_NUM_BUCKETS; i++) {
+            cumulative += e.histogram[i];
+            if (cumulative >= target && cumulative > 0) {
+                uint32_t edge = 1UL << i;
+                return edge < e.max_latency ? edge : e.max_latency;
+            }
+        }
+        return 0;
+    }
+
+    /*
+        @brief Format the statistics of a command prefix in a line of text, with
+            the fields prefix, calls, bytes sent, bytes received, min, mean, max
+            and p95 latency in ms, timeouts and errors, separated by commas.
+
+        @param [IN] index The index of the entry, smaller than ::size.
+        @param [OUT] buffer The destination buffer. The line is NULL terminated and
+            has no trailing line feed.
+        @param [IN] size The size of the buffer.
+        @return The length of the line, as returned by snprintf.
+    */
+    int formatEntry(uint8_t index, char* buffer, size_t size) const {
+        const CommandStatsEntry_t& e = entry(index);
+        return snprintf(buffer, size, "%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%u,%u",
+                        e.prefix,
+                        static_cast<unsigned long>(e.calls),
+                        static_cast<unsigned long>(e.bytes_sent),
+                        static_cast<unsigned long>(e.bytes_received),
+                        static_cast<unsigned long>(e.num_latencies > 0 ? e.min_latency : 0),
+                        static_cast<unsigned long>(meanLatency(index)),
+                        static_cast<unsigned long>(e.max_latency),
+                        static_cast<unsigned long>(p95Latency(index)),
+                        static_cast<unsigned int>(e.timeouts),
+                        static_cast<unsigned int>(e.errors));
+    }
+
+    /*
+        @brief Print the table, one command prefix per line as in ::formatEntry,
+            after a header line, e.g. to Serial. The command being tracked, if 
+            any, is recorded first.
+    */
+    void print(Print& out) {
+        end();
+        char line[96];
+        out.println("prefix,calls,sent,received,min,mean,max,p95,timeouts,errors");
+        for (uint8_t i = 0; i < size(); i++) {
+            formatEntry(i, line, sizeof(line));
+            out.println(line);
+        }
+    }
+
+    /*
+        @brief Format the table as in ::print, in a buffer, e.g. to publish it as
+            an MQTT message.
+
+        @param [OUT] buffer The destination buffer. The text is NULL terminated.
+            Lines that do not fit are left out.
+        @param [IN] size The size of the buffer.
+        @return The length of the text.
+    */
+    size_t format(char* buffer, size_t size) {
+        end();
+        if (size == 0) {
+            return 0;
+        }
+        int length = snprintf(buffer, size, "prefix,calls,sent,received,min,mean,max,p95,timeouts,errors\n");
+        if (length < 0 || static_cast<size_t>(length) >= size) {
+            buffer[0] = '\0';
+            return 0;
+        }
+        size_t used = length;
+        for (uint8_t i = 0; i < this->size(); i++) {
+            length = formatEntry(i, buffer + used, size - used);
+            if (length < 0 || used + length + 1 >= size) {
+                buffer[used] = '\0';
+                break;
+            }
+            used += length;
+            buffer[used++] = '\n';
+            buffer[used]   = '\0';
+        }
+        return used;
+    }
+};
+
+#endif A76XX_COMMANDSTATS_H_
@@ -283,27 +283,30 @@ class GNSSCommands {
         _serial.sendCMD("AT+CGNSSINFO");
         switch (_serial.waitResponse("+CGNSSINFO:", 9000, false, true)) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                // when we do not have a fix there is a space
-                if (_serial.peek() == ' ') { 
-                    info.hasfix = false;
-                } else {
-                    info.hasfix = true;
-                    info.mode        = _serial.parseInt();   _serial.find(',');
-                    info.GPS_SVs     = _serial.parseInt();   _serial.find(',');
-                    info.GLONASS_SVs = _serial.parseInt();   _serial.find(',');
-                    info.BEIDOU_SVs  = _serial.parseInt();   _serial.find(',');
-                    info.lat         = _serial.parseFloat(); _serial.find(',');
-                    info.NS          = _serial.read();       _serial.find(',');
-                    info.lon         = _serial.parseFloat(); _serial.find(',');
-                    info.EW          = _serial.read();       _serial.find(',');
-                    _serial.readBytes(info.date, 6);         _serial.find(',');
-                    _serial.readBytes(info.UTC_TIME, 9);     _serial.find(',');
-                    info.alt         = _serial.parseFloat(); _serial.find(',');
-                    info.speed       = _serial.parseFloat(); _serial.find(',');
-                    info.course      = _serial.parseFloat(); _serial.find(',');
-                    info.PDOP        = _serial.parseFloat(); _serial.find(',');
-                    info.HDOP        = _serial.parseFloat(); _serial.find(',');
-                    info.VDOP        = _serial.parseFloat();
+                char line[128];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+
+                // when we do not have a fix all fields are empty
+                FieldTokenizer fields(line);
+                info.hasfix = fields.nextInt(info.mode);
+                if (info.hasfix) {
+                    fields.nextInt(info.GPS_SVs);
+                    fields.nextInt(info.GLONASS_SVs);
+                    fields.nextInt(info.BEIDOU_SVs);
+                    fields.nextFloat(info.lat);
+                    fields.nextChar(info.NS);
+                    fields.nextFloat(info.lon);
+                    fields.nextChar(info.EW);
+                    fields.nextString(info.date, sizeof(info.date));
+                    fields.nextString(info.UTC_TIME, sizeof(info.UTC_TIME));
+                    fields.nextFloat(info.alt);
+                    fields.nextFloat(info.speed);
+                    fields.nextFloat(info.course);
+                    fields.nextFloat(info.PDOP);
+                    fields.nextFloat(info.HDOP);
+                    fields.nextFloat(info.VDOP);
                 }
                 // get last OK in any case
                 if (_serial.waitResponse(9000) == Response_t::A76XX_RESPONSE_OK) {
@@ -331,20 +334,23 @@ class GNSSCommands {
         _serial.sendCMD("AT+CGPSINFO");
         switch (_serial.waitResponse("+CGPSINFO:", 9000, false, true)) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                // when we do not have a fix there should be an empty space after the :
-                if (_serial.peek() == ' ') { 
-                    info.hasfix = false;
-                } else {
-                    info.hasfix = true;
-                    info.lat         = _serial.parseFloat(); _serial.find(',');
-                    info.NS          = _serial.read();       _serial.find(',');
-                    info.lon         = _serial.parseFloat(); _serial.find(',');
-                    info.EW          = _serial.read();       _serial.find(',');
-                    _serial.readBytes(info.date, 6);         _serial.find(',');
-                    _serial.readBytes(info.UTC_TIME, 9);     _serial.find(',');
-                    info.alt         = _serial.parseFloat(); _serial.find(',');
-                    info.speed       = _serial.parseFloat(); _serial.find(',');
-                    info.course      = _serial.parseFloat();
+                char line[96];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+
+                // when we do not have a fix all fields are empty
+                FieldTokenizer fields(line);
+                info.hasfix = fields.nextFloat(info.lat);
+                if (info.hasfix) {
+                    fields.nextChar(info.NS);
+                    fields.nextFloat(info.lon);
+                    fields.nextChar(info.EW);
+                    fields.nextString(info.date, sizeof(info.date));
+                    fields.nextString(info.UTC_TIME, sizeof(info.UTC_TIME));
+                    fields.nextFloat(info.alt);
+                    fields.nextFloat(info.speed);
+                    fields.nextFloat(info.course);
                 }
                 // get last OK in any case
                 if (_serial.waitResponse(9000) == Response_t::A76XX_RESPONSE_OK) {
@@ -9,14 +9,77 @@
     HTTPINIT    |      y      | EXEC   | init
     HTTPTERM    |      y      | EXEC   | term
     HTTPPARA    |      y      | WRITE  | configHttp*
-    HTTPACTION  |      y      | WRITE  | action
+    HTTPACTION  |      y      | WRITE  | action, actionAsync
     HTTPHEAD    |      y      | EXEC   | readHeader
-    HTTPREAD    |      y      | R/W    | getContentLength, readResponseBody
+    HTTPREAD    |      y      | R/W    | getContentLength, readResponseBody, readResponseBodyRange
     HTTPDATA    |      y      | WRITE  | inputData
     HTTPPOSTFILE|             |        |
     HTTPREADFILE|             |        |
 */
 
+/*
+    @brief Asynchronous version of HTTPCommands::action.
+
+    @details The module answers HTTPACTION with OK immediately and with a URC when
+        the request completes, up to two minutes later. The status code and the
+        length of the body are written to the locations given to ::prepare when the
+        URC is received.
+*/
+class AsyncHTTPAction_t : public AsyncCommand_t {
+  private:
+    uint8_t                                  _method;
+    uint16_t*                           _status_code;
+    uint32_t*                                _length;
+    bool                                    _reading;
+    char                                   _line[24];
+
+  protected:
+    void start(ModemSerial* serial) {
+        _reading = false;
+        serial->sendCMDNoFlush("AT+HTTPACTION=", _method);
+        expect("+HTTPACTION: ", 120000, false, true);
+    }
+
+    void process(ModemSerial* serial, Response_t rsp) {
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                // +HTTPACTION: <method>,<status_code>,<length>
+                if (_reading == false) {
+                    _reading = true;
+                    return expectLine(_line, sizeof(_line));
+                }
+                FieldTokenizer fields(_line);
+                if (fields.skip() && fields.nextInt(*_status_code) && fields.nextInt(*_length)) {
+                    return finish(A76XX_OPERATION_SUCCEEDED);
+                }
+                return finish(A76XX_GENERIC_ERROR);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return finish(A76XX_OPERATION_TIMEDOUT);
+            }
+            default : {
+                return finish(A76XX_GENERIC_ERROR);
+            }
+        }
+    }
+
+  public:
+    AsyncHTTPAction_t()
+        : _method(0)
+        , _status_code(NULL)
+        , _length(NULL)
+        , _reading(false) {}
+
+    /*
+        @brief Set the parameters of the request. See HTTPCommands::action.
+    */
+    void prepare(uint8_t method, uint16_t* status_code, uint32_t* length) {
+        _method      = method;
+        _status_code = status_code;
+        _length      = length;
+    }
+};
+
 class HTTPCommands {
   public:
     ModemSerial& _serial;
@@ -26,13 +89,13 @@ class HTTPCommands {
 
     // HTTPINIT
     int8_t init() {
-        _serial.sendCMD("AT+HTTPINIT");
+        _serial.sendCMDNoFlush("AT+HTTPINIT");
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
     // HTTPTERM
     int8_t term() {
-        _serial.sendCMD("AT+HTTPTERM");
+        _serial.sendCMDNoFlush("AT+HTTPTERM");
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
@@ -41,55 +104,75 @@ class HTTPCommands {
         // add the protocol if not present
         if (strstr(server, "https://") == NULL && strstr(server, "http://") == NULL) {
             if (use_ssl == true) {
-                _serial.sendCMD("AT+HTTPPARA=\"URL\",", "\"https://", server, ":", port, "/", path, "\"");
+                _serial.sendCMDNoFlush("AT+HTTPPARA=\"URL\",", "\"https://", server, ":", port, "/", path, "\"");
             } else {
-                _serial.sendCMD("AT+HTTPPARA=\"URL\",", "\"http://", server, ":", port, "/", path, "\"");
+                _serial.sendCMDNoFlush("AT+HTTPPARA=\"URL\",", "\"http://", server, ":", port, "/", path, "\"");
             }
         } else {
-            _serial.sendCMD("AT+HTTPPARA=\"URL\",", "\"", server, ":", port, "/", path, "\"");
+            _serial.sendCMDNoFlush("AT+HTTPPARA=\"URL\",", "\"", server, ":", port, "/", path, "\"");
         }
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
+    bool configHttpURL(CommandBatch_t& batch, const char* server, uint16_t port, const char* path, bool use_ssl) {
+        // add the protocol if not present
+        if (strstr(server, "https://") == NULL && strstr(server, "http://") == NULL) {
+            return batch.add(120000, "AT+HTTPPARA=\"URL\",", use_ssl ? "\"https://" : "\"http://", server, ":", port, "/", path, "\"");
+        }
+        return batch.add(120000, "AT+HTTPPARA=\"URL\",", "\"", server, ":", port, "/", path, "\"");
+    }
+
     // HTTPPARA CONNECTTO
     int8_t configHttpConnTimeout(int conn_timeout) {
-        _serial.sendCMD("AT+HTTPPARA=\"CONNECTTO\",", conn_timeout);
+        _serial.sendCMDNoFlush("AT+HTTPPARA=\"CONNECTTO\",", conn_timeout);
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
     // HTTPPARA RECVTO
     int8_t configHttpRecvTimeout(int recv_timeout) {
-        _serial.sendCMD("AT+HTTPPARA=\"RECVTO\",", recv_timeout);
+        _serial.sendCMDNoFlush("AT+HTTPPARA=\"RECVTO\",", recv_timeout);
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
     // HTTPPARA CONTENT
     int8_t configHttpContentType(const char* content_type) {
-        _serial.sendCMD("AT+HTTPPARA=\"CONTENT\",\"", content_type, "\"");
+        _serial.sendCMDNoFlush("AT+HTTPPARA=\"CONTENT\",\"", content_type, "\"");
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
+    bool configHttpContentType(CommandBatch_t& batch, const char* content_type) {
+        return batch.add(120000, "AT+HTTPPARA=\"CONTENT\",\"", content_type, "\"");
+    }
+
     // HTTPPARA ACCEPT
     int8_t configHttpAccept(const char* accept) {
-        _serial.sendCMD("AT+HTTPPARA=\"ACCEPT\",\"", accept, "\"");
+        _serial.sendCMDNoFlush("AT+HTTPPARA=\"ACCEPT\",\"", accept, "\"");
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
+    bool configHttpAccept(CommandBatch_t& batch, const char* accept) {
+        return batch.add(120000, "AT+HTTPPARA=\"ACCEPT\",\"", accept, "\"");
+    }
+
     // HTTPPARA SSLCFG
     int8_t configHttpSSLCfgId(uint8_t sslcfg_id) {
-        _serial.sendCMD("AT+HTTPPARA=\"SSLCFG\",", sslcfg_id);
+        _serial.sendCMDNoFlush("AT+HTTPPARA=\"SSLCFG\",", sslcfg_id);
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
     // HTTPPARA USERDATA
     int8_t configHttpUserData(const char* header, const char* value) {
-        _serial.sendCMD("AT+HTTPPARA=\"USERDATA\",\"", header, ":", value, "\"");
+        _serial.sendCMDNoFlush("AT+HTTPPARA=\"USERDATA\",\"", header, ":", value, "\"");
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
+    bool configHttpUserData(CommandBatch_t& batch, const char* header, const char* value) {
+        return batch.add(120000, "AT+HTTPPARA=\"USERDATA\",\"", header, ":", value, "\"");
+    }
+
     // HTTPPARA READMODE
     int8_t configHttpReadMode(uint8_t readmode) {
-        _serial.sendCMD("AT+HTTPPARA=\"READMODE\",", readmode);
+        _serial.sendCMDNoFlush("AT+HTTPPARA=\"READMODE\",", readmode);
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(120000))
     }
 
@@ -100,16 +183,20 @@ class HTTPCommands {
     // 3 => DELETE
     // 4 =>    PUT
     int8_t action(uint8_t method, uint16_t* status_code, uint32_t* length) {
-        _serial.sendCMD("AT+HTTPACTION=", method);
+        _serial.sendCMDNoFlush("AT+HTTPACTION=", method);
         Response_t rsp = _serial.waitResponse("+HTTPACTION: ", 120000, false, true);
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                _serial.parseInt();
-                _serial.find(',');
-                *status_code = _serial.parseInt();
-                _serial.find(',');
-                *length = _serial.parseInt();
-                return A76XX_OPERATION_SUCCEEDED;
+                // +HTTPACTION: <method>,<status_code>,<length>
+                char line[24];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                FieldTokenizer fields(line);
+                if (fields.skip() && fields.nextInt(*status_code) && fields.nextInt(*length)) {
+                    return A76XX_OPERATION_SUCCEEDED;
+                }
+                return A76XX_GENERIC_ERROR;
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -120,27 +207,37 @@ class HTTPCommands {
         }
     }
 
+    // HTTPACTION, without waiting for the request to complete. The command object
+    // must stay alive until it completes, see AsyncCommand_t.
+    int8_t actionAsync(AsyncHTTPAction_t& command, uint8_t method, uint16_t* status_code, uint32_t* length) {
+        command.prepare(method, status_code, length);
+        return _serial.submit(&command);
+    }
+
     // HTTPHEAD
     int8_t readHeader(String& header) {
-        _serial.sendCMD("AT+HTTPHEAD");
+        _serial.sendCMDNoFlush("AT+HTTPHEAD");
         Response_t rsp = _serial.waitResponse("+HTTPHEAD: ", 120000, false, true);
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                // get length of header
-                int header_length = _serial.parseInt();
+                // get length of header, the content starts on the next line
+                char line[16];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                uint32_t header_length;
+                if (FieldTokenizer(line).nextInt(header_length) == false) {
+                    return A76XX_GENERIC_ERROR;
+                }
 
                 // reserve space for the string
                 if (header.reserve(header_length) == 0) {
                     return A76XX_OUT_OF_MEMORY;
                 }
 
-                // advance till we start with the actual content
-                _serial.find("\n");
-
                 // read as many bytes as we said
-                for (uint32_t i = 0; i < header_length; i++) {
-                    while (_serial.available() == 0) {}
-                    header += static_cast<char>(_serial.read());
+                if (_serial.readBytes(header, header_length) != header_length) {
+                    return A76XX_OPERATION_TIMEDOUT;
                 }
 
                 if (_serial.waitResponse() == Response_t::A76XX_RESPONSE_OK) {
@@ -159,12 +256,19 @@ class HTTPCommands {
     }
 
     int8_t getContentLength(uint32_t* len) {
-        _serial.sendCMD("AT+HTTPREAD?");
+        _serial.sendCMDNoFlush("AT+HTTPREAD?");
         Response_t rsp = _serial.waitResponse("+HTTPREAD: LEN,", 120000, false, true);
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                *len = _serial.parseIntClear();
-                return A76XX_OPERATION_SUCCEEDED;
+                char line[16];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                if (FieldTokenizer(line).nextInt(*len) == false) {
+                    return A76XX_GENERIC_ERROR;
+                }
+                // get last OK
+                A76XX_RESPONSE_PROCESS(_serial.waitResponse())
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -177,12 +281,17 @@ class HTTPCommands {
 
     // HTTPREAD - read entire response
     int8_t readResponseBody(String& body, uint32_t body_length) {
-        _serial.sendCMD("AT+HTTPREAD=", 0, ",", body_length);
+        _serial.sendCMDNoFlush("AT+HTTPREAD=", 0, ",", body_length);
         Response_t rsp = _serial.waitResponse("+HTTPREAD: ", 120000, false, true);
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                // this should match with body_length
-                if (_serial.parseInt() != body_length) {
+                // this should match with body_length, the content starts on the next line
+                char line[16];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                uint32_t length;
+                if (FieldTokenizer(line).nextInt(length) == false || length != body_length) {
                     return A76XX_GENERIC_ERROR;
                 }
 
@@ -191,13 +300,9 @@ class HTTPCommands {
                     return A76XX_OUT_OF_MEMORY;
                 }
 
-                // advance till we start with the actual content
-                _serial.find('\n');
-
                 // read as many bytes as we said
-                for (uint32_t i = 0; i < body_length; i++) {
-                    while (_serial.available() == 0) {}
-                    body += static_cast<char>(_serial.read());
+                if (_serial.readBytes(body, body_length) != body_length) {
+                    return A76XX_OPERATION_TIMEDOUT;
                 }
 
                 // clear stream
@@ -216,10 +321,40 @@ class HTTPCommands {
         }
     }
 
+    // HTTPREAD - read part of the response into a buffer
+    /*
+        @brief Read up to `size` bytes of the body, starting at `offset`.
+
+        @param [OUT] length The number of bytes read, less than `size` at the
+            end of the body.
+        @return A76XX_OPERATION_SUCCEEDED, A76XX_OPERATION_TIMEDOUT if the data
+            does not arrive, or A76XX_GENERIC_ERROR if `offset` is past the end
+            of the body.
+    */
+    int8_t readResponseBodyRange(uint32_t offset, uint8_t* buffer, uint32_t size, uint32_t& length) {
+        return readRange(offset, size, length, [&](uint32_t n) {
+            return _serial.readBytes(buffer, n);
+        });
+    }
+
+    // HTTPREAD - read part of the response into a Print
+    /*
+        @brief Read up to `size` bytes of the body, starting at `offset`, and
+            write them to `output` with no other buffer, see ::readResponseBodyRange.
+
+        @return As for ::readResponseBodyRange, or A76XX_OUT_OF_MEMORY if `output`
+            does not take all the bytes.
+    */
+    int8_t readResponseBodyRange(uint32_t offset, uint32_t size, Print& output, uint32_t& length) {
+        return readRange(offset, size, length, [&](uint32_t n) {
+            return _serial.readBytes(output, n);
+        });
+    }
+
     // HTTPDATA
     int8_t inputData(const char* data, uint32_t length) {
         // use 30 seconds timeout
-        _serial.sendCMD("AT+HTTPDATA=", length, ",", 30);
+        _serial.sendCMDNoFlush("AT+HTTPDATA=", length, ",", 30);
 
         // timeout after 10 seconds
         Response_t rsp = _serial.waitResponse("DOWNLOAD", 10000, false, true);
@@ -227,7 +362,6 @@ class HTTPCommands {
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
                 _serial.write(data, length);
-                _serial.flush();
                 switch (_serial.waitResponse()) {
                     case Response_t::A76XX_RESPONSE_OK : {
                         return A76XX_OPERATION_SUCCEEDED;
@@ -248,6 +382,48 @@ class HTTPCommands {
             }
         }
     }
+
+  private:
+    // HTTPREAD=<offset>,<size>, with `read(n)` reading the n bytes of data 
+    // and returning the number of bytes stored
+    template <typename F>
+    int8_t readRange(uint32_t offset, uint32_t size, uint32_t& length, F read) {
+        length = 0;
+        _serial.sendCMDNoFlush("AT+HTTPREAD=", offset, ",", size);
+        Response_t rsp = _serial.waitResponse("+HTTPREAD: ", 120000, false, true);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                // the length of the data, which starts on the next line
+                char line[16];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                uint32_t count;
+                if (FieldTokenizer(line).nextInt(count) == false || count > size) {
+                    return A76XX_GENERIC_ERROR;
+                }
+
+                length = read(count);
+                int8_t retcode = A76XX_OPERATION_SUCCEEDED;
+                if (length != count) {
+                    // data left unread was not taken by the destination
+                    retcode = _serial.bufferedRX() > 0 ? A76XX_OUT_OF_MEMORY : A76XX_OPERATION_TIMEDOUT;
+                }
+
+                // skip the data not stored, if any, up to the end of the response
+                if (_serial.waitResponse("+HTTPREAD: 0") != Response_t::A76XX_RESPONSE_MATCH_1ST) {
+                    return retcode != A76XX_OPERATION_SUCCEEDED ? retcode : A76XX_GENERIC_ERROR;
+                }
+                return retcode;
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+    }
 };
 
 #endif A76XX_HTTP_CMDS_H_
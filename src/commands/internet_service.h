@@ -9,9 +9,89 @@
     ------------- | ----------- | ---------- | -----------
     AT+CHTPSERV   |             |            |
     AT+CHTPUPDATE |             |            |
-    AT+CNTP       |     y       | WRITE/EXEC | setNTPParams, updateSystemTime
+    AT+CNTP       |     y       | WRITE/EXEC | setNTPParams, updateSystemTime, updateSystemTimeAsync
 */
 
+/*
+    @brief Asynchronous version of InternetServiceCommands::setNTPParams followed
+        by InternetServiceCommands::updateSystemTime.
+
+    @details The result is the result code of the sync, as for updateSystemTime.
+        The host string must stay valid until the command completes.
+*/
+class AsyncNTPUpdate_t : public AsyncCommand_t {
+  private:
+    enum Step_t {
+        SET_PARAMS,
+        UPDATE,
+        RESULT
+    };
+
+    Step_t                                     _step;
+    const char*                                _host;
+    int8_t                                 _timezone;
+    uint32_t                                _timeout;
+    char                                    _line[8];
+
+  protected:
+    void start(ModemSerial* serial) {
+        _step = SET_PARAMS;
+        serial->sendCMD("AT+CNTP=\"", _host, "\",", _timezone);
+        expect(NULL, 1000);
+    }
+
+    void process(ModemSerial* serial, Response_t rsp) {
+        if (rsp == Response_t::A76XX_RESPONSE_TIMEOUT) {
+            return finish(A76XX_OPERATION_TIMEDOUT);
+        }
+
+        switch (_step) {
+            case SET_PARAMS : {
+                if (rsp != Response_t::A76XX_RESPONSE_OK) {
+                    return finish(A76XX_GENERIC_ERROR);
+                }
+                _step = UPDATE;
+                serial->sendCMD("AT+CNTP");
+                expect("+CNTP: ", _timeout, false, true);
+                return;
+            }
+            case UPDATE : {
+                if (rsp != Response_t::A76XX_RESPONSE_MATCH_1ST) {
+                    return finish(A76XX_GENERIC_ERROR);
+                }
+                // +CNTP: <err>
+                _step = RESULT;
+                expectLine(_line, sizeof(_line));
+                return;
+            }
+            case RESULT : {
+                int8_t err;
+                if (FieldTokenizer(_line).nextInt(err) == false) {
+                    return finish(A76XX_GENERIC_ERROR);
+                }
+                return finish(err);
+            }
+        }
+    }
+
+  public:
+    AsyncNTPUpdate_t()
+        : _step(SET_PARAMS)
+        , _host(NULL)
+        , _timezone(0)
+        , _timeout(0) {}
+
+    /*
+        @brief Set the parameters of the sync. See InternetServiceCommands::setNTPParams
+            and InternetServiceCommands::updateSystemTime.
+    */
+    void prepare(const char* host, int8_t timezone, uint32_t timeout) {
+        _host     = host;
+        _timezone = timezone;
+        _timeout  = timeout;
+    }
+};
+
 class InternetServiceCommands {
   public:
     ModemSerial& _serial;
@@ -53,6 +133,18 @@ class InternetServiceCommands {
         }
     }
 
+    /*
+        @brief Set NTP server and timezone and sync the system time, without 
+            waiting for the sync to complete.
+        @param [IN] command The command object, which must stay alive until it
+            completes. See AsyncCommand_t.
+        @return A76XX_OPERATION_SUCCEEDED if the command was queued or 
+            A76XX_ASYNC_COMMAND_BUSY.
+    */
+    int8_t updateSystemTimeAsync(AsyncNTPUpdate_t& command, const char* host, int8_t timezone, uint32_t timeout) {
+        command.prepare(host, timezone, timeout);
+        return _serial.submit(&command);
+    }
 };
 
 #endif A76XX_INTERNETSERVICE_CMDS_H_
\ No newline at end of file
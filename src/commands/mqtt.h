@@ -13,18 +13,261 @@
     CMQTTSSLCFG    |      y      |        | setSSLContext
     CMQTTWILLTOPIC |      y      |        | setWillTopic
     CMQTTWILLMSG   |      y      |        | setWillMessage
-    CMQTTCONNECT   |      y      |        | connect
-    CMQTTDISC      |      y      |        | disconnect, isConnected
+    CMQTTCONNECT   |      y      |        | connect, connectAsync
+    CMQTTDISC      |      y      |        | disconnect, isConnected, getConnectionStates
     CMQTTTOPIC     |      y      |        | setPublishTopic
     CMQTTPAYLOAD   |      y      |        | setPublishPayload
-    CMQTTPUB       |      y      |        | publish
-    CMQTTSUBTOPIC  |             |        |
-    CMQTTSUB       |      y      |        | subscribe
-    CMQTTUNSUBTOPIC|             |        |
-    CMQTTUNSUB     |             |        |
+    CMQTTPUB       |      y      |        | publish, publishMessage, sendMessage, publishAsync
+    CMQTTSUBTOPIC  |      y      |        | setSubscribeTopic
+    CMQTTSUB       |      y      |        | subscribe, subscribeTopics
+    CMQTTUNSUBTOPIC|      y      |        | setUnsubscribeTopic
+    CMQTTUNSUB     |      y      |        | unsubscribe, unsubscribeTopics
     CMQTTCFG       |             |        |
 */
 
+/*
+    @brief Base class of the asynchronous MQTT commands, with helpers to parse
+        responses such as "+CMQTTCONNECT: <client_index>,<err>".
+*/
+class AsyncMQTTCommand_t : public AsyncCommand_t {
+  private:
+    int8_t                                      _err;
+    bool                                    _reading;
+    bool                                   _draining;
+    uint8_t                                   _field;
+    char                                   _line[16];
+
+  protected:
+    /*
+        @brief Called by ::process for the responses of the steps of the command.
+    */
+    virtual void processStep(ModemSerial* serial, Response_t rsp) = 0;
+
+    /*
+        @brief Read the error code of the response and complete the command.
+
+        @detail The rest of the response is collected in the next steps, then 
+            the module terminates some of these responses with ERROR when the 
+            code is not zero, which is then consumed before completing, as in
+            MQTTCommands::readErrorCode.
+        @param [IN] field The index of the field with the error code.
+    */
+    void finishWithErrorCode(uint8_t field) {
+        _reading = true;
+        _field   = field;
+        expectLine(_line, sizeof(_line));
+    }
+
+    // parse the line collected by ::finishWithErrorCode
+    void processErrorCode(Response_t rsp) {
+        if (rsp == Response_t::A76XX_RESPONSE_TIMEOUT) {
+            return finish(A76XX_OPERATION_TIMEDOUT);
+        }
+        FieldTokenizer fields(_line);
+        if (fields.skip(_field) == false || fields.nextInt(_err) == false) {
+            return finish(A76XX_GENERIC_ERROR);
+        }
+        if (_err == 0) {
+            return finish(A76XX_OPERATION_SUCCEEDED);
+        }
+        _draining = true;
+        expect(NULL, 1000, false, true);
+    }
+
+    void process(ModemSerial* serial, Response_t rsp) {
+        if (_reading) {
+            _reading = false;
+            return processErrorCode(rsp);
+        }
+        if (_draining) {
+            _draining = false;
+            return finish(_err);
+        }
+        if (rsp == Response_t::A76XX_RESPONSE_TIMEOUT) {
+            return finish(A76XX_OPERATION_TIMEDOUT);
+        }
+        processStep(serial, rsp);
+    }
+
+  public:
+    AsyncMQTTCommand_t()
+        : _err(0)
+        , _reading(false)
+        , _draining(false)
+        , _field(0) {}
+};
+
+/*
+    @brief Asynchronous version of MQTTCommands::connect.
+
+    @details The strings passed to ::prepare must stay valid until the command
+        completes.
+*/
+class AsyncMQTTConnect_t : public AsyncMQTTCommand_t {
+  private:
+    uint8_t                            _client_index;
+    const char*                              _server;
+    int                                        _port;
+    bool                              _clean_session;
+    int                                   _keepalive;
+    const char*                            _username;
+    const char*                            _password;
+
+  protected:
+    void start(ModemSerial* serial) {
+        if (_username && _password) {
+            serial->sendCMDNoFlush("AT+CMQTTCONNECT=", _client_index, ",\"tcp://", _server, ":", _port, "\",", _keepalive, ",", _clean_session, ",\"", _username, "\",\"", _password, "\"");
+        } else {
+            serial->sendCMDNoFlush("AT+CMQTTCONNECT=", _client_index, ",\"tcp://", _server, ":", _port, "\",", _keepalive, ",", _clean_session);
+        }
+        expect("+CMQTTCONNECT: ", 9000, false, false);
+    }
+
+    void processStep(ModemSerial* serial, Response_t rsp) {
+        finishWithErrorCode(1);
+    }
+
+  public:
+    AsyncMQTTConnect_t()
+        : _client_index(0)
+        , _server(NULL)
+        , _port(0)
+        , _clean_session(true)
+        , _keepalive(60)
+        , _username(NULL)
+        , _password(NULL) {}
+
+    /*
+        @brief Set the parameters of the connection. See MQTTCommands::connect.
+    */
+    void prepare(uint8_t client_index, const char* server, int port,
+                 bool clean_session, int keepalive = 60,
+                 const char* username = NULL, const char* password = NULL) {
+        _client_index  = client_index;
+        _server        = server;
+        _port          = port;
+        _clean_session = clean_session;
+        _keepalive     = keepalive;
+        _username      = username;
+        _password      = password;
+    }
+};
+
+/*
+    @brief Asynchronous version of MQTTCommands::setTopic, MQTTCommands::setPayload 
+        and MQTTCommands::publish, run in sequence.
+
+    @details The topic and the payload must stay valid until the command completes.
+*/
+class AsyncMQTTPublish_t : public AsyncMQTTCommand_t {
+  private:
+    enum Step_t {
+        TOPIC,
+        TOPIC_DATA,
+        PAYLOAD,
+        PAYLOAD_DATA,
+        PUBLISH
+    };
+
+    Step_t                                     _step;
+    uint8_t                            _client_index;
+    const char*                               _topic;
+    const uint8_t*                          _payload;
+    uint32_t                                 _length;
+    uint8_t                                     _qos;
+    uint8_t                             _pub_timeout;
+    bool                                   _retained;
+    bool                                        _dup;
+
+  protected:
+    void start(ModemSerial* serial) {
+        _step = TOPIC;
+        serial->sendCMDNoFlush("AT+CMQTTTOPIC=", _client_index, ",", strlen(_topic));
+        expect(">", "+CMQTTTOPIC: ", NULL, 9000);
+    }
+
+    void processStep(ModemSerial* serial, Response_t rsp) {
+        switch (_step) {
+            case TOPIC : {
+                if (rsp == Response_t::A76XX_RESPONSE_MATCH_2ND) {
+                    return finishWithErrorCode(1);
+                }
+                if (rsp != Response_t::A76XX_RESPONSE_MATCH_1ST) {
+                    return finish(A76XX_GENERIC_ERROR);
+                }
+                _step = TOPIC_DATA;
+                serial->write(_topic);
+                expect(NULL, 1000);
+                return;
+            }
+            case TOPIC_DATA : {
+                if (rsp != Response_t::A76XX_RESPONSE_OK) {
+                    return finish(A76XX_GENERIC_ERROR);
+                }
+                _step = PAYLOAD;
+                serial->sendCMDNoFlush("AT+CMQTTPAYLOAD=", _client_index, ",", _length);
+                expect(">", "+CMQTTPAYLOAD: ", NULL, 9000);
+                return;
+            }
+            case PAYLOAD : {
+                if (rsp == Response_t::A76XX_RESPONSE_MATCH_2ND) {
+                    return finishWithErrorCode(1);
+                }
+                if (rsp != Response_t::A76XX_RESPONSE_MATCH_1ST) {
+                    return finish(A76XX_GENERIC_ERROR);
+                }
+                _step = PAYLOAD_DATA;
+                serial->write(_payload, _length);
+                expect(NULL, 1000);
+                return;
+            }
+            case PAYLOAD_DATA : {
+                if (rsp != Response_t::A76XX_RESPONSE_OK) {
+                    return finish(A76XX_GENERIC_ERROR);
+                }
+                _step = PUBLISH;
+                serial->sendCMDNoFlush("AT+CMQTTPUB=", _client_index, ",", _qos, ",", _pub_timeout, ",", _retained, ",", _dup);
+                // OK comes first and is skipped
+                expect("+CMQTTPUB: ", 9000, false, true);
+                return;
+            }
+            case PUBLISH : {
+                if (rsp != Response_t::A76XX_RESPONSE_MATCH_1ST) {
+                    return finish(A76XX_GENERIC_ERROR);
+                }
+                return finishWithErrorCode(1);
+            }
+        }
+    }
+
+  public:
+    AsyncMQTTPublish_t()
+        : _step(TOPIC)
+        , _client_index(0)
+        , _topic(NULL)
+        , _payload(NULL)
+        , _length(0)
+        , _qos(0)
+        , _pub_timeout(0)
+        , _retained(false)
+        , _dup(false) {}
+
+    /*
+        @brief Set the parameters of the message. See MQTTCommands::publish.
+    */
+    void prepare(uint8_t client_index, const char* topic, const uint8_t* payload, uint32_t length,
+                 uint8_t qos, uint8_t pub_timeout, bool retained = false, bool dup = false) {
+        _client_index = client_index;
+        _topic        = topic;
+        _payload      = payload;
+        _length       = length;
+        _qos          = qos;
+        _pub_timeout  = pub_timeout;
+        _retained     = retained;
+        _dup          = dup;
+    }
+};
+
 class MQTTCommands {
   public:
     ModemSerial& _serial;
@@ -35,37 +278,36 @@ class MQTTCommands {
     // CMQTTSTART
     int8_t start() {
         // start MQTT service by activating PDP context
-        _serial.sendCMD("AT+CMQTTSTART");
+        _serial.sendCMDNoFlush("AT+CMQTTSTART");
         Response_t rsp = _serial.waitResponse("+CMQTTSTART: ", 12000, false, true);
 
         if (rsp == Response_t::A76XX_RESPONSE_ERROR)
             return A76XX_MQTT_ALREADY_STARTED;
 
-        // read return code (could be 0) and clear stream
-        return _serial.parseIntClear();
+        // read return code (could be 0)
+        return readErrorCode(0);
     }
 
     // CMQTTSTOP
     int8_t stop() {
-        _serial.sendCMD("AT+CMQTTSTOP");
+        _serial.sendCMDNoFlush("AT+CMQTTSTOP");
         Response_t rsp = _serial.waitResponse("+CMQTTSTOP: ", 12000, false, true);
 
         if (rsp == Response_t::A76XX_RESPONSE_ERROR)
             return A76XX_MQTT_ALREADY_STOPPED;
 
-        // read return code (could be 0) and clear stream
-        return _serial.parseIntClear();
+        // read return code (could be 0)
+        return readErrorCode(0);
     }
 
     // CMQTTACCQ
     int8_t acquireClient(uint8_t client_index, const char clientID[], uint8_t server_type) {
-        _serial.sendCMD("AT+CMQTTACCQ=", client_index, ",\"", clientID, "\",", server_type);
+        _serial.sendCMDNoFlush("AT+CMQTTACCQ=", client_index, ",\"", clientID, "\",", server_type);
         Response_t rsp = _serial.waitResponse("+CMQTTACCQ: ", 9000, true, true);
 
         switch( rsp ) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_OK : {
                 return A76XX_OPERATION_SUCCEEDED;
@@ -84,18 +326,18 @@ class MQTTCommands {
 
     // CMQTTREL
     int8_t releaseClient(uint8_t client_index) {
-        _serial.sendCMD("AT+CMQTTREL=", client_index);
+        _serial.sendCMDNoFlush("AT+CMQTTREL=", client_index);
         Response_t rsp = _serial.waitResponse("+CMQTTREL: ", 9000, true, true);
 
         if (rsp == Response_t::A76XX_RESPONSE_OK)
+            return A76XX_OPERATION_SUCCEEDED;
 
         if (rsp == Response_t::A76XX_RESPONSE_ERROR)
             return A76XX_GENERIC_ERROR;
 
         // this is an error case
         if (rsp == Response_t::A76XX_RESPONSE_MATCH_1ST) {
-            _serial.find(',');
-            return _serial.parseIntClear();
+            return readErrorCode(1);
         }
 
         return A76XX_GENERIC_ERROR;
@@ -103,20 +345,19 @@ class MQTTCommands {
 
     // CMQTTSSLCFG
     int8_t setSSLContext(uint8_t session_id, uint8_t ssl_ctx_index) {
-        _serial.sendCMD("AT+CMQTTSSLCFG=", session_id, ",", ssl_ctx_index);
-        return _serial.waitResponse();
+        _serial.sendCMDNoFlush("AT+CMQTTSSLCFG=", session_id, ",", ssl_ctx_index);
+        A76XX_RESPONSE_PROCESS(_serial.waitResponse())
     }
 
     // CMQTTWILLTOPIC
     int8_t setWillTopic(uint8_t client_index, const char* will_topic) {
-        _serial.sendCMD("AT+CMQTTWILLTOPIC=", client_index, ",", strlen(will_topic));
+        _serial.sendCMDNoFlush("AT+CMQTTWILLTOPIC=", client_index, ",", strlen(will_topic));
 
         Response_t rsp = _serial.waitResponse(">", "+CMQTTWILLTOPIC: ", 9000);
 
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
                 _serial.write(will_topic);
-                _serial.flush();
                 if (_serial.waitResponse() == Response_t::A76XX_RESPONSE_OK) {
                     return A76XX_OPERATION_SUCCEEDED;
                 } else {
@@ -124,8 +365,7 @@ class MQTTCommands {
                 }
             }
             case Response_t::A76XX_RESPONSE_MATCH_2ND : {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -138,22 +378,21 @@ class MQTTCommands {
 
     // CMQTTWILLMSG
     int8_t setWillMessage(uint8_t client_index, const char* will_message, uint8_t will_qos) {
-        _serial.sendCMD("AT+CMQTTWILLMSG=", client_index, ",", strlen(will_message), ",", will_qos);
+        _serial.sendCMDNoFlush("AT+CMQTTWILLMSG=", client_index, ",", strlen(will_message), ",", will_qos);
 
         Response_t rsp = _serial.waitResponse(">", "+CMQTTWILLMSG: ", 9000);
 
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
                 _serial.write(will_message);
-                _serial.flush();
                 if (_serial.waitResponse() == Response_t::A76XX_RESPONSE_OK) {
+                    return A76XX_OPERATION_SUCCEEDED;
                 } else {
                     return A76XX_GENERIC_ERROR;
                 }
             }
             case Response_t::A76XX_RESPONSE_MATCH_2ND : {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -170,9 +409,9 @@ class MQTTCommands {
                    const char* username = NULL, const char* password = NULL) {
 
         if (username && password) {
-            _serial.sendCMD("AT+CMQTTCONNECT=", client_index, ",\"tcp://", server, ":", port, "\",", keepalive, ",", clean_session, ",\"", username, "\",\"", password, "\"");
+            _serial.sendCMDNoFlush("AT+CMQTTCONNECT=", client_index, ",\"tcp://", server, ":", port, "\",", keepalive, ",", clean_session, ",\"", username, "\",\"", password, "\"");
         } else {
-            _serial.sendCMD("AT+CMQTTCONNECT=", client_index, ",\"tcp://", server, ":", port, "\",", keepalive, ",", clean_session);
+            _serial.sendCMDNoFlush("AT+CMQTTCONNECT=", client_index, ",\"tcp://", server, ":", port, "\",", keepalive, ",", clean_session);
         }
 
         // it might happen that the command only returns ERROR (case 5)
@@ -182,8 +421,7 @@ class MQTTCommands {
         // read int output
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -194,9 +432,18 @@ class MQTTCommands {
         }
     }
 
+    // CMQTTCONNECT, without waiting for the connection to complete. The command
+    // object must stay alive until it completes, see AsyncCommand_t.
+    int8_t connectAsync(AsyncMQTTConnect_t& command, uint8_t client_index, const char* server, int port,
+                        bool clean_session, int keepalive = 60,
+                        const char* username = NULL, const char* password = NULL) {
+        command.prepare(client_index, server, port, clean_session, keepalive, username, password);
+        return _serial.submit(&command);
+    }
+
     // CMQTTDISC?
     bool isConnected(uint8_t client_index) {
-        _serial.sendCMD("AT+CMQTTDISC?");
+        _serial.sendCMDNoFlush("AT+CMQTTDISC?");
 
         char match_str[15] = "+CMQTTDISC: x,";
         match_str[12] = client_index == 0 ? '0' : '1';
@@ -204,23 +451,65 @@ class MQTTCommands {
         Response_t rsp = _serial.waitResponse(match_str, 9000, false, true);
 
         if (rsp == Response_t::A76XX_RESPONSE_MATCH_1ST) {
-            int retcode = _serial.parseIntClear();
-            return retcode == 0 ? true : false;
+            char line[8];
+            int8_t state = -1;
+            if (_serial.readLine(line, sizeof(line)) >= 0) {
+                FieldTokenizer(line).nextInt(state);
+            }
+            // consume the state of the other client and OK
+            _serial.clear();
+            return state == 0 ? true : false;
         } else {
             return false;
         }
     }
 
+    // CMQTTDISC?
+    /*
+        @brief Get the state of the connections of all the clients with a single
+            command, e.g. to resume after a restart of the micro-controller.
+
+        @param [OUT] connected Whether each client is connected to its broker.
+        @return A76XX_OPERATION_SUCCEEDED, A76XX_MQTT_ALREADY_STOPPED if the
+            service is not running, in which case the module answers ERROR, or
+            A76XX_OPERATION_TIMEDOUT.
+    */
+    int8_t getConnectionStates(bool connected[A76XX_MQTT_MAX_CLIENTS]) {
+        _serial.sendCMDNoFlush("AT+CMQTTDISC?");
+
+        // +CMQTTDISC: <client_index>,<disc_state>, for each client
+        for (uint8_t i = 0; i < A76XX_MQTT_MAX_CLIENTS; i++) {
+            Response_t rsp = _serial.waitResponse("+CMQTTDISC: ", 9000, false, true);
+            if (rsp == Response_t::A76XX_RESPONSE_ERROR) {
+                return A76XX_MQTT_ALREADY_STOPPED;
+            }
+            if (rsp != Response_t::A76XX_RESPONSE_MATCH_1ST) {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            char line[8];
+            uint8_t client_index = 0xFF;
+            int8_t  state        = -1;
+            if (_serial.readLine(line, sizeof(line)) >= 0) {
+                FieldTokenizer tokenizer(line);
+                tokenizer.nextInt(client_index);
+                tokenizer.nextInt(state);
+            }
+            if (client_index < A76XX_MQTT_MAX_CLIENTS) {
+                connected[client_index] = state == 0;
+            }
+        }
+        A76XX_RESPONSE_PROCESS(_serial.waitResponse())
+    }
+
     // CMQTTDISC
     int8_t disconnect(uint8_t client_index, uint8_t timeout) {
-        _serial.sendCMD("AT+CMQTTDISC=", client_index, ",", timeout);
+        _serial.sendCMDNoFlush("AT+CMQTTDISC=", client_index, ",", timeout);
         Response_t rsp = _serial.waitResponse("+CMQTTDISC: ", timeout, false, true);
 
         // read int output
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST: {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT: {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -233,14 +522,13 @@ class MQTTCommands {
 
     // CMQTTTOPIC
     int8_t setTopic(uint8_t client_index, const char* topic) {
-        _serial.sendCMD("AT+CMQTTTOPIC=", client_index, ",", strlen(topic));
+        _serial.sendCMDNoFlush("AT+CMQTTTOPIC=", client_index, ",", strlen(topic));
 
         Response_t rsp = _serial.waitResponse(">", "+CMQTTTOPIC: ", 9000);
 
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
                 _serial.write(topic);
-                _serial.flush();
                 if (_serial.waitResponse() == Response_t::A76XX_RESPONSE_OK) {
                     return A76XX_OPERATION_SUCCEEDED;
                 } else {
@@ -248,8 +536,7 @@ class MQTTCommands {
                 }
             }
             case Response_t::A76XX_RESPONSE_MATCH_2ND : {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -262,14 +549,13 @@ class MQTTCommands {
 
     // CMQTTPAYLOAD
     int8_t setPayload(uint8_t client_index, const uint8_t* payload, uint length) {
-        _serial.sendCMD("AT+CMQTTPAYLOAD=0,", length);
+        _serial.sendCMDNoFlush("AT+CMQTTPAYLOAD=", client_index, ",", length);
 
-        Response_t rsp = _serial.waitResponse(">", "+CMQTTTPAYLOAD: ", 9000);
+        Response_t rsp = _serial.waitResponse(">", "+CMQTTPAYLOAD: ", 9000);
 
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
                 _serial.write(payload, length);
-                _serial.flush();
                 if (_serial.waitResponse() == Response_t::A76XX_RESPONSE_OK) {
                     return A76XX_OPERATION_SUCCEEDED;
                 } else {
@@ -277,8 +563,7 @@ class MQTTCommands {
                 }
             }
             case Response_t::A76XX_RESPONSE_MATCH_2ND : {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -293,15 +578,80 @@ class MQTTCommands {
     int8_t publish(uint8_t client_index, uint8_t qos, uint8_t pub_timeout, bool retained = false, bool dup = false) {
         uint8_t _retained = retained ? 1 : 0;
         uint8_t _dup      = dup      ? 1 : 0;
-        _serial.sendCMD("AT+CMQTTPUB=", client_index, ",", qos, ",", pub_timeout, ",", _retained, ",", _dup);
+        _serial.sendCMDNoFlush("AT+CMQTTPUB=", client_index, ",", qos, ",", pub_timeout, ",", _retained, ",", _dup);
 
         // we already have read OK
         Response_t rsp = _serial.waitResponse("+CMQTTPUB: ", 9000, false, true);
 
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+    }
+
+    /*
+        @brief Set the topic and the payload of a message and publish it, with
+            fewer round trips than ::setTopic, ::setPayload and ::publish.
+
+        @detail The module only accepts the topic and the payload after a ">"
+            prompt, which is always waited for. The next command is instead sent
+            together with the topic and with the payload, without waiting for
+            the OK terminating them, which saves two of the five round trips to
+            the module. The PUB command is only sent if the topic has been
+            accepted. If it is not, the payload is written anyway, to terminate
+            the data mode the module enters after the prompt.
+
+            The module clears the topic and the payload after CMQTTPUB, so both
+            are sent for every message, even if the topic does not change.
+        @return As for ::publish, or the error code of CMQTTTOPIC or CMQTTPAYLOAD.
+    */
+    int8_t publishMessage(uint8_t client_index, const char* topic, const uint8_t* payload,
+                          uint32_t length, uint8_t qos, uint8_t pub_timeout,
+                          bool retained = false, bool dup = false) {
+        int8_t retcode = sendMessage(client_index, topic, payload, length, qos, pub_timeout, retained, dup);
+        A76XX_RETCODE_ASSERT_RETURN(retcode);
+
+        Response_t rsp = _serial.waitResponse("+CMQTTPUB: ", 9000, false, true);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                return readErrorCode(1);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+    }
+
+    /*
+        @brief As ::publishMessage, but return as soon as the module has accepted
+            the CMQTTPUB command, without waiting for the "+CMQTTPUB: " response
+            that follows when the message has been delivered to the broker.
+
+        @return A76XX_OPERATION_SUCCEEDED if the message is being published, or the
+            error code of CMQTTTOPIC, CMQTTPAYLOAD or CMQTTPUB.
+    */
+    int8_t sendMessage(uint8_t client_index, const char* topic, const uint8_t* payload,
+                       uint32_t length, uint8_t qos, uint8_t pub_timeout,
+                       bool retained = false, bool dup = false) {
+        _serial.sendCMDNoFlush("AT+CMQTTTOPIC=", client_index, ",", strlen(topic));
+
+        Response_t rsp = _serial.waitResponse(">", "+CMQTTTOPIC: ", 9000);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                break;
+            }
+            case Response_t::A76XX_RESPONSE_MATCH_2ND : {
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -310,26 +660,152 @@ class MQTTCommands {
                 return A76XX_GENERIC_ERROR;
             }
         }
+
+        // topic and CMQTTPAYLOAD in a single write
+        _serial.printCMD(topic);
+        _serial.sendCMDNoFlush("AT+CMQTTPAYLOAD=", client_index, ",", length);
+        bool topic_ok = _serial.waitResponse() == Response_t::A76XX_RESPONSE_OK;
+
+        rsp = _serial.waitResponse(">", "+CMQTTPAYLOAD: ", 9000);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                break;
+            }
+            case Response_t::A76XX_RESPONSE_MATCH_2ND : {
+                return readErrorCode(1);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+
+        _serial.write(payload, length);
+        if (topic_ok == false) {
+            _serial.waitResponse();
+            return A76XX_GENERIC_ERROR;
+        }
+
+        // CMQTTPUB right after the payload, then wait for the OK of both
+        _serial.sendCMDNoFlush("AT+CMQTTPUB=", client_index, ",", qos, ",", pub_timeout, ",", retained, ",", dup);
+        if (_serial.waitResponse() != Response_t::A76XX_RESPONSE_OK ||
+            _serial.waitResponse() != Response_t::A76XX_RESPONSE_OK) {
+            return A76XX_GENERIC_ERROR;
+        }
+        return A76XX_OPERATION_SUCCEEDED;
+    }
+
+    // CMQTTTOPIC, CMQTTPAYLOAD and CMQTTPUB, without waiting for the message to
+    // be published. The command object must stay alive until it completes, see
+    // AsyncCommand_t.
+    int8_t publishAsync(AsyncMQTTPublish_t& command, uint8_t client_index, const char* topic,
+                        const uint8_t* payload, uint32_t length, uint8_t qos, uint8_t pub_timeout,
+                        bool retained = false, bool dup = false) {
+        command.prepare(client_index, topic, payload, length, qos, pub_timeout, retained, dup);
+        return _serial.submit(&command);
     }
 
     // CMQTTSUB
     int8_t subscribe(uint8_t client_index, const char* topic, uint8_t qos) {
-        _serial.sendCMD("AT+CMQTTSUB=", client_index, ",", strlen(topic), ",", qos);
+        _serial.sendCMDNoFlush("AT+CMQTTSUB=", client_index, ",", strlen(topic), ",", qos);
         Response_t rsp = _serial.waitResponse(">", "+CMQTTSUB: ", 9000, false, true);
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
                 _serial.write(topic);
-                _serial.flush();
                 if (_serial.waitResponse("+CMQTTSUB: ", 9000, false, true) == Response_t::A76XX_RESPONSE_MATCH_1ST) {
-                    _serial.find(',');
-                    return _serial.parseIntClear();
+                    return readErrorCode(1);
+                } else {
+                    return A76XX_GENERIC_ERROR;
+                }
+            }
+            case Response_t::A76XX_RESPONSE_MATCH_2ND : {
+                return readErrorCode(1);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+    }
+
+    // CMQTTSUBTOPIC
+    int8_t setSubscribeTopic(uint8_t client_index, const char* topic, uint8_t qos) {
+        _serial.sendCMDNoFlush("AT+CMQTTSUBTOPIC=", client_index, ",", strlen(topic), ",", qos);
+        Response_t rsp = _serial.waitResponse(">", "+CMQTTSUBTOPIC: ", 9000);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                _serial.write(topic);
+                A76XX_RESPONSE_PROCESS(_serial.waitResponse())
+            }
+            case Response_t::A76XX_RESPONSE_MATCH_2ND : {
+                return readErrorCode(1);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+    }
+
+    // CMQTTSUB, for all the topics set with setSubscribeTopic
+    int8_t subscribeTopics(uint8_t client_index) {
+        _serial.sendCMDNoFlush("AT+CMQTTSUB=", client_index);
+        Response_t rsp = _serial.waitResponse("+CMQTTSUB: ", 9000, false, true);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                return readErrorCode(1);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+    }
+
+    // CMQTTUNSUBTOPIC
+    int8_t setUnsubscribeTopic(uint8_t client_index, const char* topic) {
+        _serial.sendCMDNoFlush("AT+CMQTTUNSUBTOPIC=", client_index, ",", strlen(topic));
+        Response_t rsp = _serial.waitResponse(">", "+CMQTTUNSUBTOPIC: ", 9000);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                _serial.write(topic);
+                A76XX_RESPONSE_PROCESS(_serial.waitResponse())
+            }
+            case Response_t::A76XX_RESPONSE_MATCH_2ND : {
+                return readErrorCode(1);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+    }
+
+    // CMQTTUNSUB
+    int8_t unsubscribe(uint8_t client_index, const char* topic) {
+        _serial.sendCMDNoFlush("AT+CMQTTUNSUB=", client_index, ",", strlen(topic), ",0");
+        Response_t rsp = _serial.waitResponse(">", "+CMQTTUNSUB: ", 9000, false, true);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                _serial.write(topic);
+                if (_serial.waitResponse("+CMQTTUNSUB: ", 9000, false, true) == Response_t::A76XX_RESPONSE_MATCH_1ST) {
+                    return readErrorCode(1);
                 } else {
                     return A76XX_GENERIC_ERROR;
                 }
             }
             case Response_t::A76XX_RESPONSE_MATCH_2ND : {
-                _serial.find(',');
-                return _serial.parseIntClear();
+                return readErrorCode(1);
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -340,6 +816,208 @@ class MQTTCommands {
         }
     }
 
+    // CMQTTUNSUB, for all the topics set with setUnsubscribeTopic
+    int8_t unsubscribeTopics(uint8_t client_index) {
+        _serial.sendCMDNoFlush("AT+CMQTTUNSUB=", client_index);
+        Response_t rsp = _serial.waitResponse("+CMQTTUNSUB: ", 9000, false, true);
+        switch (rsp) {
+            case Response_t::A76XX_RESPONSE_MATCH_1ST : {
+                return readErrorCode(1);
+            }
+            case Response_t::A76XX_RESPONSE_TIMEOUT : {
+                return A76XX_OPERATION_TIMEDOUT;
+            }
+            default : {
+                return A76XX_GENERIC_ERROR;
+            }
+        }
+    }
+
+    /*
+        @brief Helper function to parse the error code in a response such as
+            "+CMQTTCONNECT: <client_index>,<err>".
+
+        @detail The module terminates some of these responses with ERROR when 
+            the code is not zero, which is then consumed.
+        @param [IN] field The index of the field with the error code.
+        @return The error code, A76XX_OPERATION_TIMEDOUT or A76XX_GENERIC_ERROR.
+    */
+    int8_t readErrorCode(uint8_t field) {
+        char line[16];
+        if (_serial.readLine(line, sizeof(line)) < 0) {
+            return A76XX_OPERATION_TIMEDOUT;
+        }
+        FieldTokenizer fields(line);
+        int8_t err;
+        if (fields.skip(field) == false || fields.nextInt(err) == false) {
+            return A76XX_GENERIC_ERROR;
+        }
+        if (err != 0) {
+            _serial.clear();
+        }
+        return err;
+    }
+};
+
+/*
+    @brief Owner of the MQTT service of the module, shared by the MQTT clients.
+
+    @details The module runs up to A76XX_MQTT_MAX_CLIENTS MQTT clients, each with
+        its own index, over a single service started with CMQTTSTART and stopped
+        with CMQTTSTOP. This object allocates the client indices, starts the 
+        service for the first client that needs it and stops it when the last
+        one is done with it. It also passes the URCs of each client, which start
+        with its index, to the handlers of that client, see IndexedEventRouter_t.
+*/
+class MQTTService_t {
+  private:
+    ModemSerial&                                                 _serial;
+    MQTTCommands                                                   _cmds;
+    bool                                   _in_use[A76XX_MQTT_MAX_CLIENTS];
+    uint8_t                                                       _users;
+    bool                                                     _registered;
+    IndexedEventRouter_t<A76XX_MQTT_MAX_CLIENTS>           _on_message_rx;
+    IndexedEventRouter_t<A76XX_MQTT_MAX_CLIENTS>            _on_published;
+    URCMQTTConnectionLost                                _connection_lost;
+
+  public:
+    static const uint8_t NONE = 0xFF;
+
+    /*
+        @param [IN] serial The serial connection with the module.
+        @param [IN] urc_queue The queue of the A76XX_URC_MQTT_CONNECTION_LOST events.
+    */
+    MQTTService_t(ModemSerial& serial, URCQueue_t& urc_queue)
+        : _serial(serial)
+        , _cmds(serial)
+        , _users(0)
+        , _registered(false)
+        , _on_message_rx("+CMQTTRXSTART: ", 5000)
+        , _on_published("+CMQTTPUB: ")
+        , _connection_lost(urc_queue) {
+        for (uint8_t i = 0; i < A76XX_MQTT_MAX_CLIENTS; i++) {
+            _in_use[i] = false;
+        }
+    }
+
+    /*
+        @brief Allocate a client index.
+
+        @param [IN] on_message_rx The handler of "+CMQTTRXSTART" for the client.
+        @param [IN] on_published The handler of "+CMQTTPUB" for the client.
+        @return The lowest free index, or NONE if all are in use.
+    */
+    uint8_t allocateClient(EventHandler_t* on_message_rx, EventHandler_t* on_published) {
+        // handlers are only registered when MQTT is used
+        if (_registered == false) {
+            if (_serial.registerEventHandler(&_on_message_rx) == false ||
+                _serial.registerEventHandler(&_on_published) == false ||
+                _serial.registerEventHandler(&_connection_lost) == false) {
+                _serial.deRegisterEventHandler(&_on_message_rx);
+                _serial.deRegisterEventHandler(&_on_published);
+                return NONE;
+            }
+            _registered = true;
+        }
+
+        for (uint8_t i = 0; i < A76XX_MQTT_MAX_CLIENTS; i++) {
+            if (_in_use[i] == false) {
+                _in_use[i] = true;
+                _on_message_rx.set(i, on_message_rx);
+                _on_published.set(i, on_published);
+                return i;
+            }
+        }
+        return NONE;
+    }
+
+    /*
+        @brief Free a client index, whose URCs are then discarded.
+    */
+    void freeClient(uint8_t client_index) {
+        if (client_index < A76XX_MQTT_MAX_CLIENTS) {
+            _in_use[client_index] = false;
+            _on_message_rx.set(client_index, NULL);
+            _on_published.set(client_index, NULL);
+        }
+    }
+
+    /*
+        @brief Start the service, with CMQTTSTART, unless already started by 
+            another client.
+
+        @detail A service found running, e.g. after a reset of the micro-controller
+            but not of the module, is used as is.
+        @return A76XX_OPERATION_SUCCEEDED or the error code of CMQTTSTART.
+    */
+    int8_t start() {
+        if (_users == 0) {
+            int8_t retcode = _cmds.start();
+            if (retcode != A76XX_OPERATION_SUCCEEDED && retcode != A76XX_MQTT_ALREADY_STARTED) {
+                return retcode;
+            }
+        }
+        _users++;
+        return A76XX_OPERATION_SUCCEEDED;
+    }
+
+    /*
+        @brief Use a service found running, e.g. after a restart of the 
+            micro-controller but not of the module, without CMQTTSTART.
+    */
+    void attach() {
+        _users++;
+    }
+
+    /*
+        @brief Stop the service, with CMQTTSTOP, if no other client uses it.
+
+        @return A76XX_OPERATION_SUCCEEDED, A76XX_MQTT_ALREADY_STOPPED if the service
+            has not been started or the error code of CMQTTSTOP.
+    */
+    int8_t stop() {
+        if (_users == 0) {
+            return A76XX_MQTT_ALREADY_STOPPED;
+        }
+        if (--_users > 0) {
+            return A76XX_OPERATION_SUCCEEDED;
+        }
+        int8_t retcode = _cmds.stop();
+        return retcode == A76XX_MQTT_ALREADY_STOPPED ? A76XX_OPERATION_SUCCEEDED : retcode;
+    }
+
+    /*
+        @brief The number of clients that have started the service.
+    */
+    uint8_t users() {
+        return _users;
+    }
+
+    /*
+        @brief Take the last loss of the connection of a client to the broker,
+            reported by "+CMQTTCONNLOST", if any. See URCMQTTConnectionLost::takeLost.
+    */
+    bool takeConnectionLost(uint8_t client_index, uint32_t& timestamp, uint8_t& cause) {
+        return _connection_lost.takeLost(client_index, timestamp, cause);
+    }
+
+    /*
+        @brief Enable or disable the A76XX_URC_MQTT_CONNECTION_LOST events, see
+            A76XX::enableURCEvents.
+
+        @return False if the handler cannot be registered.
+    */
+    bool setConnectionLostEvents(bool enable) {
+        _connection_lost.pushEvents(enable);
+        if (enable) {
+            return _serial.registerEventHandler(&_connection_lost);
+        }
+        // still needed by the clients
+        if (_registered == false) {
+            _serial.deRegisterEventHandler(&_connection_lost);
+        }
+        return true;
+    }
 };
 
 #endif A76XX_MQTT_CMDS_H_
\ No newline at end of file
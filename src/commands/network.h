@@ -7,7 +7,7 @@
 
     Command | Implemented | Method | Function(s)
     ------- | ----------- | ------ |-----------------------
-    CREG    |      y      |  READ  | getNetworkRegistration
+    CREG    |      y      |  W/R   | getNetworkRegistration, setNetworkRegistrationURC
     COPS    |      -      |        |
     CUSD    |      -      |        |
     CSSN    |      -      |        |
@@ -40,9 +40,17 @@ class NetworkCommands {
         Response_t rsp = _serial.waitResponse("+CREG: ", 9000, false, true);
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                _serial.find(',');
-                status = _serial.parseIntClear();
-                return A76XX_OPERATION_SUCCEEDED;
+                // +CREG: <n>,<stat>[,...]
+                char line[48];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                FieldTokenizer fields(line);
+                if (fields.skip() == false || fields.nextInt(status) == false) {
+                    return A76XX_GENERIC_ERROR;
+                }
+                // get last OK
+                A76XX_RESPONSE_PROCESS(_serial.waitResponse())
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -63,9 +71,17 @@ class NetworkCommands {
         Response_t rsp = _serial.waitResponse("+CNSMOD: ");
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                _serial.find(',');
-                mode = _serial.parseIntClear();
-                return A76XX_OPERATION_SUCCEEDED;
+                // +CNSMOD: <n>,<stat>
+                char line[16];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                FieldTokenizer fields(line);
+                if (fields.skip() == false || fields.nextInt(mode) == false) {
+                    return A76XX_GENERIC_ERROR;
+                }
+                // get last OK
+                A76XX_RESPONSE_PROCESS(_serial.waitResponse())
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -76,6 +92,22 @@ class NetworkCommands {
         }
     }
 
+    /*
+        @brief Implementation for CREG - Write Command.
+        @detail Control the URC "+CREG: <stat>" reporting changes of the GSM network
+            registration status.
+        @param [IN] n 0 to disable the URC, 1 to enable it, 2 to include location information.
+        @return A76XX_OPERATION_SUCCEEDED, A76XX_OPERATION_TIMEDOUT or A76XX_GENERIC_ERROR
+    */
+    int8_t setNetworkRegistrationURC(uint8_t n) {
+        _serial.sendCMD("AT+CREG=", n);
+        A76XX_RESPONSE_PROCESS(_serial.waitResponse())
+    }
+
+    bool setNetworkRegistrationURC(CommandBatch_t& batch, uint8_t n) {
+        return batch.add(1000, "AT+CREG=", n);
+    }
+
     /*
         @brief Implementation for CTZU - Write Command.
         @detail Enable or disable automatic time and time zone updates via NITZ.
@@ -86,6 +118,10 @@ class NetworkCommands {
         A76XX_RESPONSE_PROCESS(_serial.waitResponse())
     }
 
+    bool setTimeZoneAutoUpdate(CommandBatch_t& batch, bool enable) {
+        return batch.add(1000, "AT+CTZU=", enable ? "1" : "0");
+    }
+
     /*
         @brief Implementation for CTZR - Write Command.
         @detail Enable or disable unsolicited codes for time zone change.
@@ -95,6 +131,10 @@ class NetworkCommands {
         _serial.sendCMD("AT+CTZR=", enable ? "1" : "0");
         A76XX_RESPONSE_PROCESS(_serial.waitResponse());
     }
+
+    bool setTimeZoneURC(CommandBatch_t& batch, bool enable) {
+        return batch.add(1000, "AT+CTZR=", enable ? "1" : "0");
+    }
 };
 
 #endif A76XX_NETWORK_CMDS_H_
\ No newline at end of file
@@ -7,8 +7,8 @@
 
     Command | Implemented | Method | Function(s)
     ------- | ----------- | ------ |-----------------
-    CGREG   |      y      | READ   | getGPRSNetworkRegistrationStatus
-    CEREG   |      y      | READ   | getLTENetworkRegistrationStatus
+    CGREG   |      y      | W/R    | ***GPRSNetworkRegistrationStatus, setGPRSNetworkRegistrationURC
+    CEREG   |      y      | W/R    | ***LTENetworkRegistrationStatus, setLTENetworkRegistrationURC
     CGATT   |             |        |
     CGACT   |      y      | W/R    | ***PDPContextActiveStatus
     CGDCONT |      y      | WRITE  | setPDPContextParameters
@@ -21,7 +21,7 @@
     CGDATA  |             |        |
     CGPADDR |             |        |
     CGCLASS |             |        |
-    CGEREP  |             |        |
+    CGEREP  |      y      | WRITE  | setPacketDomainEventReporting
     CGAUTH  |      y      | WRITE  | setPDPAuthentication
     CPING   |             |        |
 */
@@ -53,6 +53,54 @@ class PacketDomainCommands {
         return getXXXNetworkRegistrationStatus('E', status);
     }
 
+    /*
+        @brief Implementation for CGREG - Write Command.
+        @detail Control the URC "+CGREG: <stat>" reporting changes of the GPRS network
+            registration status.
+        @param [IN] n 0 to disable the URC, 1 to enable it, 2 to include location information.
+        @return A76XX_OPERATION_SUCCEEDED, A76XX_OPERATION_TIMEDOUT or A76XX_GENERIC_ERROR.
+    */
+    int8_t setGPRSNetworkRegistrationURC(uint8_t n) {
+        _serial.sendCMD("AT+CGREG=", n);
+        A76XX_RESPONSE_PROCESS(_serial.waitResponse(9000))
+    }
+
+    bool setGPRSNetworkRegistrationURC(CommandBatch_t& batch, uint8_t n) {
+        return batch.add(9000, "AT+CGREG=", n);
+    }
+
+    /*
+        @brief Implementation for CEREG - Write Command.
+        @detail Control the URC "+CEREG: <stat>" reporting changes of the LTE network
+            registration status.
+        @param [IN] n 0 to disable the URC, 1 to enable it, 2 to include location information.
+        @return A76XX_OPERATION_SUCCEEDED, A76XX_OPERATION_TIMEDOUT or A76XX_GENERIC_ERROR.
+    */
+    int8_t setLTENetworkRegistrationURC(uint8_t n) {
+        _serial.sendCMD("AT+CEREG=", n);
+        A76XX_RESPONSE_PROCESS(_serial.waitResponse(9000))
+    }
+
+    bool setLTENetworkRegistrationURC(CommandBatch_t& batch, uint8_t n) {
+        return batch.add(9000, "AT+CEREG=", n);
+    }
+
+    /*
+        @brief Implementation for CGEREP - Write Command.
+        @detail Control the URCs "+CGEV: ..." reporting packet domain events, e.g.
+            the deactivation of a PDP context.
+        @param [IN] mode 0 to disable the URCs, 2 to enable them, see the manual for 1.
+        @return A76XX_OPERATION_SUCCEEDED, A76XX_OPERATION_TIMEDOUT or A76XX_GENERIC_ERROR.
+    */
+    int8_t setPacketDomainEventReporting(uint8_t mode) {
+        _serial.sendCMD("AT+CGEREP=", mode);
+        A76XX_RESPONSE_PROCESS(_serial.waitResponse(9000))
+    }
+
+    bool setPacketDomainEventReporting(CommandBatch_t& batch, uint8_t mode) {
+        return batch.add(9000, "AT+CGEREP=", mode);
+    }
+
     /*
         @brief Helper function
     */
@@ -62,9 +110,17 @@ class PacketDomainCommands {
         Response_t rsp = _serial.waitResponse(buff, 9000, false, true);
         switch (rsp) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                _serial.find(',');
-                status = _serial.parseIntClear();
-                return A76XX_OPERATION_SUCCEEDED;
+                // +CxREG: <n>,<stat>[,...]
+                char line[48];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                FieldTokenizer fields(line);
+                if (fields.skip() == false || fields.nextInt(status) == false) {
+                    return A76XX_GENERIC_ERROR;
+                }
+                // get last OK
+                A76XX_RESPONSE_PROCESS(_serial.waitResponse())
             }
             case Response_t::A76XX_RESPONSE_TIMEOUT : {
                 return A76XX_OPERATION_TIMEDOUT;
@@ -100,9 +156,17 @@ class PacketDomainCommands {
         sprintf(buff, "+CGACT: %d\0", cid);
         switch (_serial.waitResponse(buff, 9000)) {
             case Response_t::A76XX_RESPONSE_MATCH_1ST : {
-                _serial.find(',');
-                status = _serial.parseIntClear();
-                return A76XX_OPERATION_SUCCEEDED;
+                // the rest of the line is ",<state>"
+                char line[8];
+                if (_serial.readLine(line, sizeof(line)) < 0) {
+                    return A76XX_OPERATION_TIMEDOUT;
+                }
+                FieldTokenizer fields(line);
+                if (fields.skip() == false || fields.nextInt(status) == false) {
+                    return A76XX_GENERIC_ERROR;
+                }
+                // skip other contexts and get last OK
+                A76XX_RESPONSE_PROCESS(_serial.waitResponse())
             }
             case Response_t::A76XX_RESPONSE_OK : {
                 status = 0; // default is disconnected
@@ -146,7 +210,7 @@ class PacketDomainCommands {
         if (auth_type != 0)    { _serial.printCMD(",", auth_type);}
         if (password  != NULL) { _serial.printCMD(",", password);}
         if (username  != NULL) { _serial.printCMD(",", username);}
-        _serial.printCMD("\r\n");
+        _serial.sendCMD();
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(9000))
     }
 
@@ -37,6 +37,10 @@ class SSLCommands {
         A76XX_RESPONSE_PROCESS(_serial.waitResponse());
     }
 
+    bool configSSLSSLversion(CommandBatch_t& batch, uint8_t ssl_ctx_index, uint8_t ssl_version) {
+        return batch.add(1000, "AT+CSSLCFG=\"sslversion\",", ssl_ctx_index, ",", ssl_version);
+    }
+
     // CSSLCFG authmode
     int8_t configSSLAuthmode(uint8_t ssl_ctx_index, uint8_t authmode) {
         _serial.sendCMD("AT+CSSLCFG=\"authmode\",", ssl_ctx_index, ",", authmode);
@@ -49,12 +53,20 @@ class SSLCommands {
         A76XX_RESPONSE_PROCESS(_serial.waitResponse());
     }
 
+    bool configSSLIgnorelocaltime(CommandBatch_t& batch, uint8_t ssl_ctx_index, uint8_t ignorelocaltime) {
+        return batch.add(1000, "AT+CSSLCFG=\"ignorelocaltime\",", ssl_ctx_index, ",", ignorelocaltime);
+    }
+
     // CSSLCFG negotiatetime
     int8_t configSSLNegotiatetime(uint8_t ssl_ctx_index, uint16_t negotiatetime) {
         _serial.sendCMD("AT+CSSLCFG=\"negotiatetime\",", ssl_ctx_index, ",", negotiatetime);
         A76XX_RESPONSE_PROCESS(_serial.waitResponse());
     }
 
+    bool configSSLNegotiatetime(CommandBatch_t& batch, uint8_t ssl_ctx_index, uint16_t negotiatetime) {
+        return batch.add(1000, "AT+CSSLCFG=\"negotiatetime\",", ssl_ctx_index, ",", negotiatetime);
+    }
+
     // CSSLCFG cacert
     int8_t configSSLCacert(uint8_t ssl_ctx_index, const char* ca_file) {
         _serial.sendCMD("AT+CSSLCFG=\"cacert\",", ssl_ctx_index, ",\"", ca_file, "\"");
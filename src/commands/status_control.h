@@ -100,6 +100,10 @@ class StatusControlCommands {
         _serial.sendCMD("AT+CMEE=", n);
         A76XX_RESPONSE_PROCESS(_serial.waitResponse(9000))
     }
+
+    bool setErrorResultCodes(CommandBatch_t& batch, uint8_t n) {
+        return batch.add(9000, "AT+CMEE=", n);
+    }
 };
 
 #endif A76XX_STATUSCONTROL_CMDS_H_
\ No newline at end of file
@@ -58,6 +58,10 @@ class V25TERCommands {
         }
     }
 
+    bool commandEcho(CommandBatch_t& batch, bool enable) {
+        return batch.add(120000, "ATE", enable ? "1" : "0");
+    }
+
     /*
         @brief Implementation for CGMM - WRITE Command.
         @detail Get model identification string
@@ -1,50 +1,227 @@
 #ifndef A76XX_EVENTHANDLER_H_
 #define A76XX_EVENTHANDLER_H_
 
-// forward declaration
-class ModemSerial;
-
 /*
     @brief Base class for URC event handlers.
 
     @details SIMCOM modules produce certain unsolicited result codes (URC)
-        that signal certain events have occurred, e.g., when the device 
-        disconnects from the network or an MQTT message is received. 
-        These codes are emitted on the serial port that connects the 
+        that signal certain events have occurred, e.g., when the device
+        disconnects from the network or an MQTT message is received.
+        These codes are emitted on the serial port that connects the
         module to the micro-controller and thus need to be captured
-        as they occur, to avoid them being lost in the output of 
+        as they occur, to avoid them being lost in the output of
         other AT commands that might be issued to the module by the user.
 
-        An EventHandler_t object is composed of a match string, a corresponding
-        element of the enum A76XXURC_t, i.e. an URC code, and a processing function.
+        An EventHandler_t object is composed of a match string and an
+        incremental parser of the data that follows it.
 
         When communicating with the module, the output of the serial connection
-        is monitored. When the match string of any of the active event handler is 
-        found in the data stream the processing function is executed. This can be 
-        useful to further information about some URCs that also contain additional
-        characters, e.g. the payload of a MQTT message. Then the URC code of the 
-        event is pushed to a queue for later processing. This queue can be accessed
-        by calling A76XX::listen and events can be processed by the user's application.
+        is monitored. When the match string of any of the active event handler is
+        found in the data stream, unless the same data is the response a command
+        is waiting for, ::begin is called and the data that follows is passed to
+        ::feed as it arrives, chunk by chunk, until the handler reports that the
+        URC is complete or malformed. Meanwhile, data is not matched against other
+        strings. Handlers never read from the serial port, so they never block and
+        never wait for responses themselves. If the URC is not complete within
+        `timeout` milliseconds of the match, e.g. because data has been lost, 
+        ::discard is called. Malformed and incomplete URCs are counted in
+        ModemSerial::discardedEvents.
+
+        The handlers derived from URCEventHandler_t push a typed event to a queue
+        for later processing. This queue is accessed with A76XX::getURC or
+        dispatched to a callback set with A76XX::setURCCallback, from A76XX::poll
+        and A76XX::listen.
 */
 class EventHandler_t {
   public:
+    /*
+        The state of the URC after a call to ::feed.
+    */
+    enum State_t {
+        PENDING,   // more data is needed
+        DONE,      // the URC is complete
+        DISCARDED  // the URC is malformed and has been dropped
+    };
+
     /*
         The URC string produced by the module that we attempt to match.
     */
     const char* match_string;
-    
+
+    /*
+        The time in milliseconds within which the rest of the URC must be received.
+    */
+    uint32_t timeout;
+
     /*
         Construct from a match string.
     */
-    EventHandler_t(const char* _match_string)
-        : match_string(_match_string) {}
-    
+    EventHandler_t(const char* _match_string, uint32_t _timeout = A76XX_EVENT_HANDLER_TIMEOUT)
+        : match_string(_match_string)
+        , timeout(_timeout) {}
+
+    /*
+        Function executed as soon as the match string is found in the stream of
+        characters from the serial connection, to reset the state of the parser.
+    */
+    virtual void begin() {}
+
+    /*
+        Parse the data following the match string.
+
+        @param [IN] data The data received, not NULL terminated.
+        @param [IN] length The number of bytes of data.
+        @param [OUT] state Set to DONE or DISCARDED at the end of the URC, left
+            unchanged, i.e. PENDING, otherwise.
+        @return The number of bytes consumed. Data following the end of the URC
+            must not be consumed, while all data must be consumed otherwise.
+    */
+    virtual size_t feed(const char* data, size_t length, State_t& state) = 0;
+
     /*
-        Function to be executed as soon as the match string is found in the 
-        stream of characters from the serial connection. Can be a no-op if no
-        immediate action is required.
+        Function executed when the URC is not complete within `timeout`. The
+        partial URC should be dropped.
     */
-    virtual void process(ModemSerial* serial) = 0;
+    virtual void discard() {}
+};
+
+/*
+    @brief Incremental reader of a line of text, for event handlers.
+
+    @details The line is stored in a buffer provided by the caller, without the
+        terminating carriage return and line feed characters, and is truncated
+        if it does not fit. The buffer is always NULL terminated.
+*/
+class LineReader_t {
+  private:
+    size_t                                                          _length;
+
+  public:
+    LineReader_t()
+        : _length(0) {}
+
+    /*
+        @brief Start a new line, keeping the first `length` characters of the
+            buffer, e.g. a prefix copied by the caller.
+    */
+    void clear(size_t length = 0) {
+        _length = length;
+    }
+
+    /*
+        @brief Append data to the line, up to and including the next line feed.
+
+        @param [IN] data The data received.
+        @param [IN] length The number of bytes of data.
+        @param [OUT] buffer The destination buffer.
+        @param [IN] size The size of the buffer, which must be positive.
+        @param [OUT] complete Set to true if the line feed has been found.
+        @return The number of bytes consumed.
+    */
+    size_t feed(const char* data, size_t length, char* buffer, size_t size, bool& complete) {
+        const char* end = static_cast<const char*>(memchr(data, '\n', length));
+        size_t n = end != NULL ? end - data : length;
+
+        // copy what fits, skip the rest
+        if (_length + 1 < size) {
+            size_t m = n < size - 1 - _length ? n : size - 1 - _length;
+            memcpy(buffer + _length, data, m);
+            _length += m;
+        }
+
+        complete = end != NULL;
+        if (complete && _length > 0 && buffer[_length - 1] == '\r') {
+            _length--;
+        }
+        buffer[_length] = '\0';
+
+        return complete ? n + 1 : n;
+    }
+};
+
+/*
+    @brief Event handler passing URCs of the form "<match_string><index>,..." to
+        one of several handlers, according to the index.
+
+    @details Some URCs are produced for one of several instances of a service,
+        e.g. "+CMQTTRXSTART: <client_index>,..." for the MQTT clients, but only
+        one handler can be started for a match string. This handler reads the 
+        index, then starts the handler set for it and passes it all the data 
+        of the URC, index included. URCs with an index for which no handler is 
+        set are discarded.
+
+    @tparam N The number of indices, from 0 to N - 1.
+*/
+template <uint8_t N>
+class IndexedEventRouter_t : public EventHandler_t {
+  private:
+    EventHandler_t*                                          _handlers[N];
+    EventHandler_t*                                              _active;
+    char                                                       _index[4];
+    uint8_t                                                 _index_length;
+
+  public:
+    IndexedEventRouter_t(const char* _match_string, uint32_t _timeout = A76XX_EVENT_HANDLER_TIMEOUT)
+        : EventHandler_t(_match_string, _timeout)
+        , _active(NULL)
+        , _index_length(0) {
+        for (uint8_t i = 0; i < N; i++) {
+            _handlers[i] = NULL;
+        }
+    }
+
+    /*
+        @brief Set the handler of the URCs with the given index, or NULL to discard them.
+    */
+    void set(uint8_t index, EventHandler_t* handler) {
+        if (index < N) {
+            _handlers[index] = handler;
+        }
+    }
+
+    void begin() {
+        _active       = NULL;
+        _index_length = 0;
+    }
+
+    size_t feed(const char* data, size_t length, State_t& state) {
+        if (_active != NULL) {
+            return _active->feed(data, length, state);
+        }
+
+        // the digits of the index, up to the comma
+        size_t n = 0;
+        while (n < length && data[n] != ',') {
+            if (data[n] < '0' || data[n] > '9' || _index_length == sizeof(_index)) {
+                state = DISCARDED;
+                return n;
+            }
+            _index[_index_length++] = data[n++];
+        }
+        if (n == length) {
+            return n;
+        }
+
+        uint16_t index = 0;
+        for (uint8_t i = 0; i < _index_length; i++) {
+            index = 10 * index + (_index[i] - '0');
+        }
+        if (_index_length == 0 || index >= N || _handlers[index] == NULL) {
+            state = DISCARDED;
+            return n;
+        }
+
+        _active = _handlers[index];
+        _active->begin();
+        _active->feed(_index, _index_length, state);
+        return n + _active->feed(data + n, length - n, state);
+    }
+
+    void discard() {
+        if (_active != NULL) {
+            _active->discard();
+        }
+    }
 };
 
-#endif A76XX_EVENTHANDLER_H_
\ No newline at end of file
+#endif A76XX_EVENTHANDLER_H_
@@ -9,7 +9,17 @@ A76XX::A76XX(Stream& stream)
     , serialInterface(serial)
     , sim(serial)
     , statusControl(serial)
-    , v25ter(serial) {}
+    , v25ter(serial)
+    , mqttService(serial, _urc_queue)
+    , _urc_creg("+CREG: ", 0, _urc_queue)
+    , _urc_cgreg("+CGREG: ", 1, _urc_queue)
+    , _urc_cereg("+CEREG: ", 2, _urc_queue)
+    , _urc_pdp(_urc_queue)
+    , _urc_http(_urc_queue)
+    , _urc_sms(_urc_queue)
+    , _urc_mask(0)
+    , _urc_callback(NULL)
+    , _urc_context(NULL) {}
 
 int8_t A76XX::getLastError() {
     return _last_error_code;
@@ -23,20 +33,22 @@ bool A76XX::init(const char* pincode, uint32_t timeout) {
         return false;
     }
 
+    // these settings are chained in a single command line
+    CommandBatch_t batch;
+
     // turn off echoing commands
-    retcode = v25ter.commandEcho(false);
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode)
+    v25ter.commandEcho(batch, false);
 
     // disable reporting mobile equipment errors with numeric values
-    retcode = statusControl.setErrorResultCodes(0);
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode)
+    statusControl.setErrorResultCodes(batch, 0);
 
     // disable unsolicited codes for time zone change
-    retcode = network.setTimeZoneURC(false);
-    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode)
+    network.setTimeZoneURC(batch, false);
 
     // enable automatic time and time zone updates via NITZ
-    retcode = network.setTimeZoneAutoUpdate(true);
+    network.setTimeZoneAutoUpdate(batch, true);
+
+    retcode = serial.sendBatch(batch, true);
     A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode)
 
     PINStatus_t status;
@@ -224,6 +236,12 @@ bool A76XX::syncTime(int8_t timezone, uint32_t timeout, const char* host) {
     return true;
 }
 
+bool A76XX::syncTimeAsync(AsyncNTPUpdate_t& command, int8_t timezone, uint32_t timeout, const char* host) {
+    int8_t retcode = internetService.updateSystemTimeAsync(command, host, timezone, timeout);
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode);
+    return true;
+}
+
 String A76XX::getDateTime() {
     char dateTime[] = "yy/MM/dd,hh:mm:ss+zz";
     _last_error_code = statusControl.getDateTime(dateTime);
@@ -269,5 +287,130 @@ uint32_t A76XX::getUnixTime(bool UTC) {
 }
 
 void A76XX::listen(uint32_t timeout) {
-    return serial.listen(timeout);
-}
\ No newline at end of file
+    uint32_t tstart = millis();
+    do {
+        poll();
+    } while (millis() - tstart < timeout);
+}
+
+void A76XX::poll() {
+    serial.poll();
+
+    if (_urc_callback == NULL) {
+        return;
+    }
+
+    URCEvent_t event;
+    while (_urc_queue.pop(event)) {
+        _urc_callback(event, _urc_context);
+    }
+}
+
+bool A76XX::setURCHandlers(uint8_t mask, bool enable) {
+    EventHandler_t* handlers[] = {&_urc_creg, &_urc_cgreg, &_urc_cereg, &_urc_pdp,
+                                  &_urc_http, &_urc_sms};
+    A76XXURC_t      types[]    = {A76XX_URC_NETWORK_REGISTRATION,
+                                  A76XX_URC_NETWORK_REGISTRATION,
+                                  A76XX_URC_NETWORK_REGISTRATION,
+                                  A76XX_URC_PDP_DEACTIVATED,
+                                  A76XX_URC_HTTP_ACTION,
+                                  A76XX_URC_SMS_RECEIVED};
+
+    // the handler of +CMQTTCONNLOST is shared with the MQTT clients
+    if (mask & A76XX_URC_MASK(A76XX_URC_MQTT_CONNECTION_LOST)) {
+        if (mqttService.setConnectionLostEvents(enable) == false) {
+            return false;
+        }
+    }
+
+    for (uint8_t i = 0; i < sizeof(handlers) / sizeof(handlers[0]); i++) {
+        if ((mask & A76XX_URC_MASK(types[i])) == 0) {
+            continue;
+        }
+        if (enable == false) {
+            serial.deRegisterEventHandler(handlers[i]);
+        } else if (serial.registerEventHandler(handlers[i]) == false) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool A76XX::enableURCEvents(uint8_t mask) {
+    if (setURCHandlers(mask, true) == false) {
+        setURCHandlers(mask & ~_urc_mask, false);
+        _last_error_code = A76XX_GENERIC_ERROR;
+        return false;
+    }
+    _urc_mask |= mask;
+
+    CommandBatch_t batch;
+    if (mask & A76XX_URC_MASK(A76XX_URC_NETWORK_REGISTRATION)) {
+        network.setNetworkRegistrationURC(batch, 1);
+        packetDomain.setGPRSNetworkRegistrationURC(batch, 1);
+        packetDomain.setLTENetworkRegistrationURC(batch, 1);
+    }
+    if (mask & A76XX_URC_MASK(A76XX_URC_PDP_DEACTIVATED)) {
+        packetDomain.setPacketDomainEventReporting(batch, 2);
+    }
+    if (batch.size() == 0) {
+        return true;
+    }
+
+    int8_t retcode = serial.sendBatch(batch, true);
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode)
+    return true;
+}
+
+bool A76XX::disableURCEvents(uint8_t mask) {
+    setURCHandlers(mask, false);
+    _urc_mask &= ~mask;
+
+    CommandBatch_t batch;
+    if (mask & A76XX_URC_MASK(A76XX_URC_NETWORK_REGISTRATION)) {
+        network.setNetworkRegistrationURC(batch, 0);
+        packetDomain.setGPRSNetworkRegistrationURC(batch, 0);
+        packetDomain.setLTENetworkRegistrationURC(batch, 0);
+    }
+    if (mask & A76XX_URC_MASK(A76XX_URC_PDP_DEACTIVATED)) {
+        packetDomain.setPacketDomainEventReporting(batch, 0);
+    }
+    if (batch.size() == 0) {
+        return true;
+    }
+
+    int8_t retcode = serial.sendBatch(batch, true);
+    A76XX_CLIENT_RETCODE_ASSERT_BOOL(retcode)
+    return true;
+}
+
+uint8_t A76XX::urcAvailable() {
+    return _urc_queue.size();
+}
+
+bool A76XX::getURC(URCEvent_t& event) {
+    return _urc_queue.pop(event);
+}
+
+void A76XX::setURCCallback(URCCallback_t callback, void* context) {
+    _urc_callback = callback;
+    _urc_context  = context;
+}
+
+uint32_t A76XX::urcDropped() {
+    return _urc_queue.dropped();
+}
+
+uint16_t A76XX::urcDropped(A76XXURC_t type) {
+    return _urc_queue.dropped(type);
+}
+
+#ifdef A76XX_ENABLE_STATS
+CommandStats_t& A76XX::getCommandStats() {
+    return serial.stats();
+}
+
+void A76XX::printCommandStats(Print& out) {
+    serial.stats().print(out);
+}
+#endif
\ No newline at end of file
@@ -12,6 +12,24 @@ class A76XX {
     SIMCommands                               sim;
     StatusControlCommands           statusControl;
     V25TERCommands                         v25ter;
+    MQTTService_t                     mqttService;
+
+  private:
+    URCQueue_t                         _urc_queue;
+    URCNetworkRegistration              _urc_creg;
+    URCNetworkRegistration             _urc_cgreg;
+    URCNetworkRegistration             _urc_cereg;
+    URCPDPDeactivated                    _urc_pdp;
+    URCHTTPAction                       _urc_http;
+    URCSMSReceived                       _urc_sms;
+    uint8_t                             _urc_mask;
+    URCCallback_t                   _urc_callback;
+    void*                            _urc_context;
+
+    // register or deregister the handlers of the event types in mask
+    bool setURCHandlers(uint8_t mask, bool enable);
+
+  public:
 
     /*
         @brief Construct an instance of the modem.
@@ -219,6 +237,18 @@ class A76XX {
     */
     bool syncTime(int8_t timezone = 0, uint32_t timeout = 10000, const char* host = "pool.ntp.org");
 
+    /*
+        @brief Sync device clock with an NTP server, without waiting for the sync 
+            to complete.
+
+        @detail The arguments are as for ::syncTime. The sync proceeds while ::poll
+            is called; the result of `command` is the result code of the sync.
+        @param [IN] command The command object, which must stay alive until it
+            completes. Use it to check the result or to set a callback.
+        @return True if the sync has been queued.
+    */
+    bool syncTimeAsync(AsyncNTPUpdate_t& command, int8_t timezone = 0, uint32_t timeout = 10000, const char* host = "pool.ntp.org");
+
     /*
         @brief Get date and time.
         
@@ -259,9 +289,94 @@ class A76XX {
     /*
         @brief Listen for URCs from the serial connection with the module.
 
+        @detail Calls ::poll repeatedly, so the URC callback, if any, is called 
+            for the events received.
         @param [IN] timeout Wait up to this time in ms before returning.
     */
     void listen(uint32_t timeout = 100);
+
+    /*
+        @brief Make progress on asynchronous commands and process URCs, without
+            waiting for data from the module. See ModemSerial::poll.
+
+        @detail If a callback has been set with ::setURCCallback, all the URC
+            events in the queue are passed to it, oldest first.
+    */
+    void poll();
+
+    /*
+        @brief Enable the typed URC events of the given types.
+
+        @detail The handlers of the URCs are registered and the module is configured
+            to emit the URCs that are disabled by default, i.e. "+CREG: ", "+CGREG: "
+            and "+CEREG: " for A76XX_URC_NETWORK_REGISTRATION and "+CGEV: " for
+            A76XX_URC_PDP_DEACTIVATED. The other URCs are always emitted. Events
+            are then stored in a queue of size A76XX_URC_QUEUE_SIZE, see ::getURC,
+            or passed to the callback set with ::setURCCallback.
+
+        @param [IN] mask A combination of A76XX_URC_MASK(type), or A76XX_URC_ALL.
+        @return True on success. False if the module could not be configured or if
+            too many event handlers are registered, see A76XX_MAX_EVENT_HANDLERS.
+    */
+    bool enableURCEvents(uint8_t mask = A76XX_URC_ALL);
+
+    /*
+        @brief Disable the typed URC events of the given types.
+
+        @param [IN] mask A combination of A76XX_URC_MASK(type), or A76XX_URC_ALL.
+        @return True if the module was successfully configured.
+    */
+    bool disableURCEvents(uint8_t mask = A76XX_URC_ALL);
+
+    /*
+        @brief Get the number of URC events in the queue.
+    */
+    uint8_t urcAvailable();
+
+    /*
+        @brief Take the oldest URC event from the queue.
+
+        @param [OUT] event The event.
+        @return False if the queue is empty.
+    */
+    bool getURC(URCEvent_t& event);
+
+    /*
+        @brief Set a function called for each URC event, from ::poll and ::listen.
+
+        @detail The callback is not called while a command waits for its response,
+            so it can safely send commands to the module. Set to NULL to go back
+            to reading the events with ::getURC.
+        @param [IN] callback The function.
+        @param [IN] context A pointer passed to the callback, e.g. an object.
+    */
+    void setURCCallback(URCCallback_t callback, void* context = NULL);
+
+    /*
+        @brief Get the number of URC events lost because the queue was full.
+    */
+    uint32_t urcDropped();
+
+    /*
+        @brief Get the number of URC events of a given type lost because the 
+            queue was full.
+    */
+    uint16_t urcDropped(A76XXURC_t type);
+
+#ifdef A76XX_ENABLE_STATS
+    /*
+        @brief Get the per-command statistics: call count, bytes sent and received, 
+            latencies, timeouts and errors for each command prefix. Use it, e.g., to
+            publish the table with CommandStats_t::format over MQTT. Only available
+            when A76XX_ENABLE_STATS is defined.
+    */
+    CommandStats_t& getCommandStats();
+
+    /*
+        @brief Print the per-command statistics, one command per line, e.g. to Serial.
+    */
+    void printCommandStats(Print& out);
+#endif
 };
 
 #endif A76XXMODEM_H_
\ No newline at end of file
@@ -3,34 +3,324 @@
 
 #include "CircularBuffer.hpp"
 
-/*
-    @brief Check if the last characters in the character buffer match with a given string.
-
-    @param [IN] buf The character buffer.
-    @param [IN] str The string to be matched.
-    @return True in case of a match.
-*/
-template<size_t N>
-bool endsWith(CircularBuffer<char, N>& buf, const char* str) {
-    if (strlen(str) > buf.size()) { return false; }
-    const char* m = str + strlen(str) - 1; // pointer to last character in str
-    int i = 1;
-    while (i <= buf.size() && i <= strlen(str) ) {
-        if (buf[buf.size() - i] != *m) {
-            return false;
-        }
-        m--;
-        i++;
-    }
-    return true;
-}
-
-class ModemSerial {
+class ModemSerial : public Stream {
   private:
     Stream&                                                        _stream;
+
+    // staging buffer for data received from the module: unread data is in 
+    // the range [_rx_start, _rx_end)
+    char                                     _rx_buffer[A76XX_RX_BUFFER_SIZE];
+    uint16_t                                                     _rx_start;
+    uint16_t                                                       _rx_end;
+
+    // buffer where commands are formatted before being sent to the module
+    char                                     _tx_buffer[A76XX_TX_BUFFER_SIZE];
+    uint16_t                                                    _tx_length;
+
     EventHandler_t*              _event_handlers[A76XX_MAX_EVENT_HANDLERS];
     uint8_t                                            _num_event_handlers;
 
+    // automaton matching the event handlers strings first and then the response
+    // strings, so that the i-th handler has pattern index i
+    PatternMatcher<A76XX_MATCHER_MAX_STATES,
+        A76XX_MAX_EVENT_HANDLERS + A76XX_NUM_RESPONSE_PATTERNS>       _matcher;
+
+    // whether the automaton has been built for the current event handlers, and
+    // the array of response strings it has been built for, if still alive and
+    // unchanged, otherwise NULL and the strings are compared
+    bool                                                   _matcher_valid;
+    const char**                                       _matcher_responses;
+
+    // the handler receiving the rest of a URC, if any, and the time of its match
+    EventHandler_t*                                       _active_handler;
+    uint32_t                                                _active_tstart;
+
+    // number of URCs not received completely, see ::discardedEvents
+    uint32_t                                             _discarded_events;
+
+    // queue of asynchronous commands, the first one is being executed
+    AsyncCommand_t*                                           _async_head;
+    AsyncCommand_t*                                           _async_tail;
+
+    // true while the engine is running a step of an asynchronous command
+    bool                                                    _async_active;
+
+#ifdef A76XX_ENABLE_STATS
+    // per-command statistics, a new command starts with the next writeTX if set
+    CommandStats_t                                                  _stats;
+    bool                                               _stats_new_command;
+#endif
+
+    /*
+        @brief Rebuild the automaton from the current event handlers and the 
+            given response strings. NULL response strings are never matched.
+    */
+    void compileMatcher(const char* responses[A76XX_NUM_RESPONSE_PATTERNS]) {
+        _matcher.clear();
+        for (uint8_t i = 0; i < _num_event_handlers; i++) {
+            _matcher.addPattern(_event_handlers[i]->match_string);
+        }
+        for (uint8_t i = 0; i < A76XX_NUM_RESPONSE_PATTERNS; i++) {
+            _matcher.addPattern(responses[i]);
+        }
+        _matcher.compile();
+        _matcher_valid     = true;
+        _matcher_responses = responses;
+    }
+
+    // whether the automaton has been built for the current event handlers and
+    // the same response strings, possibly in another array
+    bool matcherBuiltFor(const char* responses[A76XX_NUM_RESPONSE_PATTERNS]) {
+        if (_matcher_valid == false) {
+            return false;
+        }
+        for (uint8_t i = 0; i < A76XX_NUM_RESPONSE_PATTERNS; i++) {
+            if (_matcher.hasPattern(_num_event_handlers + i, responses[i]) == false) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // drop the URC being received if it is not complete within the handler timeout
+    void expireHandler() {
+        if (_active_handler != NULL && millis() - _active_tstart >= _active_handler->timeout) {
+            _active_handler->discard();
+            _active_handler = NULL;
+            _discarded_events++;
+            _matcher.reset();
+        }
+    }
+
+    /*
+        @brief Feed the data in the staging buffer to the automaton, without blocking,
+            passing the data following the strings of the event handlers to them.
+
+        @detail The automaton is rebuilt for `responses` if needed. Data following 
+            the matched response is left in the buffer.
+        @return The first response matched, or A76XX_RESPONSE_PENDING if none was
+            matched before the buffer was emptied.
+    */
+    Response_t matchRX(const char* responses[A76XX_NUM_RESPONSE_PATTERNS]) {
+        static const Response_t codes[A76XX_NUM_RESPONSE_PATTERNS] = {
+            Response_t::A76XX_RESPONSE_MATCH_1ST,
+            Response_t::A76XX_RESPONSE_MATCH_2ND,
+            Response_t::A76XX_RESPONSE_MATCH_3RD,
+            Response_t::A76XX_RESPONSE_ERROR,
+            Response_t::A76XX_RESPONSE_OK
+        };
+
+        if (_matcher_valid == false || _matcher_responses != responses) {
+            if (matcherBuiltFor(responses)) {
+                _matcher_responses = responses;
+            } else {
+                compileMatcher(responses);
+            }
+        }
+
+        expireHandler();
+
+        while (true) {
+            // the rest of a URC goes to its handler, which might need more data
+            if (_active_handler != NULL) {
+                EventHandler_t::State_t state = EventHandler_t::PENDING;
+                consumeRX(_active_handler->feed(dataRX(), bufferedRX(), state));
+                if (state == EventHandler_t::PENDING) {
+                    return Response_t::A76XX_RESPONSE_PENDING;
+                }
+                if (state == EventHandler_t::DISCARDED) {
+                    _discarded_events++;
+                }
+                _active_handler = NULL;
+                _matcher.reset();
+            }
+
+            if (_rx_start == _rx_end) {
+                break;
+            }
+
+            if (_matcher.step(_rx_buffer[_rx_start++]) == false) {
+                continue;
+            }
+            uint64_t matches = _matcher.matches();
+
+            // responses have the indices following those of the handlers
+            uint64_t response_matches = matches >> _num_event_handlers;
+
+            // start the handler of the URC, unless the data is also the response
+            // being waited for, e.g. "+CREG: " after the CREG read command
+            if (response_matches == 0) {
+                for (uint8_t i = 0; i < _num_event_handlers; i++) {
+                    if (matches & (1ULL << i)) {
+                        _active_handler = _event_handlers[i];
+                        _active_tstart  = millis();
+                        _active_handler->begin();
+                        break;
+                    }
+                }
+                continue;
+            }
+
+            for (uint8_t i = 0; i < A76XX_NUM_RESPONSE_PATTERNS; i++) {
+                if (response_matches & (1ULL << i)) {
+#ifdef A76XX_ENABLE_STATS
+                    _stats.response(codes[i]);
+#endif
+                    return codes[i];
+                }
+            }
+        }
+
+        return Response_t::A76XX_RESPONSE_PENDING;
+    }
+
+    // send the first command of the asynchronous command at the head of the queue
+    void startAsync() {
+        AsyncCommand_t* command = _async_head;
+        command->_state = AsyncCommand_t::RUNNING;
+        _async_active = true;
+        command->start(this);
+        _async_active = false;
+        // the strings to match have changed
+        _matcher_responses = NULL;
+        if (command->isPending() == false) {
+            finishAsync();
+        }
+    }
+
+    // pass the data received to the asynchronous command collecting a line, 
+    // see AsyncCommand_t::expectLine
+    Response_t feedLineAsync(AsyncCommand_t* command) {
+        bool complete = false;
+        if (bufferedRX() > 0) {
+            consumeRX(command->_reader.feed(dataRX(), bufferedRX(), 
+                                            command->_line, command->_line_size, complete));
+        }
+        return complete ? Response_t::A76XX_RESPONSE_MATCH_1ST : Response_t::A76XX_RESPONSE_PENDING;
+    }
+
+    // pass a response to the asynchronous command at the head of the queue
+    void stepAsync(Response_t rsp) {
+        AsyncCommand_t* command = _async_head;
+        command->_line = NULL;
+        _async_active = true;
+        command->process(this, rsp);
+        _async_active = false;
+        _matcher_responses = NULL;
+        if (command->isPending() == false) {
+            finishAsync();
+        }
+    }
+
+    // remove the completed command from the queue, notify the user and start the next 
+    void finishAsync() {
+        AsyncCommand_t* command = _async_head;
+        _async_head = command->_next;
+        if (_async_head == NULL) {
+            _async_tail = NULL;
+        }
+        command->_next = NULL;
+
+        if (command->_callback != NULL) {
+            command->_callback(command, command->_context);
+        }
+
+        if (_async_head != NULL && _async_head->_state == AsyncCommand_t::QUEUED) {
+            startAsync();
+        }
+    }
+
+    // synchronous commands wait for the asynchronous ones, unless sent by them
+    void waitAsync() {
+        if (_async_head != NULL && _async_active == false) {
+            completeAll();
+        }
+    }
+
+    // send `n` commands of a batch, from `first`, in one line and wait for the response
+    int8_t sendBatchLine(CommandBatch_t& batch, uint8_t first, uint8_t n, uint32_t timeout) {
+        waitAsync();
+#ifdef A76XX_ENABLE_STATS
+        _stats_new_command = true;
+#endif
+        printCMD(batch.command(first));
+        for (uint8_t j = 1; j < n; j++) {
+            printCMD(";", batch.command(first + j) + 2);
+        }
+        sendCMDNoFlush();
+        A76XX_RESPONSE_PROCESS(waitResponse(timeout))
+    }
+
+    /*
+        @brief Hand over the content of the TX buffer to the underlying stream.
+    */
+    void writeTX() {
+        if (_tx_length > 0) {
+#ifdef A76XX_ENABLE_STATS
+            if (_stats_new_command) {
+                _stats.begin(_tx_buffer, _tx_length);
+                _stats_new_command = false;
+            }
+            _stats.sent(_tx_length);
+#endif
+            _stream.write(reinterpret_cast<const uint8_t*>(_tx_buffer), _tx_length);
+            _tx_length = 0;
+        }
+    }
+
+    // append data to the TX buffer, sending it out first if it gets full
+    void appendTX(const char* str, size_t length) {
+        while (length > 0) {
+            if (_tx_length == A76XX_TX_BUFFER_SIZE) {
+                writeTX();
+            }
+            size_t n = A76XX_TX_BUFFER_SIZE - _tx_length;
+            n = n < length ? n : length;
+            memcpy(_tx_buffer + _tx_length, str, n);
+            _tx_length += n;
+            str        += n;
+            length     -= n;
+        }
+    }
+
+    void appendTX(const char* str) {
+        if (str != NULL) {
+            appendTX(str, strlen(str));
+        }
+    }
+
+    void appendTX(char c) {
+        appendTX(&c, 1);
+    }
+
+    // integers are formatted in decimal, as Print::print does
+    void appendTX(unsigned long value) {
+        char digits[20];
+        uint8_t i = sizeof(digits);
+        do {
+            digits[--i] = '0' + value % 10;
+            value /= 10;
+        } while (value > 0);
+        appendTX(digits + i, sizeof(digits) - i);
+    }
+
+    void appendTX(long value) {
+        if (value < 0) {
+            appendTX('-');
+            appendTX(0UL - static_cast<unsigned long>(value));
+        } else {
+            appendTX(static_cast<unsigned long>(value));
+        }
+    }
+
+    void appendTX(bool value)           { appendTX(value ? '1' : '0'); }
+    void appendTX(signed char value)    { appendTX(static_cast<long>(value)); }
+    void appendTX(unsigned char value)  { appendTX(static_cast<unsigned long>(value)); }
+    void appendTX(short value)          { appendTX(static_cast<long>(value)); }
+    void appendTX(unsigned short value) { appendTX(static_cast<unsigned long>(value)); }
+    void appendTX(int value)            { appendTX(static_cast<long>(value)); }
+    void appendTX(unsigned int value)   { appendTX(static_cast<unsigned long>(value)); }
+
   public:
 
     /*
@@ -38,7 +328,10 @@ class ModemSerial {
 
         @details This is a standard Arduino Serial object on steroids, with 
             additional functionality to send AT commands and parse the response
-            from the module.
+            from the module. Data received from the module is drained in chunks
+            into a staging buffer, of size A76XX_RX_BUFFER_SIZE, from which all 
+            read operations are served. Commands are formatted in a buffer of size
+            A76XX_TX_BUFFER_SIZE and sent with a single write.
 
         @param [IN] stream The underlying serial object. It must be initialized 
             externally by the user with, e.g., a call to begin, with the appropriate 
@@ -47,7 +340,22 @@ class ModemSerial {
     */
     ModemSerial(Stream& stream)
         : _stream(stream) 
-        , _num_event_handlers(0) {}
+        , _rx_start(0)
+        , _rx_end(0)
+        , _tx_length(0)
+        , _num_event_handlers(0)
+        , _matcher_valid(false)
+        , _matcher_responses(NULL)
+        , _active_handler(NULL)
+        , _active_tstart(0)
+        , _discarded_events(0)
+        , _async_head(NULL)
+        , _async_tail(NULL)
+        , _async_active(false)
+#ifdef A76XX_ENABLE_STATS
+        , _stats_new_command(false)
+#endif
+        {}
 
     /*
         @brief Wait for modem to respond.
@@ -73,40 +381,35 @@ class ModemSerial {
                             int timeout = 1000,
                             bool match_OK = true,
                             bool match_ERROR = true) {
-        // store data here
-        CircularBuffer<char, 64> data;
+        // the strings we are waiting for, in order of precedence
+        const char* responses[A76XX_NUM_RESPONSE_PATTERNS] = {
+            match_1, 
+            match_2, 
+            match_3, 
+            match_ERROR ? RESPONSE_ERROR : NULL, 
+            match_OK    ? RESPONSE_OK    : NULL
+        };
 
         // start timer
         auto tstart = millis();
 
-        while (millis() - tstart < timeout) {
-            if (available() > 0) {
-                data.push(static_cast<char>(read()));
-
-                // parse modem output for any URCs that we need to process
-                for (uint8_t i = 0; i < _num_event_handlers; i++) {
-                    if (endsWith(data, _event_handlers[i]->match_string)) {
-                        _event_handlers[i]->process(this);
-                    }
-                }
-
-                if (match_1 != NULL && endsWith(data, match_1) == true)
-                    return Response_t::A76XX_RESPONSE_MATCH_1ST;
-
-                if (match_2 != NULL && endsWith(data, match_2) == true)
-                    return Response_t::A76XX_RESPONSE_MATCH_2ND;
-
-                if (match_3 != NULL && endsWith(data, match_3) == true)
-                    return Response_t::A76XX_RESPONSE_MATCH_3RD;
-
-                if (match_ERROR && endsWith(data, RESPONSE_ERROR) == true)
-                    return Response_t::A76XX_RESPONSE_ERROR;
-
-                if (match_OK && endsWith(data, RESPONSE_OK) == true)
-                    return Response_t::A76XX_RESPONSE_OK;
+        // the automaton is rebuilt by matchRX only if the strings differ from
+        // those of the last wait, and `responses` is forgotten before returning
+        Response_t rsp = matchRX(responses);
+        while (rsp == Response_t::A76XX_RESPONSE_PENDING && millis() - tstart < timeout) {
+            if (fillRX() == 0 && _active_handler == NULL) {
+                continue;
             }
+            rsp = matchRX(responses);
+        }
+        _matcher_responses = NULL;
+        if (rsp != Response_t::A76XX_RESPONSE_PENDING) {
+            return rsp;
         }
 
+#ifdef A76XX_ENABLE_STATS
+        _stats.response(Response_t::A76XX_RESPONSE_TIMEOUT);
+#endif
         return Response_t::A76XX_RESPONSE_TIMEOUT;
     }
 
@@ -182,16 +485,159 @@ class ModemSerial {
         @param [IN] timeout Wait up to this time in ms before returning.
     */
     void listen(uint32_t timeout = 100) {
-        waitResponse(timeout, false, false);
+        uint32_t tstart = millis();
+        do {
+            poll();
+        } while (millis() - tstart < timeout);
+    }
+
+    /*
+        @brief Queue an asynchronous command for execution.
+
+        @detail If no other command is queued, the command is started immediately.
+            It is then driven by calls to ::poll. The command object must stay 
+            alive until it completes.
+        @param [IN] command The command. 
+        @return A76XX_OPERATION_SUCCEEDED or A76XX_ASYNC_COMMAND_BUSY if the
+            command object is still pending from a previous submission.
+    */
+    int8_t submit(AsyncCommand_t* command) {
+        if (command->isPending()) {
+            return A76XX_ASYNC_COMMAND_BUSY;
+        }
+
+        command->_state = AsyncCommand_t::QUEUED;
+        command->_next  = NULL;
+        if (_async_tail == NULL) {
+            _async_head = _async_tail = command;
+            startAsync();
+        } else {
+            _async_tail->_next = command;
+            _async_tail = command;
+        }
+        return A76XX_OPERATION_SUCCEEDED;
+    }
+
+    /*
+        @brief Make progress on the queued asynchronous commands and dispatch URCs
+            to the event handlers, without waiting for data from the module.
+
+        @detail Call this function frequently, e.g. from `loop`. Completion callbacks
+            of asynchronous commands are called from here.
+    */
+    void poll() {
+        static const char* no_responses[A76XX_NUM_RESPONSE_PATTERNS] = {NULL, NULL, NULL, NULL, NULL};
+
+        AsyncCommand_t* command = _async_head;
+        const char** responses = command != NULL ? command->_responses : no_responses;
+
+        fillRX();
+        if (command == NULL) {
+            matchRX(responses);
+            return;
+        }
+
+        Response_t rsp = command->_line != NULL ? feedLineAsync(command) : matchRX(responses);
+
+        if (rsp == Response_t::A76XX_RESPONSE_PENDING && 
+                millis() - command->_tstart >= command->_timeout) {
+            rsp = Response_t::A76XX_RESPONSE_TIMEOUT;
+#ifdef A76XX_ENABLE_STATS
+            _stats.response(rsp);
+#endif
+        }
+
+        if (rsp != Response_t::A76XX_RESPONSE_PENDING) {
+            stepAsync(rsp);
+        }
+    }
+
+    /*
+        @brief Block until an asynchronous command completes, calling ::poll.
+
+        @param [IN] command The command, which must have been submitted.
+        @return The result of the command.
+    */
+    int8_t complete(AsyncCommand_t* command) {
+        while (command->isPending()) {
+            poll();
+        }
+        return command->result();
+    }
+
+    /*
+        @brief Block until all queued asynchronous commands complete.
+
+        @detail This is called before sending synchronous commands, since the module
+            processes commands one at a time.
+    */
+    void completeAll() {
+        while (_async_head != NULL) {
+            poll();
+        }
+    }
+
+#ifdef A76XX_ENABLE_STATS
+    /*
+        @brief The per-command statistics, see CommandStats_t. Only available 
+            when A76XX_ENABLE_STATS is defined.
+    */
+    CommandStats_t& stats() {
+        return _stats;
+    }
+
+#endif
+    /*
+        @brief Whether asynchronous commands are queued or running.
+    */
+    bool asyncPending() {
+        return _async_head != NULL;
+    }
+
+    /*
+        @brief The number of URCs dropped because they were malformed, were not
+            received completely within the timeout of their event handler, e.g. 
+            when data has been lost, or because the handler was deregistered while
+            receiving them.
+    */
+    uint32_t discardedEvents() {
+        return _discarded_events;
     }
 
     /* 
         @brief Register a new event handler.
 
         @param [IN] Pointer to a subclass of EventHandler_t.
+        @return False if A76XX_MAX_EVENT_HANDLERS handlers are already registered,
+            or if the match strings of all handlers would leave less than 
+            A76XX_MATCHER_RESPONSE_STATES states of the automaton for the 
+            responses. Registering a handler twice has no effect.
     */
-    void registerEventHandler(EventHandler_t* handler) {
+    bool registerEventHandler(EventHandler_t* handler) {
+        for (uint8_t i = 0; i < _num_event_handlers; i++) {
+            if (_event_handlers[i] == handler) {
+                return true;
+            }
+        }
+        if (_num_event_handlers == A76XX_MAX_EVENT_HANDLERS) {
+            return false;
+        }
+
+        // try the handler strings in the automaton, which is rebuilt anyway 
+        // at the next match since the handlers change
+        _matcher_valid = false;
+        _matcher.clear();
+        bool fits = _matcher.addPattern(handler->match_string);
+        for (uint8_t i = 0; fits && i < _num_event_handlers; i++) {
+            fits = _matcher.addPattern(_event_handlers[i]->match_string);
+        }
+        if (fits == false || 
+            _matcher.numStates() + A76XX_MATCHER_RESPONSE_STATES > A76XX_MATCHER_MAX_STATES) {
+            return false;
+        }
+
         _event_handlers[_num_event_handlers++] = handler;
+        return true;
     }
 
     /* 
@@ -206,50 +652,142 @@ class ModemSerial {
         // This can be replaced by a linked list for efficient removal, 
         // but registration/deregistration is only done occasionally and 
         // _num_event_handlers will typically be small
+        if (_active_handler == handler) {
+            handler->discard();
+            _active_handler = NULL;
+            _discarded_events++;
+            _matcher.reset();
+        }
+
         for (uint8_t i = 0; i < _num_event_handlers; i++) {
             if (_event_handlers[i] == handler) {
-                for (uint8_t j = i; j < _num_event_handlers; j++) {
+                for (uint8_t j = i; j + 1 < _num_event_handlers; j++) {
                     _event_handlers[j] = _event_handlers[j+1];
                 }
                 _num_event_handlers--;
+                _matcher_valid = false;
                 return;
             }
         }
     }
 
     /*
-        @brief Send data to the command to the module, with a trailing carriage return,
-            line feed characters.
+        @brief Send a command to the module, with trailing carriage return and line 
+            feed characters, then wait until it has been transmitted.
 
-        @param [IN] args Items (string, numbers, ...) to be sent.
-        @param [IN] finish Whether to send a terminating "\r\n" to the module.
+        @detail The command is formatted in the TX buffer and handed over to the 
+            underlying stream with a single `write` call, followed by a single `flush`.
+        @param [IN] args Items (string, characters, integer numbers, ...) to be sent.
     */
     template <typename... ARGS>
     void sendCMD(ARGS... args) {
+        sendCMDNoFlush(args...);
+        _stream.flush();
+    }
+
+    /*
+        @brief Send a command to the module, with trailing carriage return and line
+            feed characters, without waiting until it has been transmitted.
+
+        @detail This is analogous to ::sendCMD, but it does not block until the UART
+            is drained. Use it for commands whose response is waited for anyway, 
+            since the response cannot arrive before the command has been sent.
+        @param [IN] args Items (string, characters, integer numbers, ...) to be sent.
+    */
+    template <typename... ARGS>
+    void sendCMDNoFlush(ARGS... args) {
+        waitAsync();
+#ifdef A76XX_ENABLE_STATS
+        _stats_new_command = true;
+#endif
         printCMD(args..., "\r\n");
+        writeTX();
     }
 
     /*
-        @brief Print data to the module's serial port.
+        @brief Format data in the TX buffer, to be sent to the module.
 
         @detail This is analogus to ::sendCMD, but without the trailing carriage return, 
-            line feed characters.
+            line feed characters. Data is only sent with the next call to ::sendCMD, 
+            ::sendCMDNoFlush, `write` or `flush`, or when the TX buffer is full.
 
-        @param [IN] args Items (string, numbers, ...) to be sent.
-        @param [IN] finish Whether to send a terminating "\r\n" to the module.
+        @param [IN] args Items (string, characters, integer numbers, ...) to be sent.
     */
     template <typename HEAD, typename... TAIL>
     void printCMD(HEAD head, TAIL... tail) {
-        _stream.print(head); 
-        flush();
+        waitAsync();
+        appendTX(head);
         printCMD(tail...);
     }
 
-    // single argument case
-    template <typename ARG>
-    void printCMD(ARG arg) {
-        _stream.print(arg); 
-        flush();
+    // no arguments case
+    void printCMD() {}
+
+    /*
+        @brief Execute the commands of a batch, without returning to the caller
+            in between.
+
+        @detail By default, commands are pipelined: each one is sent as soon as the
+            response to the previous one is received. With `chain` true, commands 
+            are instead concatenated in lines of the form "AT+X;+Y;+Z", of at most
+            A76XX_MAX_COMMAND_LINE_LENGTH characters, which the module executes in
+            sequence and answers with a single OK, saving a round trip per command.
+            Use this only for commands the firmware accepts in a chain and that can
+            be repeated, since a line answered with ERROR is executed again one
+            command at a time to find the one that failed. Execution stops at the 
+            first failed command. See CommandBatch_t::result for per-command results.
+        @param [IN] batch The commands.
+        @param [IN] chain Whether to chain commands in a single line. Default is false.
+        @return A76XX_OPERATION_SUCCEEDED if all commands succeeded, the result of the
+            first failed command, or A76XX_BATCH_OVERFLOW if commands were dropped
+            from the batch, in which case nothing is executed.
+    */
+    int8_t sendBatch(CommandBatch_t& batch, bool chain = false) {
+        if (batch._overflow) {
+            return A76XX_BATCH_OVERFLOW;
+        }
+
+        for (uint8_t i = 0; i < batch._count; i++) {
+            batch._results[i] = A76XX_COMMAND_NOT_EXECUTED;
+        }
+
+        uint8_t i = 0;
+        while (i < batch._count) {
+            // number of commands in this line
+            uint8_t  n       = 1;
+            size_t   length  = strlen(batch.command(i));
+            uint32_t timeout = batch._timeouts[i];
+            if (chain) {
+                while (i + n < batch._count) {
+                    // the leading "AT" is replaced by ";"
+                    size_t extra = strlen(batch.command(i + n)) - 1;
+                    if (length + extra > A76XX_MAX_COMMAND_LINE_LENGTH) {
+                        break;
+                    }
+                    length  += extra;
+                    timeout += batch._timeouts[i + n];
+                    n++;
+                }
+            }
+
+            int8_t retcode = sendBatchLine(batch, i, n, timeout);
+
+            if (retcode == A76XX_GENERIC_ERROR && n > 1) {
+                for (uint8_t j = i; j < i + n; j++) {
+                    retcode = sendBatchLine(batch, j, 1, batch._timeouts[j]);
+                    batch._results[j] = retcode;
+                    A76XX_RETCODE_ASSERT_RETURN(retcode);
+                }
+            } else {
+                for (uint8_t j = i; j < i + n; j++) {
+                    batch._results[j] = retcode;
+                }
+                A76XX_RETCODE_ASSERT_RETURN(retcode);
+            }
+            i += n;
+        }
+
+        return A76XX_OPERATION_SUCCEEDED;
     }
 
     /*
@@ -277,50 +815,271 @@ class ModemSerial {
         waitResponse(timeout);
     }
 
-    // The following functions are simply forwarding the calls to underlying stream 
-    // object. If you need others, send a pull request!
+    /*
+        @brief Read the rest of the current line, e.g. the fields of a response 
+            after its prefix has been matched with ::waitResponse.
+
+        @detail Data is consumed up to and including the next line feed character.
+            The line is stored without the terminating carriage return and line feed 
+            characters, and is truncated if it does not fit in the buffer. Use a 
+            FieldTokenizer to parse it.
+        @param [OUT] buffer The destination buffer. The line is always NULL terminated.
+            If NULL, the line is discarded.
+        @param [IN] size The size of the buffer.
+        @param [IN] timeout Time out in milliseconds, only hit if the line feed
+            character is not received. Default is 1000 milliseconds.
+        @return The length of the line or -1 if the operation timed out.
+    */
+    int readLine(char* buffer, size_t size, uint32_t timeout = 1000) {
+        size_t count = 0;
+        bool done = false;
+        uint32_t tstart = millis();
+        while (done == false && millis() - tstart < timeout) {
+            if (fillRX() == 0) {
+                continue;
+            }
+            const char* end = static_cast<const char*>(memchr(dataRX(), '\n', bufferedRX()));
+            size_t n = end != NULL ? end - dataRX() : bufferedRX();
+
+            // copy what fits, skip the rest
+            if (buffer != NULL && count + 1 < size) {
+                size_t m = n < size - 1 - count ? n : size - 1 - count;
+                memcpy(buffer + count, dataRX(), m);
+                count += m;
+            }
+
+            consumeRX(end != NULL ? n + 1 : n);
+            done = end != NULL;
+        }
+
+        if (buffer != NULL && size > 0) {
+            if (done && count > 0 && buffer[count - 1] == '\r') {
+                count--;
+            }
+            buffer[count] = '\0';
+        }
+        return done ? static_cast<int>(count) : -1;
+    }
+
+    /*
+        @brief Move the data available in the underlying stream to the staging buffer.
+
+        @detail Data is read in a single `readBytes` call, to avoid the cost of 
+            calling `available` and `read` for each byte. Data already in the buffer
+            is moved to its start when there is not enough free space at the end.
+        @return The number of bytes in the staging buffer.
+    */
+    size_t fillRX() {
+        if (_rx_start == _rx_end) {
+            _rx_start = _rx_end = 0;
+        }
+
+        int n = _stream.available();
+        if (n <= 0) {
+            return bufferedRX();
+        }
+
+        if (_rx_start > 0 && _rx_end + n > A76XX_RX_BUFFER_SIZE) {
+            memmove(_rx_buffer, _rx_buffer + _rx_start, _rx_end - _rx_start);
+            _rx_end  -= _rx_start;
+            _rx_start = 0;
+        }
+
+        size_t space = A76XX_RX_BUFFER_SIZE - _rx_end;
+        size_t count = static_cast<size_t>(n) < space ? n : space;
+        if (count > 0) {
+            count = _stream.readBytes(_rx_buffer + _rx_end, count);
+            _rx_end += count;
+#ifdef A76XX_ENABLE_STATS
+            _stats.received(count);
+#endif
+        }
+        return bufferedRX();
+    }
+
+    /*
+        @brief Pointer to the first unread byte in the staging buffer. Use together 
+            with ::bufferedRX and ::consumeRX to process data in contiguous memory.
+    */
+    const char* dataRX() {
+        return _rx_buffer + _rx_start;
+    }
+
+    /*
+        @brief Number of unread bytes in the staging buffer.
+    */
+    size_t bufferedRX() {
+        return _rx_end - _rx_start;
+    }
+
+    /*
+        @brief Mark bytes at the start of the staging buffer as read.
+
+        @param [IN] count The number of bytes, at most ::bufferedRX.
+    */
+    void consumeRX(size_t count) {
+        _rx_start += count;
+    }
+
+    // Stream interface. Reads are served from the staging buffer, writes are forwarded
+    // to the underlying stream object, after any data left in the TX buffer.
     int available() {
-        return _stream.available(); 
+        return bufferedRX() + _stream.available(); 
     }
 
-    long parseInt() { 
-        return _stream.parseInt(); 
+    int read() {
+        if (bufferedRX() == 0 && fillRX() == 0) {
+            return -1;
+        }
+        return static_cast<uint8_t>(_rx_buffer[_rx_start++]);
     }
 
-    float parseFloat() { 
-        return _stream.parseFloat(); 
+    int peek() { 
+        if (bufferedRX() == 0 && fillRX() == 0) {
+            return -1;
+        }
+        return static_cast<uint8_t>(_rx_buffer[_rx_start]);
     }
 
     void flush() { 
+        writeTX();
         _stream.flush(); 
     }
 
-    char peek() { 
-        return _stream.peek(); 
+    using Print::write;
+
+    size_t write(uint8_t c) {
+        writeTX();
+#ifdef A76XX_ENABLE_STATS
+        _stats.sent(1);
+#endif
+        return _stream.write(c);
     }
 
-    uint16_t read() { 
-        return _stream.read(); 
+    size_t write(const uint8_t* buffer, size_t size) {
+        writeTX();
+#ifdef A76XX_ENABLE_STATS
+        _stats.sent(size);
+#endif
+        return _stream.write(buffer, size);
     }
 
-    template <typename ARG>
-    bool find(ARG arg) { 
-        return _stream.find(arg); 
+    /*
+        @brief Read bytes, copying whole chunks from the staging buffer.
+
+        @detail Same as Stream::readBytes, i.e. return when `length` bytes have been
+            read or when no data has arrived for the stream timeout.
+        @return The number of bytes read.
+    */
+    size_t readBytes(char* buffer, size_t length) {
+        size_t count = 0;
+        uint32_t tstart = millis();
+        while (count < length) {
+            if (fillRX() == 0) {
+                if (millis() - tstart >= _timeout) { break; }
+                continue;
+            }
+            size_t n = bufferedRX() < length - count ? bufferedRX() : length - count;
+            memcpy(buffer + count, dataRX(), n);
+            consumeRX(n);
+            count += n;
+            tstart = millis();
+        }
+        return count;
     }
 
-    template <typename... ARGS>
-    uint16_t write(ARGS... args) { 
-        return _stream.write(args...); 
+    size_t readBytes(uint8_t* buffer, size_t length) {
+        return readBytes(reinterpret_cast<char*>(buffer), length);
     }
 
-    template <typename... ARGS>
-    uint16_t readBytesUntil(ARGS... args) { 
-        return _stream.readBytesUntil(args...); 
+    /*
+        @brief Append bytes to a string, copying whole chunks from the staging buffer.
+
+        @detail Return when `length` bytes have been read or when no data has arrived 
+            for the stream timeout.
+        @return The number of bytes appended.
+    */
+    size_t readBytes(String& str, size_t length) {
+        size_t count = 0;
+        uint32_t tstart = millis();
+        while (count < length) {
+            if (fillRX() == 0) {
+                if (millis() - tstart >= _timeout) { break; }
+                continue;
+            }
+            size_t n = bufferedRX() < length - count ? bufferedRX() : length - count;
+            str.concat(dataRX(), n);
+            consumeRX(n);
+            count += n;
+            tstart = millis();
+        }
+        return count;
     }
 
-    template <typename... ARGS>
-    uint16_t readBytes(ARGS... args) { 
-        return _stream.readBytes(args...); 
+    /*
+        @brief Write bytes to a Print, e.g. a file, copying whole chunks from the
+            staging buffer, so that data of any length can be read with no other
+            buffer.
+
+        @detail Return when `length` bytes have been read, when no data has arrived
+            for the stream timeout or when `output` does not take all the bytes
+            written to it, e.g. because it is full, in which case the bytes not
+            taken are left in the staging buffer.
+        @return The number of bytes written to `output`.
+    */
+    size_t readBytes(Print& output, size_t length) {
+        size_t count = 0;
+        uint32_t tstart = millis();
+        while (count < length) {
+            if (fillRX() == 0) {
+                if (millis() - tstart >= _timeout) { break; }
+                continue;
+            }
+            size_t n = bufferedRX() < length - count ? bufferedRX() : length - count;
+            size_t m = output.write(reinterpret_cast<const uint8_t*>(dataRX()), n);
+            consumeRX(m);
+            count += m;
+            if (m < n) {
+                break;
+            }
+            tstart = millis();
+        }
+        return count;
+    }
+
+    /*
+        @brief Read bytes until a terminator, scanning whole chunks of the staging buffer.
+
+        @detail Same as Stream::readBytesUntil, i.e. the terminator is consumed but 
+            not stored in the buffer.
+        @return The number of bytes stored in the buffer.
+    */
+    size_t readBytesUntil(char terminator, char* buffer, size_t length) {
+        size_t count = 0;
+        uint32_t tstart = millis();
+        while (count < length) {
+            if (fillRX() == 0) {
+                if (millis() - tstart >= _timeout) { break; }
+                continue;
+            }
+            size_t n = bufferedRX() < length - count ? bufferedRX() : length - count;
+            const char* end = static_cast<const char*>(memchr(dataRX(), terminator, n));
+            if (end != NULL) {
+                n = end - dataRX();
+                memcpy(buffer + count, dataRX(), n);
+                consumeRX(n + 1);
+                return count + n;
+            }
+            memcpy(buffer + count, dataRX(), n);
+            consumeRX(n);
+            count += n;
+            tstart = millis();
+        }
+        return count;
+    }
+
+    size_t readBytesUntil(char terminator, uint8_t* buffer, size_t length) {
+        return readBytesUntil(terminator, reinterpret_cast<char*>(buffer), length);
     }
 };
 
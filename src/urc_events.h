@@ -0,0 +1,377 @@
+#ifndef A76XX_URCEVENTS_H_
+#define A76XX_URCEVENTS_H_
+
+/*
+    @brief Types of the URC events stored in the queue of A76XX.
+*/
+enum A76XXURC_t {
+    // +CREG, +CGREG or +CEREG: the network registration status has changed
+    A76XX_URC_NETWORK_REGISTRATION = 0,
+    // +CGEV: ... DEACT: a PDP context has been deactivated
+    A76XX_URC_PDP_DEACTIVATED      = 1,
+    // +CMQTTCONNLOST: the connection of an MQTT client to the broker was lost
+    A76XX_URC_MQTT_CONNECTION_LOST = 2,
+    // +HTTPACTION: an HTTP request has completed, while no command was waiting for it
+    A76XX_URC_HTTP_ACTION          = 3,
+    // +CMTI: a new SMS has been stored
+    A76XX_URC_SMS_RECEIVED         = 4
+};
+
+// number of URC event types
+#define A76XX_URC_NUM_TYPES 5
+
+// masks of the event types for A76XX::enableURCEvents
+#define A76XX_URC_MASK(type) (1 << (type))
+#define A76XX_URC_ALL        ((1 << A76XX_URC_NUM_TYPES) - 1)
+
+/*
+    @brief A URC event. The member of the union that is valid depends on `type`.
+*/
+struct URCEvent_t {
+    A76XXURC_t type;
+
+    // value of millis() when the URC was received
+    uint32_t   timestamp;
+
+    union {
+        struct {
+            // 0 for CREG, 1 for CGREG, 2 for CEREG, as in A76XX::getRegistrationStatus
+            uint8_t  net;
+            // <stat> in the manual, e.g. 1 registered, home network
+            int8_t   status;
+        } registration;
+
+        struct {
+            uint8_t  cid;
+        } pdp;
+
+        struct {
+            uint8_t  client_index;
+            // <cause> in the manual, e.g. 1 socket closed passively
+            uint8_t  cause;
+        } mqtt;
+
+        struct {
+            uint8_t  method;
+            uint16_t status_code;
+            uint32_t length;
+        } http;
+
+        struct {
+            // the message storage, e.g. "SM" or "ME"
+            char     mem[3];
+            uint16_t index;
+        } sms;
+    };
+};
+
+/*
+    @brief Function called for each URC event, from A76XX::poll or A76XX::listen.
+
+    @param [IN] event The event.
+    @param [IN] context The pointer passed to A76XX::setURCCallback.
+*/
+typedef void (*URCCallback_t)(const URCEvent_t& event, void* context);
+
+/*
+    @brief Fixed-size queue of URC events.
+
+    @details Events are stored by the URC event handlers below as soon as the
+        URC is received, i.e. also while a command is waiting for its response,
+        and are consumed with ::pop. When the queue is full, the oldest event is
+        overwritten and counted as dropped, per event type. No memory is allocated.
+*/
+class URCQueue_t {
+  private:
+    CircularBuffer<URCEvent_t, A76XX_URC_QUEUE_SIZE>         _events;
+    uint16_t                          _dropped[A76XX_URC_NUM_TYPES];
+
+  public:
+    URCQueue_t() {
+        clear();
+    }
+
+    /*
+        @brief Add an event, overwriting the oldest one if the queue is full.
+    */
+    void push(const URCEvent_t& event) {
+        if (_events.isFull()) {
+            _dropped[_events.first().type]++;
+        }
+        _events.push(event);
+    }
+
+    /*
+        @brief Remove the oldest event from the queue.
+
+        @param [OUT] event The event.
+        @return False if the queue is empty.
+    */
+    bool pop(URCEvent_t& event) {
+        if (_events.isEmpty()) {
+            return false;
+        }
+        event = _events.shift();
+        return true;
+    }
+
+    /*
+        @brief The number of events in the queue.
+    */
+    uint8_t size() const {
+        return _events.size();
+    }
+
+    /*
+        @brief The number of events of the given type dropped because the queue
+            was full, since the last call to ::clear.
+    */
+    uint16_t dropped(A76XXURC_t type) const {
+        return _dropped[type];
+    }
+
+    /*
+        @brief The number of events dropped, of all types.
+    */
+    uint32_t dropped() const {
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < A76XX_URC_NUM_TYPES; i++) {
+            total += _dropped[i];
+        }
+        return total;
+    }
+
+    /*
+        @brief Remove all events and reset the drop counters.
+    */
+    void clear() {
+        _events.clear();
+        memset(_dropped, 0, sizeof(_dropped));
+    }
+};
+
+/*
+    @brief Base class of the handlers that push events to a URCQueue_t.
+
+    @details A handler reads the rest of the line after its match string and
+        parses it with ::parse. Like all event handlers, it is not run when the
+        URC is the response a command is waiting for, e.g. "+CREG: " for the CREG
+        read command or "+HTTPACTION: " for HTTPCommands::action, so no event is
+        produced in that case.
+*/
+class URCEventHandler_t : public EventHandler_t {
+  protected:
+    URCQueue_t&                                               _queue;
+    LineReader_t                                             _reader;
+    char                                                   _line[48];
+    uint32_t                                              _timestamp;
+
+    URCEventHandler_t(const char* match_string, URCQueue_t& queue)
+        : EventHandler_t(match_string)
+        , _queue(queue) {}
+
+    // add an event to the queue, with the time of the match
+    void push(URCEvent_t& event) {
+        event.timestamp = _timestamp;
+        _queue.push(event);
+    }
+
+    /*
+        @brief Parse the line following the match string and ::push the event,
+            if the URC is of interest.
+
+        @return False if the line is malformed, in which case the URC is counted
+            as discarded.
+    */
+    virtual bool parse(const char* line) = 0;
+
+  public:
+    void begin() {
+        _reader.clear();
+        _timestamp = millis();
+    }
+
+    size_t feed(const char* data, size_t length, State_t& state) {
+        bool complete;
+        size_t n = _reader.feed(data, length, _line, sizeof(_line), complete);
+        if (complete) {
+            state = parse(_line) ? DONE : DISCARDED;
+        }
+        return n;
+    }
+};
+
+/*
+    @brief Handler of the URCs "+CREG: <stat>", "+CGREG: <stat>" and "+CEREG: <stat>",
+        produced when enabled with the corresponding write command, e.g.
+        NetworkCommands::setNetworkRegistrationURC.
+*/
+class URCNetworkRegistration : public URCEventHandler_t {
+  private:
+    uint8_t                                                     _net;
+
+  protected:
+    bool parse(const char* line) {
+        URCEvent_t event;
+        event.type             = A76XX_URC_NETWORK_REGISTRATION;
+        event.registration.net = _net;
+        if (FieldTokenizer(line).nextInt(event.registration.status) == false) {
+            return false;
+        }
+        push(event);
+        return true;
+    }
+
+  public:
+    URCNetworkRegistration(const char* match_string, uint8_t net, URCQueue_t& queue)
+        : URCEventHandler_t(match_string, queue)
+        , _net(net) {}
+};
+
+/*
+    @brief Handler of the URCs "+CGEV: NW PDN DEACT <cid>" and "+CGEV: ME PDN DEACT <cid>",
+        produced when enabled with PacketDomainCommands::setPacketDomainEventReporting.
+        Other +CGEV URCs are ignored.
+*/
+class URCPDPDeactivated : public URCEventHandler_t {
+  protected:
+    bool parse(const char* line) {
+        // the context identifier is the last field
+        const char* deact = strstr(line, "DEACT");
+        const char* cid   = strrchr(line, ' ');
+        if (deact == NULL) {
+            return true;
+        }
+        if (cid == NULL || cid < deact) {
+            return false;
+        }
+        URCEvent_t event;
+        event.type    = A76XX_URC_PDP_DEACTIVATED;
+        event.pdp.cid = atoi(cid + 1);
+        push(event);
+        return true;
+    }
+
+  public:
+    URCPDPDeactivated(URCQueue_t& queue)
+        : URCEventHandler_t("+CGEV: ", queue) {}
+};
+
+/*
+    @brief Handler of the URC "+CMQTTCONNLOST: <client_index>,<cause>".
+
+    @details The handler is owned by MQTTService_t and is registered while MQTT
+        clients exist, so that they learn about the loss of their connection,
+        see ::takeLost, and also when A76XX_URC_MQTT_CONNECTION_LOST events are
+        enabled, in which case the events are also pushed to the queue.
+*/
+class URCMQTTConnectionLost : public URCEventHandler_t {
+  private:
+    bool                                                   _push_events;
+
+    // the last loss of connection of each client, until taken
+    bool                                 _lost[A76XX_MQTT_MAX_CLIENTS];
+    uint32_t                        _lost_time[A76XX_MQTT_MAX_CLIENTS];
+    uint8_t                        _lost_cause[A76XX_MQTT_MAX_CLIENTS];
+
+  protected:
+    bool parse(const char* line) {
+        URCEvent_t event;
+        event.type = A76XX_URC_MQTT_CONNECTION_LOST;
+        FieldTokenizer fields(line);
+        if (fields.nextInt(event.mqtt.client_index) == false || 
+            fields.nextInt(event.mqtt.cause) == false) {
+            return false;
+        }
+        if (event.mqtt.client_index < A76XX_MQTT_MAX_CLIENTS) {
+            _lost[event.mqtt.client_index]       = true;
+            _lost_time[event.mqtt.client_index]  = _timestamp;
+            _lost_cause[event.mqtt.client_index] = event.mqtt.cause;
+        }
+        if (_push_events) {
+            push(event);
+        }
+        return true;
+    }
+
+  public:
+    URCMQTTConnectionLost(URCQueue_t& queue)
+        : URCEventHandler_t("+CMQTTCONNLOST: ", queue)
+        , _push_events(false) {
+        for (uint8_t i = 0; i < A76XX_MQTT_MAX_CLIENTS; i++) {
+            _lost[i] = false;
+        }
+    }
+
+    /*
+        @brief Whether to push the events to the queue.
+    */
+    void pushEvents(bool enable) {
+        _push_events = enable;
+    }
+
+    /*
+        @brief Take the last loss of connection of a client, if any.
+
+        @param [IN] client_index The index of the client.
+        @param [OUT] timestamp The value of millis() when the URC was received.
+        @param [OUT] cause The cause of the loss.
+        @return False if the connection has not been lost since the last call.
+    */
+    bool takeLost(uint8_t client_index, uint32_t& timestamp, uint8_t& cause) {
+        if (client_index >= A76XX_MQTT_MAX_CLIENTS || _lost[client_index] == false) {
+            return false;
+        }
+        _lost[client_index] = false;
+        timestamp = _lost_time[client_index];
+        cause     = _lost_cause[client_index];
+        return true;
+    }
+};
+
+/*
+    @brief Handler of the URC "+HTTPACTION: <method>,<status_code>,<length>".
+*/
+class URCHTTPAction : public URCEventHandler_t {
+  protected:
+    bool parse(const char* line) {
+        URCEvent_t event;
+        event.type = A76XX_URC_HTTP_ACTION;
+        FieldTokenizer fields(line);
+        if (fields.nextInt(event.http.method) == false ||
+            fields.nextInt(event.http.status_code) == false ||
+            fields.nextInt(event.http.length) == false) {
+            return false;
+        }
+        push(event);
+        return true;
+    }
+
+  public:
+    URCHTTPAction(URCQueue_t& queue)
+        : URCEventHandler_t("+HTTPACTION: ", queue) {}
+};
+
+/*
+    @brief Handler of the URC "+CMTI: <mem>,<index>".
+*/
+class URCSMSReceived : public URCEventHandler_t {
+  protected:
+    bool parse(const char* line) {
+        URCEvent_t event;
+        event.type = A76XX_URC_SMS_RECEIVED;
+        FieldTokenizer fields(line);
+        if (fields.nextString(event.sms.mem, sizeof(event.sms.mem)) == false ||
+            fields.nextInt(event.sms.index) == false) {
+            return false;
+        }
+        push(event);
+        return true;
+    }
+
+  public:
+    URCSMSReceived(URCQueue_t& queue)
+        : URCEventHandler_t("+CMTI: ", queue) {}
+};
+
+#endif A76XX_URCEVENTS_H_
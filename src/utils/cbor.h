@@ -0,0 +1,672 @@
+#ifndef A76XX_CBOR_H_
+#define A76XX_CBOR_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/*
+    @brief Streaming CBOR (RFC 8949) encoder writing into a buffer supplied by the caller.
+
+    @details Items are appended in order, as in a JSON document written with
+        `snprintf`, e.g. a map with two entries is written with
+        `beginMap(2); writeString("t"); writeFloat(21.5); writeString("rh"); writeUInt(48);`.
+        Arrays and maps of unknown length are opened with ::beginArray or
+        ::beginMap without arguments and closed with ::end. Integers and lengths
+        use the shortest encoding and floats are written with half or single
+        precision when this is lossless, e.g. 21.5 takes 3 bytes instead of
+        the 4 characters of "21.5" in JSON, and 1700000000 takes 5 bytes instead of 10.
+
+        No memory is allocated. When the buffer is full, or if it is NULL, the
+        items are not written, ::overflow returns true and ::length keeps
+        counting, so that the length of a payload can be computed without a
+        buffer, e.g. to size it. The result is sent as is, e.g. with
+        A76XXMQTTClient::publish or the binary A76XXHTTPClient::post, which
+        write it directly in the CMQTTPAYLOAD and HTTPDATA transfers.
+*/
+class CBORWriter_t {
+  private:
+    uint8_t*                                                        _data;
+    size_t                                                      _capacity;
+    size_t                                                        _length;
+
+    void put(uint8_t byte) {
+        if (_length < _capacity) {
+            _data[_length] = byte;
+        }
+        _length++;
+    }
+
+    void put(const uint8_t* data, size_t length) {
+        if (_length + length <= _capacity) {
+            memcpy(_data + _length, data, length);
+        }
+        _length += length;
+    }
+
+    // write `value` in `size` bytes, big endian
+    void putBigEndian(uint64_t value, uint8_t size) {
+        for (int8_t i = size - 1; i >= 0; i--) {
+            put(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    // the initial byte of an item with the given major type and argument
+    void writeHead(uint8_t major, uint64_t value) {
+        major <<= 5;
+        if (value < 24) {
+            put(major | static_cast<uint8_t>(value));
+        } else if (value <= 0xFF) {
+            put(major | 24);
+            putBigEndian(value, 1);
+        } else if (value <= 0xFFFF) {
+            put(major | 25);
+            putBigEndian(value, 2);
+        } else if (value <= 0xFFFFFFFF) {
+            put(major | 26);
+            putBigEndian(value, 4);
+        } else {
+            put(major | 27);
+            putBigEndian(value, 8);
+        }
+    }
+
+    // the half precision representation of `value`, if exact
+    static bool toHalf(float value, uint16_t& half) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        uint16_t sign     = (bits >> 16) & 0x8000;
+        int16_t  exponent = static_cast<int16_t>((bits >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        if (((bits >> 23) & 0xFF) == 0xFF) {
+            // infinity, NaN is handled by the caller
+            half = sign | 0x7C00;
+            return mantissa == 0;
+        }
+        if ((bits & 0x7FFFFFFF) == 0) {
+            half = sign;
+            return true;
+        }
+        if (exponent >= 31) {
+            return false;
+        }
+        if (exponent >= 1) {
+            half = sign | (exponent << 10) | (mantissa >> 13);
+            return (mantissa & 0x1FFF) == 0;
+        }
+
+        // subnormal half, including the implicit bit of the float
+        uint8_t shift = 14 - exponent;
+        if (shift > 24) {
+            return false;
+        }
+        mantissa |= 0x800000;
+        half = sign | (mantissa >> shift);
+        return (mantissa & ((1UL << shift) - 1)) == 0;
+    }
+
+  public:
+    /*
+        @brief Construct an encoder.
+
+        @param [IN] data The buffer where items are written, or NULL to only
+            compute the length.
+        @param [IN] capacity The size of the buffer.
+    */
+    CBORWriter_t(uint8_t* data, size_t capacity)
+        : _data(data)
+        , _capacity(data != NULL ? capacity : 0)
+        , _length(0) {}
+
+    /*
+        @brief Write an unsigned integer.
+    */
+    void writeUInt(uint64_t value) {
+        writeHead(0, value);
+    }
+
+    /*
+        @brief Write a signed integer.
+    */
+    void writeInt(int64_t value) {
+        if (value < 0) {
+            // -1 - value, without overflow for the smallest value
+            writeHead(1, ~static_cast<uint64_t>(value));
+        } else {
+            writeHead(0, value);
+        }
+    }
+
+    /*
+        @brief Write a boolean.
+    */
+    void writeBool(bool value) {
+        put(value ? 0xF5 : 0xF4);
+    }
+
+    /*
+        @brief Write null.
+    */
+    void writeNull() {
+        put(0xF6);
+    }
+
+    /*
+        @brief Write a float, in half precision if it can be represented exactly.
+    */
+    void writeFloat(float value) {
+        uint16_t half;
+        if (value != value) {
+            // NaN
+            put(0xF9);
+            putBigEndian(0x7E00, 2);
+        } else if (toHalf(value, half)) {
+            put(0xF9);
+            putBigEndian(half, 2);
+        } else {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            put(0xFA);
+            putBigEndian(bits, 4);
+        }
+    }
+
+    /*
+        @brief Write a double, in half or single precision if it can be represented exactly.
+    */
+    void writeDouble(double value) {
+        if (value != value || static_cast<double>(static_cast<float>(value)) == value) {
+            writeFloat(static_cast<float>(value));
+        } else {
+            uint64_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            put(0xFB);
+            putBigEndian(bits, 8);
+        }
+    }
+
+    /*
+        @brief Write a UTF-8 text string.
+    */
+    void writeString(const char* str) {
+        writeString(str, strlen(str));
+    }
+
+    /*
+        @brief Write a UTF-8 text string of the given length.
+    */
+    void writeString(const char* str, size_t length) {
+        writeHead(3, length);
+        put(reinterpret_cast<const uint8_t*>(str), length);
+    }
+
+    /*
+        @brief Write a byte string.
+    */
+    void writeBytes(const uint8_t* data, size_t length) {
+        writeHead(2, length);
+        put(data, length);
+    }
+
+    /*
+        @brief Start an array of `count` items, which must follow.
+    */
+    void beginArray(size_t count) {
+        writeHead(4, count);
+    }
+
+    /*
+        @brief Start an array of unknown length, closed with ::end.
+    */
+    void beginArray() {
+        put(0x9F);
+    }
+
+    /*
+        @brief Start a map of `count` pairs of keys and values, which must follow.
+    */
+    void beginMap(size_t count) {
+        writeHead(5, count);
+    }
+
+    /*
+        @brief Start a map of unknown length, closed with ::end.
+    */
+    void beginMap() {
+        put(0xBF);
+    }
+
+    /*
+        @brief Close the innermost array or map of unknown length.
+    */
+    void end() {
+        put(0xFF);
+    }
+
+    /*
+        @brief The encoded data.
+    */
+    const uint8_t* data() const {
+        return _data;
+    }
+
+    /*
+        @brief The length of the encoded data, including the part that did not fit.
+    */
+    size_t length() const {
+        return _length;
+    }
+
+    /*
+        @brief Whether the encoded data did not fit in the buffer.
+    */
+    bool overflow() const {
+        return _length > _capacity;
+    }
+
+    /*
+        @brief Start again from an empty buffer.
+    */
+    void reset() {
+        _length = 0;
+    }
+};
+
+/*
+    @brief CBOR (RFC 8949) decoder reading items in place from a buffer, e.g.
+        the payload of an MQTT message or an HTTP response body.
+
+    @details Items are read in order with the function for their type, which
+        returns false and leaves the position unchanged if the next item has a
+        different type, so optional fields can be tried in turn. Strings are
+        returned as pointers into the buffer, and are not NULL-terminated.
+        Items that are not needed are skipped with ::skip. Malformed or
+        truncated data sets ::error, which stays set. Strings of unknown length
+        and tags other than as prefixes skipped by ::skip are not supported.
+
+        For arrays and maps of unknown length, ::readArray and ::readMap return
+        CBORReader_t::INDEFINITE and the items are read until ::readBreak succeeds.
+*/
+class CBORReader_t {
+  public:
+    static const size_t INDEFINITE = static_cast<size_t>(-1);
+
+    enum Type_t {
+        CBOR_UINT,
+        CBOR_NEGINT,
+        CBOR_BYTES,
+        CBOR_STRING,
+        CBOR_ARRAY,
+        CBOR_MAP,
+        CBOR_TAG,
+        CBOR_BOOL,
+        CBOR_NULL,
+        CBOR_FLOAT,
+        CBOR_BREAK,
+        CBOR_INVALID
+    };
+
+  private:
+    // maximum nesting of arrays and maps in ::skip
+    static const uint8_t MAX_DEPTH = 16;
+
+    const uint8_t*                                                  _data;
+    size_t                                                        _length;
+    size_t                                                           _pos;
+    bool                                                           _error;
+
+    // read the initial byte and argument of the next item, without consuming it,
+    // and return the position after the head, or 0 on error
+    size_t peekHead(uint8_t& major, uint8_t& info, uint64_t& value) {
+        if (_pos >= _length) {
+            return 0;
+        }
+        major = _data[_pos] >> 5;
+        info  = _data[_pos] & 0x1F;
+        size_t pos = _pos + 1;
+        if (info < 24) {
+            value = info;
+            return pos;
+        }
+        if (info == 31) {
+            // indefinite length or break
+            value = 0;
+            return pos;
+        }
+        if (info > 27) {
+            return 0;
+        }
+        uint8_t size = 1 << (info - 24);
+        if (pos + size > _length) {
+            return 0;
+        }
+        value = 0;
+        for (uint8_t i = 0; i < size; i++) {
+            value = (value << 8) | _data[pos + i];
+        }
+        return pos + size;
+    }
+
+    // consume the head of an item of the given major type
+    bool readHead(uint8_t expected, uint64_t& value, bool& indefinite) {
+        uint8_t major, info;
+        size_t pos = peekHead(major, info, value);
+        if (pos == 0) {
+            _error = true;
+            return false;
+        }
+        if (major != expected) {
+            return false;
+        }
+        indefinite = info == 31;
+        _pos = pos;
+        return true;
+    }
+
+    // read a definite-length string of the given major type
+    bool readChunk(uint8_t expected, const uint8_t*& data, size_t& length) {
+        size_t start = _pos;
+        uint64_t value;
+        bool indefinite;
+        if (readHead(expected, value, indefinite) == false) {
+            return false;
+        }
+        if (indefinite || value > _length - _pos) {
+            _error = true;
+            _pos = start;
+            return false;
+        }
+        data   = _data + _pos;
+        length = value;
+        _pos  += value;
+        return true;
+    }
+
+    bool readContainer(uint8_t expected, size_t& count) {
+        uint64_t value;
+        bool indefinite;
+        if (readHead(expected, value, indefinite) == false) {
+            return false;
+        }
+        count = indefinite ? INDEFINITE : static_cast<size_t>(value);
+        return true;
+    }
+
+    static float fromHalf(uint16_t half) {
+        uint8_t  exponent = (half >> 10) & 0x1F;
+        uint16_t mantissa = half & 0x3FF;
+        float value;
+        if (exponent == 0) {
+            value = ldexpf(mantissa, -24);
+        } else if (exponent == 31) {
+            value = mantissa == 0 ? INFINITY : NAN;
+        } else {
+            value = ldexpf(mantissa + 1024, exponent - 25);
+        }
+        return half & 0x8000 ? -value : value;
+    }
+
+  public:
+    /*
+        @brief Construct a decoder.
+
+        @param [IN] data The encoded data, which must stay valid while read.
+        @param [IN] length The length of the data.
+    */
+    CBORReader_t(const uint8_t* data, size_t length)
+        : _data(data)
+        , _length(length)
+        , _pos(0)
+        , _error(false) {}
+
+    /*
+        @brief The type of the next item, or CBOR_INVALID at the end of the data.
+    */
+    Type_t peekType() {
+        uint8_t major, info;
+        uint64_t value;
+        if (peekHead(major, info, value) == 0) {
+            return CBOR_INVALID;
+        }
+        if (major < 7) {
+            return static_cast<Type_t>(major);
+        }
+        switch (info) {
+            case 20 :
+            case 21 : return CBOR_BOOL;
+            case 22 : return CBOR_NULL;
+            case 25 :
+            case 26 :
+            case 27 : return CBOR_FLOAT;
+            case 31 : return CBOR_BREAK;
+            default : return CBOR_INVALID;
+        }
+    }
+
+    /*
+        @brief Read an unsigned integer.
+    */
+    bool readUInt(uint64_t& value) {
+        bool indefinite;
+        return readHead(0, value, indefinite);
+    }
+
+    /*
+        @brief Read a signed or unsigned integer.
+
+        @return False if it is not an integer or does not fit in an int64_t.
+    */
+    bool readInt(int64_t& value) {
+        uint8_t major, info;
+        uint64_t arg;
+        size_t pos = peekHead(major, info, arg);
+        if (pos == 0) {
+            _error = true;
+            return false;
+        }
+        if (major > 1 || arg > static_cast<uint64_t>(INT64_MAX)) {
+            return false;
+        }
+        value = major == 0 ? static_cast<int64_t>(arg) : -1 - static_cast<int64_t>(arg);
+        _pos = pos;
+        return true;
+    }
+
+    /*
+        @brief Read a float of any precision, or an integer, as a double.
+    */
+    bool readDouble(double& value) {
+        int64_t integer;
+        if (readInt(integer)) {
+            value = integer;
+            return true;
+        }
+        uint8_t major, info;
+        uint64_t bits;
+        size_t pos = peekHead(major, info, bits);
+        if (pos == 0 || major != 7 || info < 25 || info > 27) {
+            return false;
+        }
+        if (info == 25) {
+            value = fromHalf(bits);
+        } else if (info == 26) {
+            uint32_t bits32 = bits;
+            float single;
+            memcpy(&single, &bits32, sizeof(single));
+            value = single;
+        } else {
+            memcpy(&value, &bits, sizeof(value));
+        }
+        _pos = pos;
+        return true;
+    }
+
+    /*
+        @brief Read a float of any precision, or an integer, as a float.
+    */
+    bool readFloat(float& value) {
+        double dvalue;
+        if (readDouble(dvalue) == false) {
+            return false;
+        }
+        value = dvalue;
+        return true;
+    }
+
+    /*
+        @brief Read a boolean.
+    */
+    bool readBool(bool& value) {
+        if (peekType() != CBOR_BOOL) {
+            return false;
+        }
+        value = _data[_pos++] == 0xF5;
+        return true;
+    }
+
+    /*
+        @brief Read null.
+    */
+    bool readNull() {
+        if (peekType() != CBOR_NULL) {
+            return false;
+        }
+        _pos++;
+        return true;
+    }
+
+    /*
+        @brief Read a text string.
+
+        @param [OUT] str A pointer to the string in the data, not NULL-terminated.
+        @param [OUT] length The length of the string.
+    */
+    bool readString(const char*& str, size_t& length) {
+        const uint8_t* data;
+        if (readChunk(3, data, length) == false) {
+            return false;
+        }
+        str = reinterpret_cast<const char*>(data);
+        return true;
+    }
+
+    /*
+        @brief Read a byte string, see ::readString.
+    */
+    bool readBytes(const uint8_t*& data, size_t& length) {
+        return readChunk(2, data, length);
+    }
+
+    /*
+        @brief Read the start of an array.
+
+        @param [OUT] count The number of items, or INDEFINITE.
+    */
+    bool readArray(size_t& count) {
+        return readContainer(4, count);
+    }
+
+    /*
+        @brief Read the start of a map.
+
+        @param [OUT] count The number of pairs of keys and values, or INDEFINITE.
+    */
+    bool readMap(size_t& count) {
+        return readContainer(5, count);
+    }
+
+    /*
+        @brief Read the end of an array or map of unknown length.
+    */
+    bool readBreak() {
+        if (peekType() != CBOR_BREAK) {
+            return false;
+        }
+        _pos++;
+        return true;
+    }
+
+    /*
+        @brief Skip the next item, including the content of arrays and maps.
+    */
+    bool skip() {
+        return skip(0);
+    }
+
+    /*
+        @brief Whether all the data has been read.
+    */
+    bool atEnd() const {
+        return _pos == _length;
+    }
+
+    /*
+        @brief Whether malformed or truncated data has been found.
+    */
+    bool error() const {
+        return _error;
+    }
+
+    /*
+        @brief The offset of the next item in the data.
+    */
+    size_t position() const {
+        return _pos;
+    }
+
+  private:
+    bool skip(uint8_t depth) {
+        uint8_t major, info;
+        uint64_t value;
+        size_t pos = peekHead(major, info, value);
+        if (pos == 0 || depth == MAX_DEPTH || (info == 31 && major != 4 && major != 5)) {
+            _error = true;
+            return false;
+        }
+
+        switch (major) {
+            case 2 :
+            case 3 : {
+                if (value > _length - pos) {
+                    _error = true;
+                    return false;
+                }
+                _pos = pos + value;
+                return true;
+            }
+            case 4 :
+            case 5 : {
+                _pos = pos;
+                uint8_t items = major == 5 ? 2 : 1;
+                if (info == 31) {
+                    while (readBreak() == false) {
+                        for (uint8_t i = 0; i < items; i++) {
+                            if (skip(depth + 1) == false) {
+                                return false;
+                            }
+                        }
+                    }
+                    return true;
+                }
+                for (uint64_t n = 0; n < value * items; n++) {
+                    if (skip(depth + 1) == false) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            case 6 : {
+                // the tagged item follows
+                _pos = pos;
+                return skip(depth + 1);
+            }
+            default : {
+                _pos = pos;
+                return true;
+            }
+        }
+    }
+};
+
+#endif A76XX_CBOR_H_
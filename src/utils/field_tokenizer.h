@@ -0,0 +1,250 @@
+#ifndef A76XX_FIELDTOKENIZER_H_
+#define A76XX_FIELDTOKENIZER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+    @brief Split a response line in comma separated fields and parse them.
+
+    @details The tokenizer works in place on a line captured with, e.g.,
+        ModemSerial::readLine, without allocating memory. Fields are read in order
+        with the `next*` accessors, each of which consumes one field. Spaces around
+        a field are ignored and double quotes around a field are removed, so that
+        commas in quoted strings do not split fields.
+
+        An accessor returns true only if the field exists, is not empty and is
+        valid for the requested type. Otherwise, the output argument is left
+        untouched, which is convenient for optional fields, e.g. the empty fields
+        returned by CGNSSINFO for a constellation that is not tracked.
+*/
+class FieldTokenizer {
+  private:
+    // start of the next field and end of the line
+    const char* _pos;
+    const char* _end;
+
+    // bounds of the current field, after trimming spaces and quotes
+    const char* _field;
+    const char* _field_end;
+
+    // move to the next field, return false if there are no fields left
+    bool next() {
+        if (_pos == NULL) {
+            return false;
+        }
+
+        // find the separator, ignoring commas in quotes
+        const char* c = _pos;
+        bool quoted = false;
+        while (c < _end && (quoted || *c != ',')) {
+            if (*c == '"') { quoted = !quoted; }
+            c++;
+        }
+
+        _field     = _pos;
+        _field_end = c;
+        _pos       = c < _end ? c + 1 : NULL;
+
+        while (_field < _field_end && *_field == ' ')         { _field++; }
+        while (_field < _field_end && *(_field_end - 1) == ' ') { _field_end--; }
+        if (_field_end - _field >= 2 && *_field == '"' && *(_field_end - 1) == '"') {
+            _field++; _field_end--;
+        }
+        return true;
+    }
+
+    // parse the current field as a decimal number, with integer and fractional
+    // part stored separately, with at most `decimals` fractional digits
+    bool parseDecimal(bool& negative, uint32_t& integer, uint32_t& fraction, uint8_t decimals) {
+        const char* c = _field;
+        negative = false;
+        integer  = 0;
+        fraction = 0;
+        if (c < _field_end && (*c == '-' || *c == '+')) {
+            negative = *c++ == '-';
+        }
+        bool digits = false;
+        while (c < _field_end && *c >= '0' && *c <= '9') {
+            integer = integer * 10 + (*c++ - '0');
+            digits = true;
+        }
+        uint8_t n = 0;
+        if (c < _field_end && *c == '.') {
+            c++;
+            while (c < _field_end && *c >= '0' && *c <= '9') {
+                // extra digits are truncated
+                if (n < decimals) {
+                    fraction = fraction * 10 + (*c - '0');
+                    n++;
+                }
+                c++;
+                digits = true;
+            }
+        }
+        // pad to the requested number of decimals
+        for (; n < decimals; n++) {
+            fraction *= 10;
+        }
+        return digits && c == _field_end;
+    }
+
+  public:
+    /*
+        @brief Construct a tokenizer over a line of given length.
+
+        @param [IN] line The line, without the terminating carriage return and
+            line feed characters. It is not modified, but it must outlive the tokenizer.
+        @param [IN] length The length of the line.
+    */
+    FieldTokenizer(const char* line, size_t length)
+        : _pos(line)
+        , _end(line + length)
+        , _field(line)
+        , _field_end(line) {}
+
+    /*
+        @brief Construct a tokenizer over a NULL terminated line.
+    */
+    explicit FieldTokenizer(const char* line)
+        : FieldTokenizer(line, strlen(line)) {}
+
+    /*
+        @brief Whether there are fields left to read.
+    */
+    bool hasNext() const {
+        return _pos != NULL;
+    }
+
+    /*
+        @brief Skip fields.
+
+        @param [IN] count The number of fields to skip. Default is 1.
+        @return False if the line has less than `count` fields left.
+    */
+    bool skip(uint8_t count = 1) {
+        while (count-- > 0) {
+            if (next() == false) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+        @brief Parse the next field as a decimal integer.
+
+        @param [OUT] value The integer.
+        @return True if the field is a valid integer.
+    */
+    bool nextInt(int32_t& value) {
+        bool negative; uint32_t integer, fraction;
+        if (next() == false || parseDecimal(negative, integer, fraction, 0) == false) {
+            return false;
+        }
+        value = negative ? -static_cast<int32_t>(integer) : static_cast<int32_t>(integer);
+        return true;
+    }
+
+    // for any other integer type
+    template <typename T>
+    bool nextInt(T& value) {
+        int32_t tmp;
+        if (nextInt(tmp) == false) {
+            return false;
+        }
+        value = static_cast<T>(tmp);
+        return true;
+    }
+
+    /*
+        @brief Parse the next field as a fixed point number.
+
+        @details For instance, with `decimals` equal to 2, "-12.3456" is parsed as
+            -1234 and "5" as 500. Extra decimal digits are truncated.
+        @param [OUT] value The number multiplied by 10^decimals.
+        @param [IN] decimals The number of decimal digits to keep.
+        @return True if the field is a valid number.
+    */
+    bool nextFixed(int32_t& value, uint8_t decimals) {
+        bool negative; uint32_t integer, fraction;
+        if (next() == false || parseDecimal(negative, integer, fraction, decimals) == false) {
+            return false;
+        }
+        for (uint8_t i = 0; i < decimals; i++) {
+            integer *= 10;
+        }
+        int32_t result = static_cast<int32_t>(integer + fraction);
+        value = negative ? -result : result;
+        return true;
+    }
+
+    /*
+        @brief Parse the next field as a floating point number in decimal notation.
+
+        @param [OUT] value The number.
+        @return True if the field is a valid number.
+    */
+    bool nextFloat(float& value) {
+        // nine decimal digits are more than a float can represent
+        bool negative; uint32_t integer, fraction;
+        if (next() == false || parseDecimal(negative, integer, fraction, 9) == false) {
+            return false;
+        }
+        float result = static_cast<float>(integer + fraction * 1e-9);
+        value = negative ? -result : result;
+        return true;
+    }
+
+    /*
+        @brief Copy the next field, without quotes, in a buffer.
+
+        @param [OUT] buffer The destination buffer. The string is always NULL
+            terminated and truncated if it does not fit.
+        @param [IN] size The size of the buffer.
+        @return True if the field exists and is not empty.
+    */
+    bool nextString(char* buffer, size_t size) {
+        if (next() == false || _field == _field_end || size == 0) {
+            return false;
+        }
+        size_t length = _field_end - _field;
+        length = length < size - 1 ? length : size - 1;
+        memcpy(buffer, _field, length);
+        buffer[length] = '\0';
+        return true;
+    }
+
+    /*
+        @brief Get the next field, without quotes, without copying it.
+
+        @param [OUT] str Pointer to the start of the field, not NULL terminated.
+        @param [OUT] length The length of the field.
+        @return True if the field exists and is not empty.
+    */
+    bool nextString(const char*& str, size_t& length) {
+        if (next() == false || _field == _field_end) {
+            return false;
+        }
+        str    = _field;
+        length = _field_end - _field;
+        return true;
+    }
+
+    /*
+        @brief Get the first character of the next field, e.g. for the N/S and
+            E/W indicators.
+
+        @param [OUT] c The character.
+        @return True if the field exists and is not empty.
+    */
+    bool nextChar(char& c) {
+        if (next() == false || _field == _field_end) {
+            return false;
+        }
+        c = *_field;
+        return true;
+    }
+};
+
+#endif A76XX_FIELDTOKENIZER_H_
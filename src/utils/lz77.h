@@ -0,0 +1,396 @@
+#ifndef A76XX_LZ77_H_
+#define A76XX_LZ77_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+    Compressed data format, shared by LZCompressor_t and LZDecoder_t.
+
+    The data starts with the four bytes 0x89 'L' 'Z' 0x01, so that receivers can
+    tell it apart from text, JSON or CBOR payloads, see lzIsCompressed, followed
+    by the length of the uncompressed data as an unsigned LEB128 number, i.e.
+    7 bits per byte, least significant first, with the top bit set on all
+    bytes but the last. Then come groups of up to eight tokens, each preceded
+    by a control byte whose bits, from the least significant, tell if the
+    token is a literal byte (0) or a match (1). A match copies `length` bytes
+    starting `offset` bytes before the end of the output, and is encoded in
+    two bytes, plus one if the length is 18 or more:
+        byte 0: the lower 8 bits of offset - 1
+        byte 1: the upper 4 bits of offset - 1, then length - 3 if below 15, else 15
+        byte 2: length - 18, only if byte 1 ends with 15
+    Hence offsets are up to LZ_WINDOW_SIZE and lengths from 3 to LZ_MAX_MATCH.
+*/
+static const uint8_t  LZ_MAGIC[4]      = {0x89, 'L', 'Z', 0x01};
+static const uint32_t LZ_WINDOW_SIZE   = 4096;
+static const uint32_t LZ_MIN_MATCH     = 3;
+static const uint32_t LZ_MAX_MATCH     = 18 + 255;
+
+/*
+    @brief Whether `data` starts with the header of compressed data.
+*/
+inline bool lzIsCompressed(const uint8_t* data, size_t length) {
+    return length >= sizeof(LZ_MAGIC) && memcmp(data, LZ_MAGIC, sizeof(LZ_MAGIC)) == 0;
+}
+
+/*
+    @brief LZ77 compressor with a window of LZ_WINDOW_SIZE bytes, for payloads
+        held in memory, e.g. telemetry with repeated keys and values.
+
+    @details Matches are found with a hash table of the last position of each
+        sequence of three bytes, checking only the most recent candidate, which
+        trades some compression for speed and memory: the table takes
+        2^HASH_BITS 16 bit entries, i.e. 2 KB by default, and the input is used
+        as the window, so no other memory is needed. The table is kept in the
+        object to avoid using the stack, so the object can be reused.
+*/
+class LZCompressor_t {
+  private:
+    static const uint8_t  HASH_BITS = 10;
+
+    // the lower 16 bits of the last position of each hash
+    uint16_t                                    _table[1 << HASH_BITS];
+
+    static uint32_t hash(const uint8_t* data) {
+        uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+        return static_cast<uint32_t>(value * 2654435761U) >> (32 - HASH_BITS);
+    }
+
+  public:
+    /*
+        @brief Compress a block of data.
+
+        @param [IN] input The data.
+        @param [IN] length The length of the data.
+        @param [OUT] output The compressed data.
+        @param [IN] capacity The size of the output buffer.
+        @return The length of the compressed data, or 0 if it would not be
+            shorter than the input or does not fit in the output buffer, in
+            which case the data should be sent uncompressed.
+    */
+    size_t compress(const uint8_t* input, size_t length, uint8_t* output, size_t capacity) {
+        size_t limit = capacity < length ? capacity : length;
+        if (limit < sizeof(LZ_MAGIC) + 5) {
+            return 0;
+        }
+        memcpy(output, LZ_MAGIC, sizeof(LZ_MAGIC));
+        size_t out = sizeof(LZ_MAGIC);
+        for (size_t value = length; ; value >>= 7) {
+            output[out++] = (value & 0x7F) | (value >= 0x80 ? 0x80 : 0);
+            if (value < 0x80) {
+                break;
+            }
+        }
+
+        memset(_table, 0, sizeof(_table));
+        size_t control = 0;
+        uint8_t bit    = 8;
+        size_t i       = 0;
+        while (i < length) {
+            // the largest token and the next control byte must fit
+            if (out + 4 >= limit) {
+                return 0;
+            }
+            if (bit == 8) {
+                control = out++;
+                output[control] = 0;
+                bit = 0;
+            }
+
+            size_t match_length = 0;
+            size_t offset       = 0;
+            if (i + LZ_MIN_MATCH <= length) {
+                uint32_t h = hash(input + i);
+
+                // the most recent position with the same lower 16 bits, before i
+                size_t candidate = (i & ~static_cast<size_t>(0xFFFF)) | _table[h];
+                candidate = candidate >= i ? candidate - 0x10000 : candidate;
+                _table[h] = i;
+
+                offset = i - candidate;
+                if (candidate < i && offset <= LZ_WINDOW_SIZE) {
+                    size_t max_length = length - i < LZ_MAX_MATCH ? length - i : LZ_MAX_MATCH;
+                    while (match_length < max_length && input[candidate + match_length] == input[i + match_length]) {
+                        match_length++;
+                    }
+                }
+            }
+
+            if (match_length >= LZ_MIN_MATCH) {
+                output[control] |= 1 << bit;
+                output[out++] = (offset - 1) & 0xFF;
+                if (match_length < 18) {
+                    output[out++] = ((offset - 1) >> 8) << 4 | (match_length - LZ_MIN_MATCH);
+                } else {
+                    output[out++] = ((offset - 1) >> 8) << 4 | 15;
+                    output[out++] = match_length - 18;
+                }
+
+                // index the positions inside the match, for the next ones
+                for (size_t j = i + 1; j < i + match_length && j + LZ_MIN_MATCH <= length; j++) {
+                    _table[hash(input + j)] = j;
+                }
+                i += match_length;
+            } else {
+                output[out++] = input[i++];
+            }
+            bit++;
+        }
+        return out < length ? out : 0;
+    }
+};
+
+/*
+    @brief Streaming decompressor, fed with the compressed data in chunks of any
+        size, e.g. as an MQTT payload or an HTTP body is received.
+
+    @details The output is kept in a ring of LZ_WINDOW_SIZE bytes, for the
+        matches, and passed to a callback in contiguous pieces, so the whole
+        uncompressed data never needs to be in memory.
+*/
+class LZDecoder_t {
+  private:
+    enum State_t {
+        HEADER,
+        LENGTH,
+        CONTROL,
+        TOKEN,
+        MATCH_OFFSET,
+        MATCH_LENGTH,
+        DONE,
+        FAILED
+    };
+
+    uint8_t                                        _window[LZ_WINDOW_SIZE];
+    State_t                                                        _state;
+    uint8_t                                                         _count;
+    uint8_t                                                       _control;
+    uint8_t                                                           _bit;
+    uint32_t                                                       _offset;
+    uint32_t                                                       _length;
+
+    // the bytes written to the window and passed to the callback
+    uint32_t                                                     _produced;
+    uint32_t                                                      _flushed;
+
+    template <typename F>
+    void flush(F& output) {
+        while (_flushed < _produced) {
+            uint32_t start = _flushed % LZ_WINDOW_SIZE;
+            uint32_t count = _produced - _flushed;
+            count = count < LZ_WINDOW_SIZE - start ? count : LZ_WINDOW_SIZE - start;
+            output(_window + start, count);
+            _flushed += count;
+        }
+    }
+
+    template <typename F>
+    void put(uint8_t byte, F& output) {
+        if (_produced - _flushed == LZ_WINDOW_SIZE) {
+            flush(output);
+        }
+        _window[_produced++ % LZ_WINDOW_SIZE] = byte;
+    }
+
+    // the next token, or the end of the data
+    void nextToken() {
+        if (_produced == _length) {
+            _state = DONE;
+        } else if (_bit == 8) {
+            _state = CONTROL;
+        } else {
+            _state = TOKEN;
+        }
+    }
+
+  public:
+    LZDecoder_t() {
+        reset();
+    }
+
+    /*
+        @brief Start decoding new data.
+    */
+    void reset() {
+        _state    = HEADER;
+        _count    = 0;
+        _bit      = 8;
+        _length   = 0;
+        _produced = 0;
+        _flushed  = 0;
+    }
+
+    /*
+        @brief Decode a chunk of compressed data.
+
+        @param [IN] data The chunk.
+        @param [IN] length The length of the chunk.
+        @param [IN] output A callable with arguments `(const uint8_t* data, size_t length)`,
+            called with the uncompressed data, in order, when the window is full
+            and before returning.
+        @return False if the data is not valid compressed data.
+    */
+    template <typename F>
+    bool feed(const uint8_t* data, size_t length, F output) {
+        for (size_t i = 0; i < length && _state < DONE; i++) {
+            uint8_t byte = data[i];
+            switch (_state) {
+                case HEADER : {
+                    if (byte != LZ_MAGIC[_count++]) {
+                        _state = FAILED;
+                    } else if (_count == sizeof(LZ_MAGIC)) {
+                        _count = 0;
+                        _state = LENGTH;
+                    }
+                    break;
+                }
+                case LENGTH : {
+                    if (_count == 5) {
+                        _state = FAILED;
+                        break;
+                    }
+                    _length |= static_cast<uint32_t>(byte & 0x7F) << (7 * _count++);
+                    if ((byte & 0x80) == 0) {
+                        nextToken();
+                    }
+                    break;
+                }
+                case CONTROL : {
+                    _control = byte;
+                    _bit     = 0;
+                    _state   = TOKEN;
+                    break;
+                }
+                case TOKEN : {
+                    if (_control & (1 << _bit++)) {
+                        _offset = byte;
+                        _state  = MATCH_OFFSET;
+                        break;
+                    }
+                    put(byte, output);
+                    nextToken();
+                    break;
+                }
+                case MATCH_OFFSET :
+                case MATCH_LENGTH : {
+                    uint32_t count;
+                    if (_state == MATCH_OFFSET) {
+                        _offset |= static_cast<uint32_t>(byte >> 4) << 8;
+                        _offset += 1;
+                        if ((byte & 0x0F) == 15) {
+                            _state = MATCH_LENGTH;
+                            break;
+                        }
+                        count = (byte & 0x0F) + LZ_MIN_MATCH;
+                    } else {
+                        count = byte + 18;
+                    }
+                    if (_offset > _produced || count > _length - _produced) {
+                        _state = FAILED;
+                        break;
+                    }
+                    for (uint32_t j = 0; j < count; j++) {
+                        put(_window[(_produced - _offset) % LZ_WINDOW_SIZE], output);
+                    }
+                    nextToken();
+                    break;
+                }
+                default : {
+                    break;
+                }
+            }
+        }
+        flush(output);
+        return _state != FAILED;
+    }
+
+    /*
+        @brief Whether all the uncompressed data has been produced.
+    */
+    bool done() const {
+        return _state == DONE;
+    }
+
+    /*
+        @brief The length of the uncompressed data, once the header has been decoded.
+    */
+    uint32_t length() const {
+        return _length;
+    }
+};
+
+/*
+    @brief Decompress a block of data at once, e.g. a received MQTT payload.
+
+    @param [IN] input The compressed data.
+    @param [IN] length The length of the compressed data.
+    @param [OUT] output The uncompressed data.
+    @param [IN] capacity The size of the output buffer.
+    @param [OUT] output_length The length of the uncompressed data.
+    @return False if the data is not valid compressed data, is truncated, or
+        does not fit in the output buffer.
+*/
+inline bool lzDecompress(const uint8_t* input, size_t length,
+                         uint8_t* output, size_t capacity, size_t& output_length) {
+    size_t in = sizeof(LZ_MAGIC);
+    if (lzIsCompressed(input, length) == false) {
+        return false;
+    }
+    uint32_t total = 0;
+    for (uint8_t shift = 0; ; shift += 7) {
+        if (in == length || shift > 28) {
+            return false;
+        }
+        total |= static_cast<uint32_t>(input[in] & 0x7F) << shift;
+        if ((input[in++] & 0x80) == 0) {
+            break;
+        }
+    }
+    if (total > capacity) {
+        return false;
+    }
+
+    size_t out = 0;
+    uint8_t control = 0;
+    uint8_t bit = 8;
+    while (out < total) {
+        if (bit == 8) {
+            if (in == length) {
+                return false;
+            }
+            control = input[in++];
+            bit = 0;
+        }
+        if ((control & (1 << bit++)) == 0) {
+            if (in == length) {
+                return false;
+            }
+            output[out++] = input[in++];
+            continue;
+        }
+
+        if (in + 2 > length) {
+            return false;
+        }
+        size_t offset = (input[in] | (input[in + 1] >> 4) << 8) + 1;
+        size_t count  = (input[in + 1] & 0x0F) + LZ_MIN_MATCH;
+        in += 2;
+        if (count == 18) {
+            if (in == length) {
+                return false;
+            }
+            count += input[in++];
+        }
+        if (offset > out || count > total - out) {
+            return false;
+        }
+        // byte by byte, since the source may overlap the destination
+        for (size_t j = 0; j < count; j++, out++) {
+            output[out] = output[out - offset];
+        }
+    }
+    output_length = total;
+    return true;
+}
+
+#endif A76XX_LZ77_H_
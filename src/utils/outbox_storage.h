@@ -0,0 +1,147 @@
+#ifndef A76XX_OUTBOXSTORAGE_H_
+#define A76XX_OUTBOXSTORAGE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+    @brief Storage of the messages of an MQTTOutbox, seen as an array of bytes.
+
+    @details Backends only have to read and write bytes at a given offset. The
+        outbox writes each byte range before pointing to it from its markers,
+        and calls ::sync in between, so that after a power loss the markers
+        never point to data that has not been written completely. Backends
+        that buffer writes must make them durable in ::sync.
+*/
+class OutboxStorage_t {
+  public:
+    /*
+        @brief The size of the storage in bytes.
+    */
+    virtual uint32_t size() = 0;
+
+    /*
+        @brief Read `length` bytes at `offset`.
+
+        @return False if the data cannot be read, e.g. because it has never been written.
+    */
+    virtual bool read(uint32_t offset, uint8_t* data, uint32_t length) = 0;
+
+    /*
+        @brief Write `length` bytes at `offset`.
+
+        @return False if the data cannot be written.
+    */
+    virtual bool write(uint32_t offset, const uint8_t* data, uint32_t length) = 0;
+
+    /*
+        @brief Make the data written so far durable.
+
+        @return False on failure.
+    */
+    virtual bool sync() {
+        return true;
+    }
+};
+
+/*
+    @brief Storage in RAM. Messages survive a loss of connection, but not a reset.
+
+    @tparam SIZE The size of the storage in bytes.
+*/
+template <uint32_t SIZE>
+class OutboxRAMStorage_t : public OutboxStorage_t {
+  private:
+    uint8_t                                                 _data[SIZE];
+    bool                                                   _written;
+
+  public:
+    OutboxRAMStorage_t()
+        : _written(false) {}
+
+    uint32_t size() {
+        return SIZE;
+    }
+
+    bool read(uint32_t offset, uint8_t* data, uint32_t length) {
+        if (_written == false || offset + length > SIZE) {
+            return false;
+        }
+        memcpy(data, _data + offset, length);
+        return true;
+    }
+
+    bool write(uint32_t offset, const uint8_t* data, uint32_t length) {
+        if (offset + length > SIZE) {
+            return false;
+        }
+        memcpy(_data + offset, data, length);
+        _written = true;
+        return true;
+    }
+};
+
+/*
+    @brief Storage in a file, e.g. a `File` of LittleFS or of an SD card, so that
+        messages survive a reset of the micro-controller.
+
+    @details The file must be opened for reading and writing, without truncating
+        it, e.g. with mode "r+" after creating it if needed, and stay open while
+        used. Writes are made durable with `flush`.
+
+    @tparam FILE_T A class with the `seek`, `read`, `write` and `flush` functions
+        of the Arduino `File` class.
+*/
+template <typename FILE_T>
+class OutboxFileStorage_t : public OutboxStorage_t {
+  private:
+    FILE_T&                                                       _file;
+    uint32_t                                                      _size;
+
+  public:
+    /*
+        @param [IN] file The open file.
+        @param [IN] size The maximum size of the file in bytes.
+    */
+    OutboxFileStorage_t(FILE_T& file, uint32_t size)
+        : _file(file)
+        , _size(size) {}
+
+    uint32_t size() {
+        return _size;
+    }
+
+    bool read(uint32_t offset, uint8_t* data, uint32_t length) {
+        return offset + length <= _size && _file.seek(offset) &&
+               _file.read(data, length) == length;
+    }
+
+    bool write(uint32_t offset, const uint8_t* data, uint32_t length) {
+        return offset + length <= _size && _file.seek(offset) &&
+               _file.write(data, length) == length;
+    }
+
+    bool sync() {
+        _file.flush();
+        return true;
+    }
+};
+
+/*
+    @brief CRC-32 (IEEE 802.3) of a block of data, computed bit by bit to avoid
+        a lookup table.
+
+    @param [IN] crc The CRC of the preceding data, to compute it in pieces, or zero.
+*/
+inline uint32_t outboxCRC32(const uint8_t* data, uint32_t length, uint32_t crc = 0) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+#endif A76XX_OUTBOXSTORAGE_H_
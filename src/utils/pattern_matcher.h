@@ -0,0 +1,237 @@
+#ifndef A76XX_PATTERNMATCHER_H_
+#define A76XX_PATTERNMATCHER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+    @brief Incremental multi-pattern string matcher.
+
+    @details This is an Aho-Corasick automaton: a set of patterns is stored in
+        a trie and each node gets a failure link to the node representing the
+        longest proper suffix that is also in the trie. Characters are then fed
+        one at a time with ::step and the automaton reports, at every position
+        of the input, which patterns end there. The amortised cost of a step
+        does not depend on the number of patterns, nor on their length.
+
+        All storage is static. Trie children are kept in singly linked sibling
+        lists, which is compact and fast for the small alphabets and short
+        patterns found in the output of the module. Patterns are identified by
+        the order in which ::addPattern is called, starting from zero.
+
+    @tparam N_STATES Maximum number of nodes of the trie, including the root.
+    @tparam N_PATTERNS Maximum number of patterns, at most 64.
+*/
+template <uint16_t N_STATES, uint8_t N_PATTERNS>
+class PatternMatcher {
+  static_assert(N_PATTERNS <= 64, "PatternMatcher supports at most 64 patterns");
+
+  private:
+    static const uint16_t NONE = 0xFFFF;
+
+    // character on the edge from the parent node
+    char                  _chr[N_STATES];
+    // first child and next sibling of each node
+    uint16_t            _child[N_STATES];
+    uint16_t          _sibling[N_STATES];
+    // failure link of each node
+    uint16_t             _fail[N_STATES];
+    // closest accepting node following the failure links, including the node itself
+    uint16_t           _output[N_STATES];
+    // accepting node of each pattern, NONE if the pattern could not be stored
+    uint16_t   _pattern_state[N_PATTERNS];
+    uint16_t                 _num_states;
+    uint8_t                _num_patterns;
+    // current node
+    uint16_t                      _state;
+
+    // find the child of `node` on the edge labelled `c`
+    uint16_t child(uint16_t node, char c) const {
+        for (uint16_t n = _child[node]; n != NONE; n = _sibling[n]) {
+            if (_chr[n] == c) {
+                return n;
+            }
+        }
+        return NONE;
+    }
+
+  public:
+    PatternMatcher() {
+        clear();
+    }
+
+    /*
+        @brief Remove all patterns and reset the automaton.
+    */
+    void clear() {
+        _num_states   = 1;
+        _num_patterns = 0;
+        _state        = 0;
+        _child[0]     = NONE;
+        _sibling[0]   = NONE;
+        _fail[0]      = 0;
+        _output[0]    = NONE;
+    }
+
+    /*
+        @brief Add a pattern to the automaton.
+
+        @details The pattern gets the next free index even if it cannot be
+            stored, so that indices always reflect the calling order. A pattern
+            that is NULL, empty, or that does not fit in the remaining nodes
+            never matches. ::compile must be called after all patterns are added.
+
+        @param [IN] str A NULL terminated string.
+        @return True if the pattern has been stored.
+    */
+    bool addPattern(const char* str) {
+        if (_num_patterns == N_PATTERNS) {
+            return false;
+        }
+        uint8_t index = _num_patterns++;
+        _pattern_state[index] = NONE;
+
+        if (str == NULL || *str == '\0') {
+            return false;
+        }
+
+        // walk the existing prefix of the pattern
+        uint16_t node = 0;
+        const char* c = str;
+        while (*c != '\0') {
+            uint16_t next = child(node, *c);
+            if (next == NONE) { break; }
+            node = next; c++;
+        }
+
+        // check the remaining characters fit before touching the trie
+        if (strlen(c) > static_cast<size_t>(N_STATES - _num_states)) {
+            return false;
+        }
+
+        for (; *c != '\0'; c++) {
+            uint16_t next = _num_states++;
+            _chr[next]     = *c;
+            _child[next]   = NONE;
+            _sibling[next] = _child[node];
+            _output[next]  = NONE;
+            _child[node]   = next;
+            node = next;
+        }
+
+        _output[node] = node;
+        _pattern_state[index] = node;
+        return true;
+    }
+
+    /*
+        @brief Compute the failure links and reset the automaton to the root.
+    */
+    void compile() {
+        // breadth first traversal, so that the failure link of a node is always
+        // computed after those of all shallower nodes
+        uint16_t queue[N_STATES];
+        uint16_t head = 0, tail = 0;
+
+        for (uint16_t n = _child[0]; n != NONE; n = _sibling[n]) {
+            _fail[n] = 0;
+            queue[tail++] = n;
+        }
+
+        while (head < tail) {
+            uint16_t node = queue[head++];
+
+            // nodes are accepting only if they were marked by addPattern
+            if (_output[node] != node) {
+                _output[node] = _output[_fail[node]];
+            }
+
+            for (uint16_t n = _child[node]; n != NONE; n = _sibling[n]) {
+                uint16_t f = _fail[node];
+                uint16_t next = child(f, _chr[n]);
+                while (next == NONE && f != 0) {
+                    f = _fail[f];
+                    next = child(f, _chr[n]);
+                }
+                _fail[n] = next == NONE ? 0 : next;
+                queue[tail++] = n;
+            }
+        }
+
+        _state = 0;
+    }
+
+    /*
+        @brief Forget any partial match, e.g. when the input stream is interrupted.
+    */
+    void reset() {
+        _state = 0;
+    }
+
+    /*
+        @brief Advance the automaton by one character.
+
+        @param [IN] c The next character of the input.
+        @return True if at least one pattern ends at this character. Use
+            ::matches to find out which.
+    */
+    bool step(char c) {
+        while (true) {
+            uint16_t next = child(_state, c);
+            if (next != NONE) {
+                _state = next;
+                break;
+            }
+            if (_state == 0) {
+                break;
+            }
+            _state = _fail[_state];
+        }
+        return _output[_state] != NONE;
+    }
+
+    /*
+        @brief Get the patterns ending at the last character passed to ::step.
+
+        @return A bit mask where bit `i` is set if the i-th pattern matches.
+    */
+    uint64_t matches() const {
+        uint64_t mask = 0;
+        for (uint16_t n = _output[_state]; n != NONE; n = _output[_fail[n]]) {
+            for (uint8_t i = 0; i < _num_patterns; i++) {
+                if (_pattern_state[i] == n) {
+                    mask |= 1ULL << i;
+                }
+            }
+        }
+        return mask;
+    }
+
+    /*
+        @brief Whether the pattern with the given index is `str`, e.g. to reuse
+            the automaton when the same patterns would be added again. NULL and
+            empty strings are the same as patterns that could not be stored.
+    */
+    bool hasPattern(uint8_t index, const char* str) const {
+        if (index >= _num_patterns) {
+            return false;
+        }
+        if (str == NULL || *str == '\0') {
+            return _pattern_state[index] == NONE;
+        }
+        uint16_t node = 0;
+        for (; *str != '\0' && node != NONE; str++) {
+            node = child(node, *str);
+        }
+        return node != NONE && node == _pattern_state[index];
+    }
+
+    /*
+        @brief Number of trie nodes in use, including the root.
+    */
+    uint16_t numStates() const {
+        return _num_states;
+    }
+};
+
+#endif A76XX_PATTERNMATCHER_H_
@@ -0,0 +1,177 @@
+#ifndef A76XX_RECORDQUEUE_H_
+#define A76XX_RECORDQUEUE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+    @brief FIFO queue of variable-length records, packed in a single byte arena.
+
+    @details Records are stored contiguously, each after a small length header,
+        so the memory used depends on the size of the records and not on the
+        largest one that can be stored. A record that does not fit between the
+        last record and the end of the arena is stored at its start, if there
+        is room before the oldest record, like in a bip buffer. Hence records are
+        never split and can be handed out as pointers into the arena.
+
+        A record is written in place: ::reserve returns the space for it, which
+        can be filled over time, e.g. as data arrives from the module, and
+        ::commit appends it to the queue. Records are read with ::peek, which
+        returns a pointer valid until ::consume. Records already in the queue
+        are never overwritten, so a record that does not fit is rejected.
+
+    @tparam SIZE The size of the arena in bytes.
+*/
+template <size_t SIZE>
+class RecordQueue_t {
+  private:
+    // records are aligned to the size of the header
+    typedef uint32_t header_t;
+    static const size_t ALIGN = sizeof(header_t);
+
+    alignas(header_t) uint8_t                                  _data[SIZE];
+
+    // oldest record and end of the last one. When `_wrapped` is true, records
+    // are in [_head, _end) and then in [0, _tail), otherwise in [_head, _tail)
+    size_t                                                           _head;
+    size_t                                                           _tail;
+    size_t                                                            _end;
+    bool                                                          _wrapped;
+    uint16_t                                                        _count;
+
+    // the space returned by ::reserve
+    size_t                                                       _reserved;
+    size_t                                                     _high_water;
+
+    static size_t recordSize(size_t length) {
+        return (sizeof(header_t) + length + ALIGN - 1) / ALIGN * ALIGN;
+    }
+
+    // the oldest record is at the start of the arena once the end is reached
+    void normalize() {
+        if (_wrapped && _head == _end) {
+            _head    = 0;
+            _wrapped = false;
+        }
+    }
+
+  public:
+    RecordQueue_t() {
+        clear();
+    }
+
+    /*
+        @brief Get space for a new record at the end of the queue.
+
+        @param [IN] length The length of the record in bytes.
+        @return A pointer to `length` bytes, valid until ::commit or the next call
+            to ::reserve, or NULL if there is not enough free space. A reservation
+            is abandoned by not committing it.
+    */
+    uint8_t* reserve(size_t length) {
+        size_t need = recordSize(length);
+        if (_wrapped) {
+            if (_head - _tail < need) {
+                return NULL;
+            }
+            _reserved = _tail;
+        } else if (SIZE - _tail >= need) {
+            _reserved = _tail;
+        } else if (_head >= need) {
+            _reserved = 0;
+        } else {
+            return NULL;
+        }
+        return _data + _reserved + sizeof(header_t);
+    }
+
+    /*
+        @brief Append the record returned by the last call to ::reserve.
+
+        @param [IN] length The length of the record, at most the reserved length.
+    */
+    void commit(size_t length) {
+        *reinterpret_cast<header_t*>(_data + _reserved) = length;
+        if (_reserved != _tail) {
+            _end     = _tail;
+            _wrapped = true;
+        }
+        _tail = _reserved + recordSize(length);
+        _count++;
+        normalize();
+
+        size_t used = bytesUsed();
+        _high_water = used > _high_water ? used : _high_water;
+    }
+
+    /*
+        @brief Get the oldest record.
+
+        @param [OUT] length The length of the record.
+        @return A pointer to the record, valid until ::consume or ::clear, or
+            NULL if the queue is empty.
+    */
+    const uint8_t* peek(size_t& length) const {
+        if (_count == 0) {
+            return NULL;
+        }
+        length = *reinterpret_cast<const header_t*>(_data + _head);
+        return _data + _head + sizeof(header_t);
+    }
+
+    /*
+        @brief Remove the oldest record, if any.
+    */
+    void consume() {
+        if (_count == 0) {
+            return;
+        }
+        _head += recordSize(*reinterpret_cast<const header_t*>(_data + _head));
+        _count--;
+        normalize();
+    }
+
+    /*
+        @brief The number of records in the queue.
+    */
+    uint16_t size() const {
+        return _count;
+    }
+
+    /*
+        @brief The number of bytes of the arena used by records, including
+            headers and padding.
+    */
+    size_t bytesUsed() const {
+        return _wrapped ? _end - _head + _tail : _tail - _head;
+    }
+
+    /*
+        @brief The largest value of ::bytesUsed since the last call to ::clear.
+    */
+    size_t highWaterMark() const {
+        return _high_water;
+    }
+
+    /*
+        @brief The largest record that could ever be stored.
+    */
+    static size_t maxLength() {
+        return SIZE - sizeof(header_t);
+    }
+
+    /*
+        @brief Remove all records.
+    */
+    void clear() {
+        _head       = 0;
+        _tail       = 0;
+        _end        = 0;
+        _wrapped    = false;
+        _count      = 0;
+        _reserved   = 0;
+        _high_water = 0;
+    }
+};
+
+#endif A76XX_RECORDQUEUE_H_
@@ -0,0 +1,248 @@
+#ifndef A76XX_TOPICTRIE_H_
+#define A76XX_TOPICTRIE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+    @brief Set of MQTT topic filters, matched against topics level by level.
+
+    @details Filters are stored in a trie where each node is a topic level, e.g.
+        "devices/+/cmd" is the path "devices" -> "+" -> "cmd", so filters that
+        share a prefix share nodes. A topic is matched by following, at each
+        level, the children with the same label and the "+" and "#" wildcards.
+        The cost depends on the depth of the topic and on the number of
+        wildcards, but not on the number of filters. As in the MQTT specification,
+        "a/#" also matches "a", and wildcards at the first level do not match
+        topics starting with "$", e.g. "$SYS/...".
+
+        All storage is static. Children are kept in singly linked sibling lists
+        and labels are copied in a pool of characters. Removing a filter does not
+        free its nodes, which are reused if the filter is inserted again.
+
+    @tparam N_NODES Maximum number of nodes of the trie, including the root.
+    @tparam POOL_SIZE Size in bytes of the pool of labels.
+*/
+template <uint16_t N_NODES, uint16_t POOL_SIZE>
+class TopicTrie {
+  public:
+    static const uint8_t NONE = 0xFF;
+
+  private:
+    static const uint16_t NO_NODE = 0xFFFF;
+
+    struct Node_t {
+        uint16_t label;    // offset of the label in the pool
+        uint8_t  length;   // length of the label
+        uint8_t  id;       // the filter ending here, or NONE
+        uint16_t child;    // first child
+        uint16_t sibling;  // next child of the parent
+    };
+
+    Node_t                                               _nodes[N_NODES];
+    uint16_t                                                 _num_nodes;
+    char                                                _pool[POOL_SIZE];
+    uint16_t                                                  _pool_used;
+
+    bool labelIs(const Node_t& node, const char* str, size_t length) const {
+        return node.length == length && memcmp(_pool + node.label, str, length) == 0;
+    }
+
+    // the child of `parent` with the given label, or NO_NODE
+    uint16_t findChild(uint16_t parent, const char* label, size_t length) const {
+        for (uint16_t n = _nodes[parent].child; n != NO_NODE; n = _nodes[n].sibling) {
+            if (labelIs(_nodes[n], label, length)) {
+                return n;
+            }
+        }
+        return NO_NODE;
+    }
+
+    // the node of a filter, or NO_NODE if not in the trie
+    uint16_t findNode(const char* filter) const {
+        uint16_t node = 0;
+        const char* end = filter + strlen(filter);
+        const char* level = filter;
+        while (node != NO_NODE) {
+            const char* level_end = static_cast<const char*>(memchr(level, '/', end - level));
+            level_end = level_end != NULL ? level_end : end;
+            node = findChild(node, level, level_end - level);
+            if (level_end == end) {
+                break;
+            }
+            level = level_end + 1;
+        }
+        return node;
+    }
+
+    // match the children of `parent` against the level of the topic starting at `level`
+    template <typename F>
+    void matchLevel(uint16_t parent, const char* level, const char* end, bool first, F& callback) const {
+        const char* level_end = static_cast<const char*>(memchr(level, '/', end - level));
+        level_end = level_end != NULL ? level_end : end;
+        bool last = level_end == end;
+
+        // wildcards do not match topics starting with '$' at the first level
+        bool wildcards = first == false || level == end || *level != '$';
+
+        for (uint16_t n = _nodes[parent].child; n != NO_NODE; n = _nodes[n].sibling) {
+            const Node_t& node = _nodes[n];
+            if (node.length == 1 && _pool[node.label] == '#') {
+                if (wildcards && node.id != NONE) {
+                    callback(node.id);
+                }
+                continue;
+            }
+            bool plus = node.length == 1 && _pool[node.label] == '+';
+            if ((plus && wildcards) || labelIs(node, level, level_end - level)) {
+                if (last == false) {
+                    matchLevel(n, level_end + 1, end, false, callback);
+                    continue;
+                }
+                if (node.id != NONE) {
+                    callback(node.id);
+                }
+                // "a/#" also matches "a"
+                uint16_t hash = findChild(n, "#", 1);
+                if (hash != NO_NODE && _nodes[hash].id != NONE) {
+                    callback(_nodes[hash].id);
+                }
+            }
+        }
+    }
+
+    // call `callback` with the filters below `parent`, whose path takes the
+    // first `length` characters of `buffer`
+    template <typename F>
+    void forEachBelow(uint16_t parent, char* buffer, size_t size, size_t length, F& callback) const {
+        for (uint16_t n = _nodes[parent].child; n != NO_NODE; n = _nodes[n].sibling) {
+            const Node_t& node = _nodes[n];
+            size_t start = parent == 0 ? length : length + 1;
+            if (start + node.length >= size) {
+                continue;
+            }
+            if (parent != 0) {
+                buffer[length] = '/';
+            }
+            memcpy(buffer + start, _pool + node.label, node.length);
+            buffer[start + node.length] = '\0';
+            if (node.id != NONE) {
+                callback(static_cast<const char*>(buffer), node.id);
+            }
+            forEachBelow(n, buffer, size, start + node.length, callback);
+        }
+    }
+
+  public:
+    TopicTrie() {
+        clear();
+    }
+
+    /*
+        @brief Remove all filters.
+    */
+    void clear() {
+        _nodes[0].label   = 0;
+        _nodes[0].length  = 0;
+        _nodes[0].id      = NONE;
+        _nodes[0].child   = NO_NODE;
+        _nodes[0].sibling = NO_NODE;
+        _num_nodes = 1;
+        _pool_used = 0;
+    }
+
+    /*
+        @brief Add a filter, or change the identifier of an existing one.
+
+        @param [IN] filter The topic filter, e.g. "devices/+/cmd/#".
+        @param [IN] id An identifier returned when a topic matches the filter,
+            e.g. the index of a handler. Must not be NONE.
+        @return False if there are not enough nodes or space for the labels,
+            in which case the trie is unchanged, apart from unused nodes.
+    */
+    bool insert(const char* filter, uint8_t id) {
+        uint16_t node = 0;
+        const char* end = filter + strlen(filter);
+        const char* level = filter;
+        while (true) {
+            const char* level_end = static_cast<const char*>(memchr(level, '/', end - level));
+            level_end = level_end != NULL ? level_end : end;
+            size_t length = level_end - level;
+
+            uint16_t child = findChild(node, level, length);
+            if (child == NO_NODE) {
+                if (_num_nodes == N_NODES || length > 255 || _pool_used + length > POOL_SIZE) {
+                    return false;
+                }
+                child = _num_nodes++;
+                memcpy(_pool + _pool_used, level, length);
+                _nodes[child].label   = _pool_used;
+                _nodes[child].length  = length;
+                _nodes[child].id      = NONE;
+                _nodes[child].child   = NO_NODE;
+                _nodes[child].sibling = _nodes[node].child;
+                _nodes[node].child    = child;
+                _pool_used += length;
+            }
+            node = child;
+
+            if (level_end == end) {
+                break;
+            }
+            level = level_end + 1;
+        }
+        _nodes[node].id = id;
+        return true;
+    }
+
+    /*
+        @brief Remove a filter.
+
+        @return The identifier of the filter, or NONE if it was not in the trie.
+    */
+    uint8_t remove(const char* filter) {
+        uint16_t node = findNode(filter);
+        if (node == NO_NODE) {
+            return NONE;
+        }
+        uint8_t id = _nodes[node].id;
+        _nodes[node].id = NONE;
+        return id;
+    }
+
+    /*
+        @brief Get the identifier of a filter, or NONE if it is not in the trie.
+    */
+    uint8_t find(const char* filter) const {
+        uint16_t node = findNode(filter);
+        return node == NO_NODE ? NONE : _nodes[node].id;
+    }
+
+    /*
+        @brief Find the filters matching a topic.
+
+        @param [IN] topic The topic, e.g. "devices/42/cmd/reboot".
+        @param [IN] length The length of the topic.
+        @param [IN] callback Called with the identifier of each matching filter.
+    */
+    template <typename F>
+    void match(const char* topic, size_t length, F callback) const {
+        matchLevel(0, topic, topic + length, true, callback);
+    }
+
+    /*
+        @brief Enumerate the filters in the trie, e.g. to subscribe to them again.
+
+        @param [IN] buffer A buffer where each filter is rebuilt.
+        @param [IN] size The size of the buffer. Filters that do not fit, with
+            a NULL character, are skipped.
+        @param [IN] callback Called with each filter, valid during the call, and
+            its identifier. It must not change the trie.
+    */
+    template <typename F>
+    void forEach(char* buffer, size_t size, F callback) const {
+        forEachBelow(0, buffer, size, 0, callback);
+    }
+};
+
+#endif A76XX_TOPICTRIE_H_